@@ -0,0 +1,353 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Headless reprocessing of an archive of capture files (*.krf1cap), e.g. to regenerate the results of a season.
+// Every capture is replayed by its own extractor and timing model on a pool of worker threads, the results of
+// every session are written to <out>/<capture>.csv.
+//
+//   F1CaptureBatch [--threads n] [--out dir] <capture or directory> ...
+//
+//   --threads n  worker threads, default: number of cores
+//   --out dir    directory of the result files, default: next to the captures
+//
+// The captures are read as stream with F1CaptureReader, so the memory per worker does not depend on the file size.
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread -IF1Udp -o F1CaptureBatch F1CaptureBatch/F1CaptureBatch.cpp
+//      F1Udp/F1PacketExtractor.cpp F1Udp/F1PacketFormats.cpp F1Udp/F1HeaderScan.cpp F1Udp/F1FrameAssembler.cpp
+//      F1Udp/F1TimingModel.cpp F1Udp/F1TimingTable.cpp F1Udp/F1GapTracker.cpp F1Udp/F1DirtyFields.cpp F1Udp/F1ChangeFeed.cpp
+//      F1Udp/F1Capture.cpp F1Udp/F1CaptureCodec.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "F1Capture.h"
+#include "F1PacketRegistry.h"
+#include "F1TimingModel.h"
+
+namespace
+{
+   struct Job
+   {
+      std::filesystem::path capture;
+      std::filesystem::path result;
+      uint64_t fileSize{ 0 };
+
+      // set by the worker
+      bool ok{ false };
+      unsigned sessions{ 0 };
+      uint64_t datagrams{ 0 };
+      double seconds{ 0 };
+   };
+
+   // one capture at a time, reused by the jobs of a worker thread
+   class Replayer
+   {
+   public:
+      Replayer()
+      {
+         m_extractor.mode = ExtractMode::View;
+      }
+
+      void Run(Job& job);
+
+   private:
+      void m_Apply(PacketType type, uint8_t flags, uint64_t rxTimestampNs);
+      void m_WriteSession();
+
+      F12025_PacketExtractor m_extractor;
+      F1TimingModel m_model;
+      F1CaptureReader m_reader;
+      std::ofstream m_out;
+
+      // kept over the session change, the extractor drops them before the change is reported
+      PacketParticipantsData m_participants{};
+      PacketFinalClassificationData m_classification{};
+      bool m_hasClassification{ false };
+      uint64_t m_sessionUID{ 0 };
+      unsigned m_sessions{ 0 };
+   };
+
+   uint64_t s_NowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   std::string s_CsvText(const char* pText, size_t maxLen)
+   {
+      std::string res = "\"";
+      for (size_t i = 0; (i < maxLen) && pText[i]; ++i)
+      {
+         if (pText[i] == '"')
+            res += '"';
+         res += pText[i];
+      }
+      return res + "\"";
+   }
+
+   const char* s_StatusName(TimingDriverStatus status)
+   {
+      static const char* const names[] = { "Garage", "OutLap", "OnTrack", "InLap", "Pitlane", "Pitting", "Retired", "DNF", "DSQ" };
+      return names[static_cast<unsigned>(status)];
+   }
+}
+
+void Replayer::Run(Job& job)
+{
+   const uint64_t beginNs = s_NowNs();
+   m_extractor.Reset();
+   m_model.Clear();
+   m_sessionUID = 0;
+   m_sessions = 0;
+   memset(&m_participants, 0, sizeof(m_participants));
+   m_hasClassification = false;
+
+   if (!m_reader.Open(job.capture))
+      return;
+
+   m_out.open(job.result, std::ios::trunc);
+   if (!m_out.is_open())
+   {
+      m_reader.Close();
+      return;
+   }
+   m_out.setf(std::ios::fixed);
+   m_out.precision(3);
+   m_out << "session,track,type,pos,car,name,driverNr,team,laps,bestLapMs,status,penaltySeconds,unservedPitPenalties,"
+      "finalPos,finalLaps,finalTotalTime,finalPenaltySeconds,finalResultStatus\n";
+
+   CaptureRecord rec;
+   while (m_reader.Next(rec))
+   {
+      const uint64_t sessionUID = m_extractor.sessionUID;
+      const uint32_t epoch = m_extractor.Epoch();
+      PacketType type = PacketType::UnknownOrIllformed;
+      m_extractor.ProceedPacket(rec.pData, rec.len, &type);
+      ++job.datagrams;
+
+      uint8_t flags = 0;
+      if (m_extractor.sessionUID != sessionUID)
+         flags |= PacketResult::SessionChanged;
+      else if (m_extractor.Epoch() != epoch)
+         flags |= PacketResult::SessionStarted;
+
+      m_Apply(type, flags, rec.rxTimestampNs);
+   }
+
+   m_WriteSession();
+   m_reader.Close();
+   m_out.close();
+
+   job.ok = !m_out.fail();
+   job.sessions = m_sessions;
+   job.seconds = (s_NowNs() - beginNs) / 1e9;
+}
+
+void Replayer::m_Apply(PacketType type, uint8_t flags, uint64_t rxTimestampNs)
+{
+   // the model is cleared by the packet which starts the next session, the results are taken before
+   if (flags & (PacketResult::SessionChanged | PacketResult::SessionStarted))
+   {
+      m_WriteSession();
+      memset(&m_participants, 0, sizeof(m_participants));
+      m_hasClassification = false;
+   }
+
+   if (m_extractor.sessionUID)
+      m_sessionUID = m_extractor.sessionUID;
+
+   if (type == PacketType::PacketParticipantsData)
+      memcpy(&m_participants, m_extractor.lastPacket.pData, sizeof(m_participants));
+   else if (type == PacketType::PacketFinalClassificationData)
+   {
+      memcpy(&m_classification, m_extractor.lastPacket.pData, sizeof(m_classification));
+      m_hasClassification = true;
+   }
+
+   m_model.Apply(m_extractor, type, rxTimestampNs);
+   m_model.Poll(m_extractor, rxTimestampNs);
+}
+
+void Replayer::m_WriteSession()
+{
+   // sorted by position, drivers without one (e.g. left the lobby) at the end
+   std::vector<unsigned> order;
+   for (unsigned i = 0; i < m_model.drivers.size(); ++i)
+   {
+      if (m_model.drivers[i].present)
+         order.push_back(i);
+   }
+
+   if (order.empty())
+      return;
+
+   std::sort(order.begin(), order.end(), [this](unsigned a, unsigned b)
+      {
+         const int posA = m_model.drivers[a].pos ? m_model.drivers[a].pos : 255;
+         const int posB = m_model.drivers[b].pos ? m_model.drivers[b].pos : 255;
+         return (posA != posB) ? (posA < posB) : (a < b);
+      });
+
+   for (unsigned i : order)
+   {
+      const TimingDriver& driver = m_model.drivers[i];
+      unsigned unserved = 0;
+      for (uint32_t idx : driver.pitPenalties)
+      {
+         if (!m_model.events[idx].penaltyServed)
+            ++unserved;
+      }
+
+      m_out << m_sessionUID << ',' << static_cast<int>(m_model.session.track) << ',' << static_cast<int>(m_model.session.sessionType) << ','
+         << driver.pos << ',' << i << ',' << s_CsvText(m_participants.m_participants[i].m_name, cs_maxParticipantNameLen) << ','
+         << driver.driverNr << ',' << static_cast<int>(driver.team) << ',' << driver.lapNr << ',' << driver.FastestLap().LapMs() << ','
+         << s_StatusName(driver.status) << ',' << driver.penaltySeconds << ',' << unserved << ',';
+
+      if (m_hasClassification)
+      {
+         const FinalClassificationData& final = m_classification.m_classificationData[i];
+         m_out << static_cast<int>(final.m_position) << ',' << static_cast<int>(final.m_numLaps) << ',' << final.m_totalRaceTime << ','
+            << static_cast<int>(final.m_penaltiesTime) << ',' << static_cast<int>(final.m_resultStatus) << '\n';
+      }
+      else
+         m_out << ",,,,\n";
+   }
+   ++m_sessions;
+}
+
+namespace
+{
+   bool s_AddInput(const std::filesystem::path& input, const std::filesystem::path& outDir, std::vector<Job>& jobs)
+   {
+      std::error_code ec;
+      std::vector<std::filesystem::path> captures;
+      if (std::filesystem::is_directory(input, ec))
+      {
+         for (const auto& entry : std::filesystem::directory_iterator(input, ec))
+         {
+            if (entry.is_regular_file(ec) && (entry.path().extension() == ".krf1cap"))
+               captures.push_back(entry.path());
+         }
+      }
+      else if (std::filesystem::is_regular_file(input, ec))
+         captures.push_back(input);
+      else
+         return false;
+
+      for (const auto& capture : captures)
+      {
+         Job job;
+         job.capture = capture;
+         job.result = (outDir.empty() ? capture.parent_path() : outDir) / capture.filename();
+         job.result.replace_extension(".csv");
+         job.fileSize = std::filesystem::file_size(capture, ec);
+         jobs.push_back(std::move(job));
+      }
+      return true;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   unsigned threads = std::thread::hardware_concurrency();
+   std::filesystem::path outDir;
+   std::vector<std::filesystem::path> inputs;
+   bool usage = false;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      if (!strcmp(argv[i], "--threads") && (i + 1 < argc))
+         threads = static_cast<unsigned>(atoi(argv[++i]));
+      else if (!strcmp(argv[i], "--out") && (i + 1 < argc))
+         outDir = argv[++i];
+      else if (argv[i][0] != '-')
+         inputs.push_back(argv[i]);
+      else
+         usage = true;
+   }
+
+   if (usage || inputs.empty())
+   {
+      fprintf(stderr, "usage: %s [--threads n] [--out dir] <capture or directory> ...\n", argv[0]);
+      return 2;
+   }
+
+   std::error_code ec;
+   if (!outDir.empty())
+      std::filesystem::create_directories(outDir, ec);
+
+   std::vector<Job> jobs;
+   for (const auto& input : inputs)
+   {
+      if (!s_AddInput(input, outDir, jobs))
+         fprintf(stderr, "not found: %s\n", input.string().c_str());
+   }
+
+   if (jobs.empty())
+      return 1;
+
+   // the largest captures first, so a large one does not start last and keeps one core busy at the end.
+   // The jobs are independent, a shared counter balances them as well as work stealing would.
+   std::vector<Job*> queue;
+   for (Job& job : jobs)
+      queue.push_back(&job);
+   std::stable_sort(queue.begin(), queue.end(), [](const Job* pA, const Job* pB) { return pA->fileSize > pB->fileSize; });
+
+   threads = (std::max)(1u, (std::min)(threads, static_cast<unsigned>(jobs.size())));
+   std::atomic<size_t> next{ 0 };
+   std::mutex printLock;
+
+   const uint64_t beginNs = s_NowNs();
+   std::vector<std::thread> workers;
+   for (unsigned t = 0; t < threads; ++t)
+   {
+      workers.emplace_back([&]()
+         {
+            // the extractor holds one slot per packet type, it is too large for the thread stack
+            auto pReplayer = std::make_unique<Replayer>();
+            for (size_t i = next++; i < queue.size(); i = next++)
+            {
+               Job& job = *queue[i];
+               pReplayer->Run(job);
+
+               std::lock_guard<std::mutex> lock(printLock);
+               if (job.ok)
+                  printf("%s: %u sessions, %llu datagrams, %.2f s\n", job.capture.string().c_str(), job.sessions,
+                     static_cast<unsigned long long>(job.datagrams), job.seconds);
+               else
+                  printf("%s: failed\n", job.capture.string().c_str());
+            }
+         });
+   }
+
+   for (std::thread& worker : workers)
+      worker.join();
+
+   const double seconds = (s_NowNs() - beginNs) / 1e9;
+   uint64_t datagrams = 0;
+   uint64_t bytes = 0;
+   unsigned failed = 0;
+   for (const Job& job : jobs)
+   {
+      datagrams += job.datagrams;
+      bytes += job.fileSize;
+      failed += job.ok ? 0 : 1;
+   }
+
+   printf("%zu captures (%u failed), %u threads, %.2f s, %.0f datagrams/s, %.0f MB/s\n", jobs.size(), failed, threads, seconds,
+      datagrams / seconds, bytes / 1e6 / seconds);
+   return failed ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Benchmark of the header pre-pass (F1HeaderScan.h): first checks that the scalar, SSE2 and AVX2 paths give the
+// same masks for random and malformed datagrams and that ProceedBatch() accepts the same packets as ProceedPacket(),
+// then measures ns per header of each path for a clean burst of 64 datagrams, against the per datagram header checks
+// of ProceedPacket(), and whole datagrams through ProceedPacket() and ProceedBatch(). Paths the CPU does not support
+// are skipped. ProceedBatch() does not use the pre-pass: even AVX2 costs more per header than the checks it would save.
+//
+//   F1HeaderScanBench [--iterations n]
+//
+//   --iterations n   scans of the burst per path (default 500000)
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -IF1Udp -o F1HeaderScanBench F1HeaderScanBench/F1HeaderScanBench.cpp F1Udp/F1HeaderScan.cpp
+//      F1Udp/F1PacketExtractor.cpp F1Udp/F1PacketFormats.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "F1HeaderScan.h"
+#include "F1PacketRegistry.h"
+
+namespace
+{
+   constexpr unsigned cs_corpusSize = 20000;
+   const uint64_t cs_sessions[] = { 0, 11, 12 };
+
+   struct Options
+   {
+      unsigned iterations{ 500000 };
+   };
+
+   // the reads go here, so the compiler can not drop them
+   volatile uint64_t s_sink = 0;
+
+   uint64_t s_NowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   const char* s_PathName(HeaderScanPath path)
+   {
+      switch (path)
+      {
+      case HeaderScanPath::AVX2: return "AVX2";
+      case HeaderScanPath::SSE2: return "SSE2";
+      default: return "scalar";
+      }
+   }
+
+   std::vector<uint8_t> s_MakePacket(uint16_t format, uint8_t version, uint8_t id, uint64_t sessionUID, uint32_t frame, unsigned len)
+   {
+      std::vector<uint8_t> packet(len ? len : 1, 0);
+      PacketHeader header{};
+      header.m_packetFormat = format;
+      header.m_gameYear = 25;
+      header.m_packetVersion = version;
+      header.m_packetId = id;
+      header.m_sessionUID = sessionUID;
+      header.m_frameIdentifier = frame;
+      if (packet.size() >= sizeof(header))
+         memcpy(packet.data(), &header, sizeof(header));
+      return packet;
+   }
+
+   // F1 25 wire sizes for 2023 .. 2025: only to compare the paths, the table of the extractor differs for older formats
+   HeaderScanTable s_MakeTable()
+   {
+      HeaderScanTable table;
+      table.firstFormat = 2023;
+      table.formatCount = 3;
+      for (unsigned f = 0; f < table.formatCount; ++f)
+      {
+         for (uint8_t id = 0; id < 16; ++id)
+            table.wireSize[f * 16 + id] = static_cast<int32_t>(PacketWireSize(id));
+      }
+      return table;
+   }
+
+   // random headers: unknown formats, versions and ids, short datagrams, menu and session changes. The first one
+   // is a zeroed datagram with m_packetVersion 1 (m_packetFormat 0), for an extractor which has no format yet.
+   std::vector<std::vector<uint8_t>> s_MakeCorpus()
+   {
+      std::mt19937 rng(1);
+      const uint16_t formats[] = { 2025, 2025, 2025, 2024, 2023, 2022, 0 };
+      std::vector<std::vector<uint8_t>> corpus;
+      corpus.push_back(s_MakePacket(0, 1, 0, 0, 0, 64));
+      corpus.back()[offsetof(PacketHeader, m_gameYear)] = 0;
+      for (unsigned i = 1; i < cs_corpusSize; ++i)
+      {
+         const uint8_t id = static_cast<uint8_t>(rng() % 18);
+         unsigned len = PacketWireSize(id < 16 ? id : 0);
+         const unsigned damage = rng() % 20;
+         if (!damage)
+            len = rng() % 40;
+         else if (damage == 1)
+            len -= 1;
+         const uint64_t sessionUID = (rng() % 50) ? cs_sessions[1 + (i / 3000) % 2] : cs_sessions[0];
+         corpus.push_back(s_MakePacket(formats[rng() % 7], (rng() % 30) ? 1 : 2, id, sessionUID, i, len));
+      }
+      return corpus;
+   }
+
+   std::vector<DatagramDesc> s_Descs(const std::vector<std::vector<uint8_t>>& packets)
+   {
+      std::vector<DatagramDesc> descs;
+      for (const std::vector<uint8_t>& packet : packets)
+         descs.push_back(DatagramDesc{ packet.data(), static_cast<unsigned>(packet.size()), 0 });
+      return descs;
+   }
+
+   bool s_Same(const HeaderScan& a, const HeaderScan& b)
+   {
+      return (a.headerMask == b.headerMask) && (a.validMask == b.validMask) && (a.sessionChangedMask == b.sessionChangedMask) &&
+         (a.lastSessionUID == b.lastSessionUID);
+   }
+
+   // bursts of 1 .. 64 datagrams over the corpus, returns the number of bursts with different results
+   unsigned s_ComparePaths(const std::vector<DatagramDesc>& descs, const HeaderScanTable& table, HeaderScanPath best, unsigned& bursts)
+   {
+      unsigned mismatches = 0;
+      bursts = 0;
+      for (size_t i = 0; i + cs_headerScanMax <= descs.size(); i += 37)
+      {
+         const unsigned n = 1 + (i % cs_headerScanMax);
+         const uint64_t sessionUID = cs_sessions[i % 3];
+         HeaderScan reference;
+         const unsigned valid = ScanHeaders(&descs[i], n, table, sessionUID, reference, HeaderScanPath::Scalar);
+         for (HeaderScanPath path : { HeaderScanPath::SSE2, HeaderScanPath::AVX2 })
+         {
+            if (path > best)
+               continue;
+            HeaderScan scan;
+            if ((ScanHeaders(&descs[i], n, table, sessionUID, scan, path) != valid) || !s_Same(reference, scan))
+               ++mismatches;
+         }
+         ++bursts;
+      }
+      return mismatches;
+   }
+
+   // ProceedBatch() against ProceedPacket() one by one, returns the number of datagrams with a different type
+   unsigned s_CompareBatch(const std::vector<DatagramDesc>& descs, bool& sameState)
+   {
+      // the extractor holds one slot per packet type, it is too large for the stack
+      std::vector<F12025_PacketExtractor> extractors(2);
+      F12025_PacketExtractor& single = extractors[0];
+      F12025_PacketExtractor& batch = extractors[1];
+      single.mode = ExtractMode::View;
+      batch.mode = ExtractMode::View;
+
+      std::vector<PacketResult> results(descs.size());
+      batch.ProceedBatch(descs.data(), static_cast<unsigned>(descs.size()), results.data());
+
+      unsigned mismatches = 0;
+      for (size_t i = 0; i < descs.size(); ++i)
+      {
+         PacketType type = PacketType::UnknownOrIllformed;
+         single.ProceedPacket(descs[i].pData, descs[i].len, &type);
+         if (type != results[i].type)
+            ++mismatches;
+      }
+      sameState = (single.sessionUID == batch.sessionUID) && (single.Epoch() == batch.Epoch()) && (single.Format() == batch.Format());
+      return mismatches;
+   }
+
+   // the header checks of ProceedPacket() per datagram (with the wire sizes of the same table), as reference for the pre-pass
+   double s_MeasurePerDatagram(const std::vector<DatagramDesc>& burst, const HeaderScanTable& table, const Options& opt)
+   {
+      uint64_t valid = 0;
+      uint64_t sessionUID = 5;
+      const uint64_t t0 = s_NowNs();
+      for (unsigned r = 0; r < opt.iterations; ++r)
+      {
+         for (const DatagramDesc& datagram : burst)
+         {
+            PacketHeader header;
+            memcpy(&header, datagram.pData, sizeof(header));
+            const unsigned format = header.m_packetFormat - table.firstFormat;
+            if ((format < table.formatCount) && (header.m_packetVersion == 1) && (header.m_packetId < 16) &&
+               table.wireSize[format * 16 + header.m_packetId] && (datagram.len >= static_cast<unsigned>(table.wireSize[format * 16 + header.m_packetId])))
+            {
+               ++valid;
+               if (header.m_sessionUID != sessionUID)
+                  sessionUID = header.m_sessionUID;
+            }
+         }
+         s_sink = valid;
+      }
+      return static_cast<double>(s_NowNs() - t0) / opt.iterations / burst.size();
+   }
+
+   double s_MeasurePath(const std::vector<DatagramDesc>& burst, const HeaderScanTable& table, HeaderScanPath path, const Options& opt)
+   {
+      HeaderScan scan;
+      uint64_t valid = 0;
+      const uint64_t t0 = s_NowNs();
+      for (unsigned r = 0; r < opt.iterations; ++r)
+      {
+         valid += ScanHeaders(burst.data(), static_cast<unsigned>(burst.size()), table, 5, scan, path);
+         s_sink = scan.validMask;
+      }
+      s_sink = valid;
+      return static_cast<double>(s_NowNs() - t0) / opt.iterations / burst.size();
+   }
+
+   // whole datagrams in view mode: ProceedPacket() one by one against ProceedBatch()
+   double s_MeasureExtractor(const std::vector<DatagramDesc>& burst, bool batch, const Options& opt)
+   {
+      std::vector<F12025_PacketExtractor> extractorStorage(1);
+      F12025_PacketExtractor& extractor = extractorStorage[0];
+      extractor.mode = ExtractMode::View;
+      PacketResult results[cs_headerScanMax];
+      const unsigned iterations = opt.iterations / 10 + 1;
+      uint64_t valid = 0;
+      const uint64_t t0 = s_NowNs();
+      for (unsigned r = 0; r < iterations; ++r)
+      {
+         if (batch)
+            valid += extractor.ProceedBatch(burst.data(), static_cast<unsigned>(burst.size()), results);
+         else
+         {
+            for (const DatagramDesc& datagram : burst)
+               valid += extractor.ProceedPacket(datagram.pData, datagram.len) ? 1 : 0;
+         }
+      }
+      s_sink = valid;
+      return static_cast<double>(s_NowNs() - t0) / iterations / burst.size();
+   }
+
+   bool s_ParseArgs(int argc, char** argv, Options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (!strcmp(argv[i], "--iterations") && (i + 1 < argc))
+            opt.iterations = static_cast<unsigned>(atoi(argv[++i]));
+         else
+            return false;
+      }
+      return opt.iterations != 0;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options opt;
+   if (!s_ParseArgs(argc, argv, opt))
+   {
+      fprintf(stderr, "usage: %s [--iterations n]\n", argv[0]);
+      return 2;
+   }
+
+   const HeaderScanPath best = HeaderScanBestPath();
+   const HeaderScanTable table = s_MakeTable();
+   const std::vector<std::vector<uint8_t>> corpus = s_MakeCorpus();
+   const std::vector<DatagramDesc> corpusDescs = s_Descs(corpus);
+
+   unsigned bursts = 0;
+   const unsigned pathMismatches = s_ComparePaths(corpusDescs, table, best, bursts);
+   bool sameState = false;
+   const unsigned batchMismatches = s_CompareBatch(corpusDescs, sameState);
+   printf("best path   %s\n", s_PathName(best));
+   printf("paths       %u of %u bursts of random datagrams differ\n", pathMismatches, bursts);
+   printf("batch       %u of %u datagrams differ from ProceedPacket(), extractor state %s\n", batchMismatches, cs_corpusSize,
+      sameState ? "equal" : "DIFFERENT");
+
+   // clean burst: the packet ids of a frame, all valid
+   std::vector<std::vector<uint8_t>> packets;
+   for (unsigned i = 0; i < cs_headerScanMax; ++i)
+   {
+      const uint8_t id = static_cast<uint8_t>((i % 16 == 3) ? 2 : i % 16); // no events, they may reset the session
+      packets.push_back(s_MakePacket(2025, 1, id, 5, i, PacketWireSize(id)));
+   }
+   const std::vector<DatagramDesc> burst = s_Descs(packets);
+
+   printf("\nclean burst of %u datagrams, ns per header\n", cs_headerScanMax);
+   printf("%-24s %8.2f\n", "per datagram (scalar)", s_MeasurePerDatagram(burst, table, opt));
+   for (HeaderScanPath path : { HeaderScanPath::Scalar, HeaderScanPath::SSE2, HeaderScanPath::AVX2 })
+   {
+      if (path <= best)
+         printf("%-24s %8.2f\n", (std::string("pre-pass ") + s_PathName(path)).c_str(), s_MeasurePath(burst, table, path, opt));
+   }
+   printf("\nclean burst in view mode, ns per datagram\n");
+   printf("%-24s %8.2f\n", "ProceedPacket()", s_MeasureExtractor(burst, false, opt));
+   printf("%-24s %8.2f\n", "ProceedBatch()", s_MeasureExtractor(burst, true, opt));
+   return (pathMismatches || batchMismatches || !sameState) ? 1 : 0;
+}
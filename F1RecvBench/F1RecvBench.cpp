@@ -0,0 +1,145 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Loopback benchmark of F1UdpReceiver: a sender thread blasts F1 25 packets (the mix of one game frame) to a local
+// port, the main thread receives them with F1UdpReceiver::Poll() into the extractor and reports the receiver stats.
+//
+//   F1RecvBench [--port n] [--count n] [--rate n]
+//
+//   --port n    udp port (default 20778, next to the port of the game)
+//   --count n   datagrams to send (default 200000)
+//   --rate n    datagrams per second (default 0: as fast as possible)
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread -IF1Udp -o F1RecvBench F1RecvBench/F1RecvBench.cpp F1Udp/F1UdpReceiver.cpp
+//      F1Udp/F1PacketExtractor.cpp F1Udp/F1PacketFormats.cpp F1Udp/F1HeaderScan.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "F1PacketRegistry.h"
+#include "F1UdpReceiver.h"
+
+namespace
+{
+   struct Options
+   {
+      uint16_t port{ 20778 };
+      unsigned count{ 200000 };
+      unsigned rate{ 0 };
+   };
+
+   // the packets of one frame in race: motion, lap, telemetry, status, motion ex + every 6th frame damage
+   const uint8_t cs_frameIds[] = { 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 10 };
+
+   std::vector<std::vector<uint8_t>> s_MakePackets()
+   {
+      std::vector<std::vector<uint8_t>> packets;
+      for (uint8_t id : cs_frameIds)
+      {
+         std::vector<uint8_t> packet(PacketWireSize(id), 0);
+         PacketHeader header{};
+         header.m_packetFormat = 2025;
+         header.m_gameYear = 25;
+         header.m_packetVersion = 1;
+         header.m_packetId = id;
+         header.m_sessionUID = 1;
+         memcpy(packet.data(), &header, sizeof(header));
+         packets.push_back(std::move(packet));
+      }
+      return packets;
+   }
+
+   void s_Send(const Options& opt, std::atomic<uint64_t>& sent, std::atomic<bool>& done)
+   {
+      F1UdpSender sender;
+      if (sender.Open(opt.port))
+      {
+         const std::vector<std::vector<uint8_t>> packets = s_MakePackets();
+         const auto begin = std::chrono::steady_clock::now();
+         for (unsigned i = 0; i < opt.count; ++i)
+         {
+            // paced in chunks of 1 ms
+            if (opt.rate && !(i % (opt.rate / 1000 + 1)))
+               std::this_thread::sleep_until(begin + std::chrono::nanoseconds(static_cast<uint64_t>(i) * 1000000000ull / opt.rate));
+
+            const std::vector<uint8_t>& packet = packets[i % packets.size()];
+            sender.Send(packet.data(), static_cast<unsigned>(packet.size()));
+         }
+      }
+      sent = sender.Sent();
+      done = true;
+   }
+
+   bool s_ParseArgs(int argc, char** argv, Options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (!strcmp(argv[i], "--port") && (i + 1 < argc))
+            opt.port = static_cast<uint16_t>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--count") && (i + 1 < argc))
+            opt.count = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--rate") && (i + 1 < argc))
+            opt.rate = static_cast<unsigned>(atoi(argv[++i]));
+         else
+            return false;
+      }
+      return opt.port && opt.count;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options opt;
+   if (!s_ParseArgs(argc, argv, opt))
+   {
+      fprintf(stderr, "usage: %s [--port n] [--count n] [--rate n]\n", argv[0]);
+      return 2;
+   }
+
+   // the extractor holds one slot per packet type, it is too large for the stack
+   std::vector<F12025_PacketExtractor> extractorStorage(1);
+   F12025_PacketExtractor& extractor = extractorStorage[0];
+   extractor.mode = ExtractMode::View;
+   F1UdpReceiver receiver(extractor);
+   if (!receiver.Open(opt.port))
+   {
+      fprintf(stderr, "can not open udp port %u\n", opt.port);
+      return 1;
+   }
+
+   std::atomic<uint64_t> sent{ 0 };
+   std::atomic<bool> done{ false };
+   std::thread sendThread(s_Send, std::cref(opt), std::ref(sent), std::ref(done));
+
+   // until the sender is done and nothing arrived for 200 ms
+   for (;;)
+   {
+      const int n = receiver.Poll(200);
+      if (n < 0)
+         break;
+      if (!n && done)
+         break;
+   }
+   sendThread.join();
+
+   const F1UdpReceiverStats& stats = receiver.Stats();
+   printf("sent        %llu datagrams\n", static_cast<unsigned long long>(sent.load()));
+   printf("received    %llu datagrams (%llu valid, %.1f MB), %llu lost\n", static_cast<unsigned long long>(stats.datagrams),
+      static_cast<unsigned long long>(stats.valid), stats.bytes / 1e6,
+      static_cast<unsigned long long>(sent > stats.datagrams ? sent - stats.datagrams : 0));
+   printf("drops       %llu by the kernel, %llu truncated, %llu errors\n", static_cast<unsigned long long>(stats.kernelDrops),
+      static_cast<unsigned long long>(stats.truncated), static_cast<unsigned long long>(stats.errors));
+   printf("batches     %llu, %.1f datagrams per receive call\n", static_cast<unsigned long long>(stats.batches),
+      stats.batches ? static_cast<double>(stats.datagrams) / stats.batches : 0.0);
+   printf("throughput  %.0f packets/s (receive timestamps)\n", stats.PacketsPerSecond());
+   printf("latency     receive to parsed %.2f us avg, %.2f us max\n", stats.AvgLatencyUs(), stats.latencyMaxNs / 1000.0);
+   return 0;
+}
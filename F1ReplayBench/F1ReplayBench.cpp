@@ -0,0 +1,290 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Headless replay of a capture file (*.krf1cap) through the extractor and the timing logic as fast as possible.
+// Regression benchmark for changes to F1PacketExtractor.cpp and the mapper updates (F1TimingModel.cpp).
+//
+//   F1ReplayBench <capture> [--repeat n] [--batch] [--no-model] [--tail]
+//
+//   --repeat n   replay the capture n times (default 3), the best run is reported
+//   --batch      ProceedBatch() in chunks of 64 as the mapper does, no time per packet type
+//   --no-model   extractor only (copy mode)
+//   --tail       a second thread reads the change records of the model while it runs
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread -IF1Udp -o F1ReplayBench F1ReplayBench/F1ReplayBench.cpp F1Udp/F1PacketExtractor.cpp
+//      F1Udp/F1PacketFormats.cpp F1Udp/F1HeaderScan.cpp F1Udp/F1FrameAssembler.cpp F1Udp/F1TimingModel.cpp F1Udp/F1TimingTable.cpp F1Udp/F1GapTracker.cpp
+//      F1Udp/F1DirtyFields.cpp F1Udp/F1ChangeFeed.cpp F1Udp/F1ReplayEngine.cpp F1Udp/F1Capture.cpp F1Udp/F1CaptureCodec.cpp F1Udp/F1Checkpoint.cpp F1Udp/F1MappedFile.cpp
+//      F1Udp/F1Journal.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp, link psapi.lib
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "F1PacketRegistry.h"
+#include "F1ReplayEngine.h"
+#include "F1TimingModel.h"
+
+namespace
+{
+   constexpr unsigned cs_typeCount = 17; // PacketType values + UnknownOrIllformed
+   constexpr unsigned cs_chunk = 64;
+
+   const char* s_TypeName(unsigned idx)
+   {
+      static const char* const names[cs_typeCount] = {
+         "Motion", "Session", "Lap", "Event", "Participants", "CarSetup", "CarTelemetry", "CarStatus",
+         "FinalClassification", "LobbyInfo", "CarDamage", "SessionHistory", "TyreSets", "MotionEx",
+         "TimeTrial", "LapPositions", "Unknown" };
+      return names[idx];
+   }
+
+   unsigned s_TypeIndex(PacketType type)
+   {
+      return (static_cast<unsigned>(type) < cs_typeCount - 1) ? static_cast<unsigned>(type) : cs_typeCount - 1;
+   }
+
+   uint64_t s_NowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   // peak resident set size in bytes
+   uint64_t s_PeakRss()
+   {
+#ifdef _WIN32
+      PROCESS_MEMORY_COUNTERS counters{};
+      if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+         return 0;
+      return counters.PeakWorkingSetSize;
+#else
+      rusage usage{};
+      if (getrusage(RUSAGE_SELF, &usage))
+         return 0;
+#ifdef __APPLE__
+      return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+      return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+   }
+
+   struct RunStats
+   {
+      uint64_t datagrams{ 0 };
+      uint64_t valid{ 0 };
+      uint64_t bytes{ 0 };
+      uint64_t totalNs{ 0 };
+      uint64_t count[cs_typeCount]{};
+      uint64_t ns[cs_typeCount]{};
+      uint64_t driverUpdates{ 0 };
+      uint64_t dirtyFields{ 0 }; // fields applied by the driver updates
+      size_t events{ 0 };
+      uint64_t changes{ 0 };     // change records of the model
+      uint64_t tailRead{ 0 };    // records read by the --tail thread
+      uint64_t tailLost{ 0 };    // records overwritten before the --tail thread read them
+   };
+
+   struct Options
+   {
+      const char* pPath{ nullptr };
+      unsigned repeat{ 3 };
+      bool batch{ false };
+      bool model{ true };
+      bool tail{ false };
+   };
+
+   // timing model sink for ProceedBatch()
+   struct ModelSink
+   {
+      F12025_PacketExtractor& extractor;
+      F1TimingModel& model;
+
+      void operator()(const PacketRef&, const PacketResult& res, const DatagramDesc& datagram)
+      {
+         model.Apply(extractor, res.type, datagram.rxTimestampNs);
+      }
+   };
+
+   bool s_Run(F1ReplayEngine& engine, const Options& opt, RunStats& stats)
+   {
+      // the extractor holds one slot per packet type, it is too large for the stack
+      std::vector<F12025_PacketExtractor> extractorStorage(1);
+      F12025_PacketExtractor& extractor = extractorStorage[0];
+      extractor.mode = opt.model ? ExtractMode::View : ExtractMode::Copy;
+      std::vector<F1TimingModel> modelStorage(1);
+      F1TimingModel& model = modelStorage[0];
+
+      DatagramDesc datagrams[cs_chunk];
+      PacketResult results[cs_chunk];
+      engine.Rewind();
+
+      // a consumer of the change feed, as an exporter or the UI would tail it
+      const uint64_t firstChange = model.changes.Head();
+      std::atomic<bool> tailQuit{ false };
+      std::thread tail;
+      if (opt.model && opt.tail)
+      {
+         tail = std::thread([&model, &stats, &tailQuit, firstChange]()
+         {
+            F1Change changes[256];
+            uint64_t pos = firstChange;
+            for (;;)
+            {
+               const bool quit = tailQuit.load(std::memory_order_acquire);
+               const unsigned n = model.changes.Read(pos, changes, 256, &stats.tailLost);
+               stats.tailRead += n;
+               if (!n && quit)
+                  break;
+               if (!n)
+                  std::this_thread::yield();
+            }
+         });
+      }
+
+      const uint64_t beginNs = s_NowNs();
+      while (const unsigned n = engine.NextBatch(datagrams, cs_chunk))
+      {
+         stats.datagrams += n;
+         for (unsigned i = 0; i < n; ++i)
+            stats.bytes += datagrams[i].len;
+
+         if (opt.batch)
+         {
+            stats.valid += opt.model ? extractor.ProceedBatch(datagrams, n, results, ModelSink{ extractor, model }) :
+               extractor.ProceedBatch(datagrams, n, results);
+         }
+         else
+         {
+            for (unsigned i = 0; i < n; ++i)
+            {
+               const uint64_t t0 = s_NowNs();
+               PacketType type = PacketType::UnknownOrIllformed;
+               if (extractor.ProceedPacket(datagrams[i].pData, datagrams[i].len, &type))
+                  ++stats.valid;
+               if (opt.model)
+                  model.Apply(extractor, type, datagrams[i].rxTimestampNs);
+               const uint64_t t1 = s_NowNs();
+
+               const unsigned idx = s_TypeIndex(type);
+               ++stats.count[idx];
+               stats.ns[idx] += t1 - t0;
+            }
+         }
+
+         if (opt.model)
+            model.Poll(extractor, datagrams[n - 1].rxTimestampNs);
+      }
+      stats.totalNs = s_NowNs() - beginNs;
+      if (tail.joinable())
+      {
+         tailQuit.store(true, std::memory_order_release);
+         tail.join();
+      }
+      stats.driverUpdates = model.driverUpdates;
+      stats.changes = model.changes.Head() - firstChange;
+      stats.dirtyFields = model.dirtyFields.DirtyFields();
+      stats.events = model.events.size();
+      return stats.datagrams != 0;
+   }
+
+   bool s_ParseArgs(int argc, char** argv, Options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (!strcmp(argv[i], "--repeat") && (i + 1 < argc))
+            opt.repeat = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--batch"))
+            opt.batch = true;
+         else if (!strcmp(argv[i], "--no-model"))
+            opt.model = false;
+         else if (!strcmp(argv[i], "--tail"))
+            opt.tail = true;
+         else if ((argv[i][0] != '-') && !opt.pPath)
+            opt.pPath = argv[i];
+         else
+            return false;
+      }
+      return opt.pPath && opt.repeat;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options opt;
+   if (!s_ParseArgs(argc, argv, opt))
+   {
+      fprintf(stderr, "usage: %s <capture> [--repeat n] [--batch] [--no-model] [--tail]\n", argv[0]);
+      return 2;
+   }
+
+   F1ReplayEngine engine;
+   if (!engine.Open(opt.pPath))
+   {
+      fprintf(stderr, "can not open capture %s\n", opt.pPath);
+      return 1;
+   }
+
+   // the first run also pages in the mapping
+   RunStats best;
+   for (unsigned r = 0; r < opt.repeat; ++r)
+   {
+      RunStats stats;
+      if (!s_Run(engine, opt, stats))
+      {
+         fprintf(stderr, "capture %s has no records\n", opt.pPath);
+         return 1;
+      }
+
+      if (!r || (stats.totalNs < best.totalNs))
+         best = stats;
+   }
+
+   const double seconds = best.totalNs / 1e9;
+   printf("capture     %s\n", opt.pPath);
+   printf("mode        %s%s, best of %u\n", opt.batch ? "ProceedBatch" : "ProceedPacket", opt.model ? " + timing model" : "", opt.repeat);
+   printf("datagrams   %llu (%llu valid, %.1f MB)\n", static_cast<unsigned long long>(best.datagrams),
+      static_cast<unsigned long long>(best.valid), best.bytes / 1e6);
+   printf("time        %.3f s\n", seconds);
+   printf("throughput  %.0f packets/s, %.1f ns/packet, %.0f MB/s\n", best.datagrams / seconds,
+      static_cast<double>(best.totalNs) / best.datagrams, best.bytes / 1e6 / seconds);
+   if (opt.model)
+   {
+      const double fields = static_cast<double>(best.driverUpdates) * cs_maxNumCarsInUDPData * cs_driverFieldCount;
+      printf("model       %llu driver updates, %zu events, %.1f%% of the driver fields changed\n",
+         static_cast<unsigned long long>(best.driverUpdates), best.events, fields ? 100.0 * best.dirtyFields / fields : 0.0);
+      printf("changes     %llu records of %zu B (%.1f MB), %.1f per driver update, %.0f records/s\n",
+         static_cast<unsigned long long>(best.changes), sizeof(F1Change), best.changes * sizeof(F1Change) / 1e6,
+         best.driverUpdates ? static_cast<double>(best.changes) / best.driverUpdates : 0.0, best.changes / seconds);
+      if (opt.tail)
+         printf("tail        %llu records read, %llu lost\n", static_cast<unsigned long long>(best.tailRead),
+            static_cast<unsigned long long>(best.tailLost));
+   }
+   printf("peak RSS    %.1f MB (includes the pages of the mapped capture)\n", s_PeakRss() / 1e6);
+
+   if (!opt.batch)
+   {
+      // includes one clock read per packet (20 .. 50 ns depending on the platform), also contained in the throughput above
+      printf("\n%-20s %12s %12s\n", "packet type", "packets", "ns/packet");
+      for (unsigned i = 0; i < cs_typeCount; ++i)
+      {
+         if (best.count[i])
+            printf("%-20s %12llu %12.1f\n", s_TypeName(i), static_cast<unsigned long long>(best.count[i]),
+               static_cast<double>(best.ns[i]) / best.count[i]);
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,173 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Paced replay of a capture file (*.krf1cap) or a pcap / pcapng file: the datagrams are sent by UDP at the time of
+// their capture timestamps (F1ReplayPacer), e.g. to feed a running KRF1Timing or another telemetry tool.
+// The achieved - target send time is reported at the end.
+//
+//   F1ReplaySend <capture> [--speed x] [--host a.b.c.d] [--port n] [--pcap-port n] [--spin-us n] [--no-send]
+//
+//   --speed x      0.1 .. 50, default 1
+//   --host, --port destination, default 127.0.0.1:20777
+//   --pcap-port n  UDP port of the datagrams in a pcap file, 0: all, default 20777
+//   --spin-us n    busy wait before each deadline, default 0 (Linux) / 500 (Windows)
+//   --no-send      pace only, to measure the scheduler
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread -IF1Udp -o F1ReplaySend F1ReplaySend/F1ReplaySend.cpp F1Udp/F1ReplayPacer.cpp
+//      F1Udp/F1UdpReceiver.cpp F1Udp/F1Capture.cpp F1Udp/F1CaptureCodec.cpp F1Udp/F1Pcap.cpp F1Udp/F1MappedFile.cpp
+//      F1Udp/F1PacketExtractor.cpp F1Udp/F1PacketFormats.cpp F1Udp/F1HeaderScan.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "F1Capture.h"
+#include "F1Pcap.h"
+#include "F1ReplayPacer.h"
+#include "F1UdpReceiver.h"
+
+namespace
+{
+   constexpr uint64_t cs_reportIntervalNs = 10'000'000'000ull;
+
+   struct Options
+   {
+      const char* pPath{ nullptr };
+      double speed{ 1.0 };
+      const char* pHost{ "127.0.0.1" };
+      uint16_t port{ 20777 };
+      uint16_t pcapPort{ cs_pcapDefaultPort };
+      int spinUs{ -1 };
+      bool send{ true };
+   };
+
+   // capture or pcap file
+   class Source
+   {
+   public:
+      bool Open(const char* pPath, uint16_t pcapPort)
+      {
+         if (F1PcapReader::IsPcap(pPath))
+         {
+            m_isPcap = true;
+            return m_pcap.Open(pPath, pcapPort);
+         }
+         return m_capture.Open(pPath);
+      }
+
+      uint64_t Records() const { return m_isPcap ? m_pcap.Records() : m_capture.Records(); }
+
+      bool Next(DatagramDesc& datagram)
+      {
+         if (m_isPcap)
+            return m_pcap.Next(datagram);
+
+         CaptureRecord rec;
+         if (!m_capture.Next(rec))
+            return false;
+
+         datagram.pData = rec.pData;
+         datagram.len = rec.len;
+         datagram.rxTimestampNs = rec.rxTimestampNs;
+         return true;
+      }
+
+   private:
+      bool m_isPcap{ false };
+      F1CaptureReader m_capture;
+      F1PcapReader m_pcap;
+   };
+
+   bool s_ParseArgs(int argc, char** argv, Options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (!strcmp(argv[i], "--speed") && (i + 1 < argc))
+            opt.speed = atof(argv[++i]);
+         else if (!strcmp(argv[i], "--host") && (i + 1 < argc))
+            opt.pHost = argv[++i];
+         else if (!strcmp(argv[i], "--port") && (i + 1 < argc))
+            opt.port = static_cast<uint16_t>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--pcap-port") && (i + 1 < argc))
+            opt.pcapPort = static_cast<uint16_t>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--spin-us") && (i + 1 < argc))
+            opt.spinUs = atoi(argv[++i]);
+         else if (!strcmp(argv[i], "--no-send"))
+            opt.send = false;
+         else if ((argv[i][0] != '-') && !opt.pPath)
+            opt.pPath = argv[i];
+         else
+            return false;
+      }
+      return opt.pPath && (opt.speed >= cs_pacerMinSpeed) && (opt.speed <= cs_pacerMaxSpeed) && opt.port;
+   }
+
+   void s_PrintStats(const F1PacerStats& stats)
+   {
+      printf("paced       %llu (%llu stepped), %llu late (> %.1f ms)\n", static_cast<unsigned long long>(stats.paced),
+         static_cast<unsigned long long>(stats.stepped), static_cast<unsigned long long>(stats.late), cs_pacerLateNs / 1e6);
+      printf("error       mean %.1f us, min %.1f us, max %.1f us\n", stats.MeanErrorUs(), stats.errorMinNs / 1e3, stats.errorMaxNs / 1e3);
+      printf("|error|     p50 < %.1f us, p99 < %.1f us, p99.9 < %.1f us\n", stats.AbsErrorPercentileNs(0.5) / 1e3,
+         stats.AbsErrorPercentileNs(0.99) / 1e3, stats.AbsErrorPercentileNs(0.999) / 1e3);
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options opt;
+   if (!s_ParseArgs(argc, argv, opt))
+   {
+      fprintf(stderr, "usage: %s <capture> [--speed x] [--host a.b.c.d] [--port n] [--pcap-port n] [--spin-us n] [--no-send]\n", argv[0]);
+      return 2;
+   }
+
+   Source source;
+   if (!source.Open(opt.pPath, opt.pcapPort))
+   {
+      fprintf(stderr, "can not open %s\n", opt.pPath);
+      return 1;
+   }
+
+   F1UdpSender sender;
+   if (opt.send && !sender.Open(opt.port, opt.pHost))
+   {
+      fprintf(stderr, "can not send to %s:%u\n", opt.pHost, opt.port);
+      return 1;
+   }
+
+   F1ReplayPacer pacer;
+   pacer.SetSpeed(opt.speed);
+   if (opt.spinUs >= 0)
+      pacer.spinNs = static_cast<uint64_t>(opt.spinUs) * 1000;
+
+   printf("replay      %s, %llu datagrams at %.2fx to %s:%u\n", opt.pPath, static_cast<unsigned long long>(source.Records()),
+      opt.speed, opt.send ? opt.pHost : "-", opt.port);
+
+   const uint64_t beginNs = F1ReplayPacer::NowNs();
+   uint64_t nextReportNs = beginNs + cs_reportIntervalNs;
+   DatagramDesc datagram;
+   while (source.Next(datagram) && pacer.Wait(datagram))
+   {
+      if (opt.send)
+         sender.Send(datagram.pData, datagram.len);
+
+      const uint64_t now = F1ReplayPacer::NowNs();
+      if (now >= nextReportNs)
+      {
+         const F1PacerStats stats = pacer.Stats();
+         printf("%8.1f s    capture %.1f s, mean error %.1f us, max %.1f us\n", (now - beginNs) / 1e9, pacer.PositionNs() / 1e9,
+            stats.MeanErrorUs(), stats.errorMaxNs / 1e3);
+         fflush(stdout);
+         nextReportNs += cs_reportIntervalNs;
+      }
+   }
+
+   printf("time        %.1f s for %.1f s of capture\n", (F1ReplayPacer::NowNs() - beginNs) / 1e9, pacer.PositionNs() / 1e9);
+   if (opt.send)
+      printf("sent        %llu, %llu errors\n", static_cast<unsigned long long>(sender.Sent()), static_cast<unsigned long long>(sender.Errors()));
+   s_PrintStats(pacer.Stats());
+   return 0;
+}
@@ -0,0 +1,248 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Stress test of F1SpscRing: a producer thread pushes datagrams of the sizes of a race frame at a fixed rate, the
+// consumer drains the ring into the extractor every few ms, as F1UdpClrMapper::ProceedQueued() does from the UI timer.
+// Every datagram carries its sequence number, the consumer checks order, length and content. Reported are the
+// consumed datagrams per second (min / max over 1 s windows), drops, the fill level and the queueing latency.
+//
+//   F1RingStress [--rate n] [--seconds n] [--poll-ms n] [--ring-kb n] [--wait]
+//
+//   --rate n      datagrams per second (default 3100: 10x the ~310/s of a race at 60 Hz), 0: as fast as possible
+//   --seconds n   duration (default 10)
+//   --poll-ms n   the consumer drains the ring every n ms (default 40 like the UI timer), 0: it spins
+//   --ring-kb n   ring capacity (default 4096)
+//   --wait        RingOverflowPolicy::Wait instead of DropNewest
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread -IF1Udp -o F1RingStress F1RingStress/F1RingStress.cpp F1Udp/F1PacketExtractor.cpp
+//      F1Udp/F1PacketFormats.cpp F1Udp/F1HeaderScan.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "F1PacketRegistry.h"
+#include "F1SpscRing.h"
+
+namespace
+{
+   // packet ids of 6 frames in race: motion, lap, telemetry, status, motion ex + damage at 10 Hz
+   const uint8_t cs_frameIds[] = { 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 0, 2, 6, 7, 13, 10 };
+   constexpr unsigned cs_idCount = sizeof(cs_frameIds) / sizeof(cs_frameIds[0]);
+   constexpr unsigned cs_chunk = 64;
+
+   struct Options
+   {
+      unsigned rate{ 3100 };
+      unsigned seconds{ 10 };
+      unsigned pollMs{ 40 };
+      unsigned ringKb{ 4096 };
+      bool wait{ false };
+   };
+
+   uint64_t s_NowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   unsigned s_Len(uint64_t seq)
+   {
+      return PacketWireSize(cs_frameIds[seq % cs_idCount]);
+   }
+
+   // a valid header (so the extractor accepts it), the sequence number behind it and a pattern derived from it
+   void s_Fill(uint8_t* pData, uint64_t seq)
+   {
+      PacketHeader header{};
+      header.m_packetFormat = 2025;
+      header.m_gameYear = 25;
+      header.m_packetVersion = 1;
+      header.m_packetId = cs_frameIds[seq % cs_idCount];
+      header.m_sessionUID = 1;
+      header.m_frameIdentifier = static_cast<uint32_t>(seq);
+      memcpy(pData, &header, sizeof(header));
+      memcpy(pData + sizeof(header), &seq, sizeof(seq));
+      const unsigned len = s_Len(seq);
+      memset(pData + sizeof(header) + sizeof(seq), static_cast<uint8_t>(seq), len - sizeof(header) - sizeof(seq));
+   }
+
+   bool s_Check(const DatagramDesc& datagram, uint64_t seq)
+   {
+      uint64_t got = 0;
+      if ((datagram.len != s_Len(seq)) || (datagram.len < sizeof(PacketHeader) + sizeof(got)))
+         return false;
+      memcpy(&got, datagram.pData + sizeof(PacketHeader), sizeof(got));
+      return (got == seq) && (datagram.pData[datagram.len - 1] == static_cast<uint8_t>(seq));
+   }
+
+   struct ConsumerStats
+   {
+      uint64_t consumed{ 0 };
+      uint64_t valid{ 0 };
+      uint64_t bad{ 0 };        // wrong order, length or content
+      uint64_t skipped{ 0 };    // sequence numbers missing, must match the drops
+      uint64_t expect{ 0 };     // next sequence number
+      uint64_t latencySumNs{ 0 };
+      uint64_t latencyMaxNs{ 0 };
+      std::vector<uint64_t> perSecond;
+   };
+
+   // returns the number of datagrams offered to the ring
+   uint64_t s_Produce(F1SpscRing& ring, const Options& opt, std::atomic<bool>& done)
+   {
+      const uint64_t beginNs = s_NowNs();
+      const uint64_t endNs = beginNs + opt.seconds * 1000000000ull;
+      uint64_t seq = 0;
+      for (;; ++seq)
+      {
+         // paced in chunks of about 1 ms
+         if (opt.rate && !(seq % (opt.rate / 1000 + 1)))
+         {
+            const uint64_t dueNs = beginNs + seq * 1000000000ull / opt.rate;
+            if (dueNs >= endNs)
+               break;
+            std::this_thread::sleep_for(std::chrono::nanoseconds(dueNs > s_NowNs() ? dueNs - s_NowNs() : 0));
+         }
+         else if (!opt.rate && !(seq % 1024) && (s_NowNs() >= endNs))
+            break;
+
+         const unsigned len = s_Len(seq);
+         if (uint8_t* pData = ring.Reserve(len))
+         {
+            s_Fill(pData, seq);
+            ring.Commit(len, s_NowNs());
+         }
+      }
+      done = true;
+      return seq;
+   }
+
+   void s_Consume(F1SpscRing& ring, const Options& opt, std::atomic<bool>& done, ConsumerStats& stats)
+   {
+      // the extractor holds one slot per packet type, it is too large for the stack
+      std::vector<F12025_PacketExtractor> extractorStorage(1);
+      F12025_PacketExtractor& extractor = extractorStorage[0];
+      extractor.mode = ExtractMode::View;
+
+      DatagramDesc datagrams[cs_chunk];
+      PacketResult results[cs_chunk];
+      const uint64_t beginNs = s_NowNs();
+      uint64_t& expect = stats.expect;
+      for (;;)
+      {
+         const bool last = done.load();
+         unsigned n;
+         while ((n = ring.Peek(datagrams, cs_chunk)) != 0)
+         {
+            const uint64_t nowNs = s_NowNs();
+            for (unsigned i = 0; i < n; ++i)
+            {
+               uint64_t seq = 0;
+               if (datagrams[i].len >= sizeof(PacketHeader) + sizeof(seq))
+                  memcpy(&seq, datagrams[i].pData + sizeof(PacketHeader), sizeof(seq));
+               if (seq > expect)
+               {
+                  stats.skipped += seq - expect;
+                  expect = seq;
+               }
+               if (!s_Check(datagrams[i], expect))
+                  ++stats.bad;
+               ++expect;
+
+               const uint64_t latencyNs = nowNs - datagrams[i].rxTimestampNs;
+               stats.latencySumNs += latencyNs;
+               stats.latencyMaxNs = std::max(stats.latencyMaxNs, latencyNs);
+            }
+            stats.valid += extractor.ProceedBatch(datagrams, n, results);
+            ring.Release();
+            stats.consumed += n;
+
+            const size_t second = static_cast<size_t>((nowNs - beginNs) / 1000000000ull);
+            if (stats.perSecond.size() <= second)
+               stats.perSecond.resize(second + 1, 0);
+            stats.perSecond[second] += n;
+         }
+         if (last)
+            break;
+
+         if (opt.pollMs)
+            std::this_thread::sleep_for(std::chrono::milliseconds(opt.pollMs));
+         else
+            std::this_thread::yield();
+      }
+   }
+
+   bool s_ParseArgs(int argc, char** argv, Options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (!strcmp(argv[i], "--rate") && (i + 1 < argc))
+            opt.rate = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--seconds") && (i + 1 < argc))
+            opt.seconds = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--poll-ms") && (i + 1 < argc))
+            opt.pollMs = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--ring-kb") && (i + 1 < argc))
+            opt.ringKb = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--wait"))
+            opt.wait = true;
+         else
+            return false;
+      }
+      return opt.seconds && opt.ringKb;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options opt;
+   if (!s_ParseArgs(argc, argv, opt))
+   {
+      fprintf(stderr, "usage: %s [--rate n] [--seconds n] [--poll-ms n] [--ring-kb n] [--wait]\n", argv[0]);
+      return 2;
+   }
+
+   F1SpscRing ring(opt.ringKb * size_t(1024), opt.wait ? RingOverflowPolicy::Wait : RingOverflowPolicy::DropNewest);
+   std::atomic<bool> done{ false };
+   ConsumerStats stats;
+
+   const uint64_t beginNs = s_NowNs();
+   std::thread consumer(s_Consume, std::ref(ring), std::cref(opt), std::ref(done), std::ref(stats));
+   const uint64_t offered = s_Produce(ring, opt, done);
+   consumer.join();
+   stats.skipped += offered - stats.expect; // dropped after the last consumed one
+   const double seconds = (s_NowNs() - beginNs) / 1e9;
+
+   // the last window is partial
+   uint64_t minPerSecond = 0, maxPerSecond = 0;
+   if (stats.perSecond.size() > 1)
+   {
+      minPerSecond = *std::min_element(stats.perSecond.begin(), stats.perSecond.end() - 1);
+      maxPerSecond = *std::max_element(stats.perSecond.begin(), stats.perSecond.end() - 1);
+   }
+
+   const F1SpscRingStats ringStats = ring.Stats();
+   printf("ring        %zu KB, %s, the consumer drains every %u ms\n", ring.Capacity() / 1024, opt.wait ? "Wait" : "DropNewest",
+      opt.pollMs);
+   printf("rate        %u datagrams/s requested, %.0f pushed/s, %.0f consumed/s\n", opt.rate, ringStats.pushed / seconds,
+      stats.consumed / seconds);
+   printf("per second  %llu min, %llu max consumed (1 s windows)\n", static_cast<unsigned long long>(minPerSecond),
+      static_cast<unsigned long long>(maxPerSecond));
+   printf("datagrams   %llu pushed, %llu dropped, %llu consumed, %llu valid\n", static_cast<unsigned long long>(ringStats.pushed),
+      static_cast<unsigned long long>(ringStats.dropped), static_cast<unsigned long long>(stats.consumed),
+      static_cast<unsigned long long>(stats.valid));
+   printf("check       %llu bad, %llu skipped (must equal dropped)\n", static_cast<unsigned long long>(stats.bad),
+      static_cast<unsigned long long>(stats.skipped));
+   printf("fill        %.1f KB high water\n", ringStats.highWaterBytes / 1024.0);
+   printf("latency     push to consumed %.2f ms avg, %.2f ms max\n",
+      stats.consumed ? stats.latencySumNs / 1e6 / stats.consumed : 0.0, stats.latencyMaxNs / 1e6);
+   return (stats.bad || (stats.skipped != ringStats.dropped)) ? 1 : 0;
+}
@@ -0,0 +1,271 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Seek latency of F1ReplayEngine: opens a capture (*.krf1cap) from the memory mapping and seeks to random session
+// times and frames of its longest session. Every seek is checked: the first packet after it has to be the first one
+// at or behind the target. Also measures seeks with the extractor state (checkpoint restore + replay up to the target).
+// --generate writes a synthetic race capture first (the packets of a race at 60 Hz, with checkpoints), for a cold
+// page cache drop the caches between --generate and the measurement (Linux: echo 3 > /proc/sys/vm/drop_caches).
+//
+//   F1SeekBench <capture> [--seeks n] [--generate minutes] [--plain]
+//
+//   --seeks n            random seeks per kind (default 200)
+//   --generate minutes   write a synthetic capture of this length to <capture> and exit
+//   --plain              the synthetic capture without delta compression (about 1 GB per hour)
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -IF1Udp -o F1SeekBench F1SeekBench/F1SeekBench.cpp F1Udp/F1ReplayEngine.cpp F1Udp/F1Capture.cpp
+//      F1Udp/F1CaptureCodec.cpp F1Udp/F1Checkpoint.cpp F1Udp/F1MappedFile.cpp F1Udp/F1PacketExtractor.cpp F1Udp/F1PacketFormats.cpp
+//      F1Udp/F1HeaderScan.cpp F1Udp/F1Journal.cpp F1Udp/F1TimingModel.cpp F1Udp/F1TimingTable.cpp F1Udp/F1GapTracker.cpp F1Udp/F1DirtyFields.cpp
+//      F1Udp/F1ChangeFeed.cpp F1Udp/F1FrameAssembler.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "F1PacketRegistry.h"
+#include "F1ReplayEngine.h"
+
+namespace
+{
+   // packet ids of one race frame at 60 Hz (+ session and car damage at 10 Hz)
+   const uint8_t cs_frameIds[] = { 0, 2, 6, 7, 13 };
+   const uint8_t cs_slowIds[] = { 1, 10 };
+   constexpr uint64_t cs_frameNs = 1000000000ull / 60;
+
+   struct Options
+   {
+      const char* pPath{ nullptr };
+      unsigned seeks{ 200 };
+      unsigned generateMinutes{ 0 };
+      bool plain{ false };
+   };
+
+   struct SeekStats
+   {
+      double sumMs{ 0 };
+      double maxMs{ 0 };
+      unsigned count{ 0 };
+      unsigned bad{ 0 };
+
+      void Add(double ms)
+      {
+         sumMs += ms;
+         maxMs = (std::max)(maxMs, ms);
+         ++count;
+      }
+   };
+
+   uint64_t s_NowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   double s_MsSince(uint64_t t0)
+   {
+      return (s_NowNs() - t0) / 1e6;
+   }
+
+   // a menu minute (session UID 0) and then one race session
+   bool s_Generate(const Options& opt)
+   {
+      F1CaptureWriter writer;
+      writer.compression = opt.plain ? CaptureCompression::None : CaptureCompression::Delta;
+      if (!writer.Open(opt.pPath))
+         return false;
+
+      std::vector<F12025_PacketExtractor> extractorStorage(1);
+      F12025_PacketExtractor& extractor = extractorStorage[0];
+      std::vector<uint8_t> packet(2048, 0);
+      std::vector<uint8_t> checkpoint;
+      const uint32_t menuFrames = 60 * 60;
+      const uint32_t frames = menuFrames + opt.generateMinutes * 60 * 60;
+      uint64_t rxNs = 1700000000000000000ull;
+
+      auto write = [&](uint8_t id, uint32_t frame)
+      {
+         PacketHeader header{};
+         header.m_packetFormat = 2025;
+         header.m_gameYear = 25;
+         header.m_packetVersion = 1;
+         header.m_packetId = id;
+         header.m_sessionUID = (frame < menuFrames) ? 0 : 42;
+         header.m_sessionTime = (frame < menuFrames) ? 0.0f : (frame - menuFrames) / 60.0f;
+         header.m_frameIdentifier = frame;
+         header.m_overallFrameIdentifier = frame;
+         memcpy(packet.data(), &header, sizeof(header));
+         memcpy(packet.data() + sizeof(header), &frame, sizeof(frame)); // some payload which changes
+         const unsigned len = PacketWireSize(id);
+         extractor.ProceedPacket(packet.data(), len);
+         writer.Write(packet.data(), len, rxNs);
+      };
+
+      for (uint32_t frame = 0; frame < frames; ++frame)
+      {
+         for (uint8_t id : cs_frameIds)
+            write(id, frame);
+         if (!(frame % 6))
+         {
+            for (uint8_t id : cs_slowIds)
+               write(id, frame);
+         }
+
+         if (writer.CheckpointDue(rxNs))
+         {
+            checkpoint.clear();
+            SaveCheckpoint(extractor, checkpoint);
+            writer.WriteCheckpoint(checkpoint.data(), checkpoint.size(), rxNs, extractor.lastHeader);
+         }
+         rxNs += cs_frameNs;
+      }
+
+      const uint64_t records = writer.Records();
+      const uint64_t bytes = writer.Bytes();
+      if (!writer.Close())
+         return false;
+      printf("written     %s: %llu records, %.1f MB, %u minutes\n", opt.pPath, static_cast<unsigned long long>(records), bytes / 1e6,
+         opt.generateMinutes);
+      return true;
+   }
+
+   PacketHeader s_FirstHeader(F1ReplayEngine& engine)
+   {
+      PacketHeader header{};
+      DatagramDesc datagram;
+      if (engine.NextBatch(&datagram, 1) && (datagram.len >= sizeof(header)))
+         memcpy(&header, datagram.pData, sizeof(header));
+      return header;
+   }
+
+   void s_Print(const char* pName, const SeekStats& stats)
+   {
+      printf("%-28s %8.3f %8.3f %6u\n", pName, stats.count ? stats.sumMs / stats.count : 0.0, stats.maxMs, stats.bad);
+   }
+
+   bool s_ParseArgs(int argc, char** argv, Options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (!strcmp(argv[i], "--seeks") && (i + 1 < argc))
+            opt.seeks = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--generate") && (i + 1 < argc))
+            opt.generateMinutes = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--plain"))
+            opt.plain = true;
+         else if ((argv[i][0] != '-') && !opt.pPath)
+            opt.pPath = argv[i];
+         else
+            return false;
+      }
+      return opt.pPath && opt.seeks;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options opt;
+   if (!s_ParseArgs(argc, argv, opt))
+   {
+      fprintf(stderr, "usage: %s <capture> [--seeks n] [--generate minutes] [--plain]\n", argv[0]);
+      return 2;
+   }
+
+   if (opt.generateMinutes)
+      return s_Generate(opt) ? 0 : 1;
+
+   uint64_t t0 = s_NowNs();
+   F1ReplayEngine engine;
+   if (!engine.Open(opt.pPath))
+   {
+      fprintf(stderr, "can not open capture %s\n", opt.pPath);
+      return 1;
+   }
+   const double openMs = s_MsSince(t0);
+
+   // the longest session
+   size_t session = 0;
+   for (size_t s = 0; s < engine.Sessions().size(); ++s)
+   {
+      const ReplaySession& candidate = engine.Sessions()[s];
+      if (candidate.endRecord - candidate.firstRecord > engine.Sessions()[session].endRecord - engine.Sessions()[session].firstRecord)
+         session = s;
+   }
+   if (engine.Sessions().empty())
+   {
+      fprintf(stderr, "capture %s has no sessions\n", opt.pPath);
+      return 1;
+   }
+
+   // the last frame of the session by bisection, so the measurement does not page in the capture
+   const ReplaySession& target = engine.Sessions()[session];
+   uint32_t lastFrame = target.firstFrame;
+   for (uint32_t step = 0x80000000u; step; step >>= 1)
+   {
+      if ((UINT32_MAX - lastFrame >= step) && engine.SeekFrame(session, lastFrame + step))
+         lastFrame += step;
+   }
+   engine.SeekFrame(session, lastFrame);
+   const float lastTime = (std::max)(target.firstSessionTime, s_FirstHeader(engine).m_sessionTime);
+
+   printf("capture     %s\n", opt.pPath);
+   printf("open        %.2f ms, %llu records, %zu sessions, %zu checkpoints\n", openMs, static_cast<unsigned long long>(engine.Records()),
+      engine.Sessions().size(), engine.Checkpoints().size());
+   printf("session     %zu: %llu records, %.0f s, frames %u .. %u\n\n", session,
+      static_cast<unsigned long long>(target.endRecord - target.firstRecord), lastTime - target.firstSessionTime, target.firstFrame, lastFrame);
+
+   std::mt19937 rng(3);
+   std::uniform_real_distribution<float> timeDist(target.firstSessionTime, lastTime);
+   std::uniform_int_distribution<uint32_t> frameDist(target.firstFrame, lastFrame);
+   std::vector<F12025_PacketExtractor> extractorStorage(1);
+   F12025_PacketExtractor& extractor = extractorStorage[0];
+   extractor.mode = ExtractMode::View;
+
+   SeekStats byTime, byFrame, byTimeState;
+   for (unsigned i = 0; i < opt.seeks; ++i)
+   {
+      const float time = timeDist(rng);
+      t0 = s_NowNs();
+      const bool found = engine.SeekSessionTime(session, time);
+      const PacketHeader header = s_FirstHeader(engine);
+      byTime.Add(s_MsSince(t0));
+      if (!found || (header.m_sessionTime < time) || (header.m_sessionTime > time + 1.0f / 60 + 1e-3f))
+         ++byTime.bad;
+   }
+   for (unsigned i = 0; i < opt.seeks; ++i)
+   {
+      const uint32_t frame = frameDist(rng);
+      t0 = s_NowNs();
+      const bool found = engine.SeekFrame(session, frame);
+      const PacketHeader header = s_FirstHeader(engine);
+      byFrame.Add(s_MsSince(t0));
+      if (!found || (header.m_overallFrameIdentifier != frame))
+         ++byFrame.bad;
+   }
+   for (unsigned i = 0; i < opt.seeks; ++i)
+   {
+      const float time = timeDist(rng);
+      t0 = s_NowNs();
+      const bool found = engine.SeekSessionTime(session, time, extractor);
+      byTimeState.Add(s_MsSince(t0));
+      if (!found || (extractor.sessionUID != target.sessionUID))
+         ++byTimeState.bad;
+   }
+
+   printf("%-28s %8s %8s %6s\n", "seek", "avg ms", "max ms", "bad");
+   s_Print("session time", byTime);
+   s_Print("frame", byFrame);
+   s_Print("session time + state", byTimeState);
+
+   // one lap (90 s) after a seek into the middle
+   engine.SeekSessionTime(session, (target.firstSessionTime + lastTime) / 2, extractor);
+   t0 = s_NowNs();
+   const unsigned replayed = engine.Replay(extractor, 90 * 60 * 6);
+   printf("\nreplay      %u datagrams after a seek in %.1f ms\n", replayed, s_MsSince(t0));
+   return (byTime.bad || byFrame.bad || byTimeState.bad) ? 1 : 0;
+}
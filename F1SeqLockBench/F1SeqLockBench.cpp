@@ -0,0 +1,206 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Contention benchmark of F1PublishedExtractor: one writer proceeds a lap and a status packet and publishes the
+// extractor as the mapper does after every datagram, N reader threads take snapshots at the same time.
+// The writer stamps both packets and one lap field with the same counter, every snapshot is checked for it.
+//
+//   F1SeqLockBench [--readers n] [--seconds n] [--rate n]
+//
+//   --readers n   reader threads (default: one run each with 0, 1, 2 and 4 readers)
+//   --seconds n   duration of a run (default 2)
+//   --rate n      publishes per second (default 0: as fast as possible)
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread -IF1Udp -o F1SeqLockBench F1SeqLockBench/F1SeqLockBench.cpp
+//      F1Udp/F1PublishedExtractor.cpp F1Udp/F1PacketExtractor.cpp F1Udp/F1PacketFormats.cpp F1Udp/F1HeaderScan.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "F1PacketRegistry.h"
+#include "F1PublishedExtractor.h"
+
+namespace
+{
+   constexpr unsigned cs_stampCar = cs_maxNumCarsInUDPData - 1;
+
+   struct Options
+   {
+      int readers{ -1 }; // -1: 0, 1, 2, 4
+      double seconds{ 2.0 };
+      unsigned rate{ 0 };
+   };
+
+   struct RunStats
+   {
+      uint64_t publishes{ 0 };
+      uint64_t publishNs{ 0 };
+      uint64_t publishMaxNs{ 0 };
+      uint64_t reads{ 0 };
+      uint64_t torn{ 0 };
+      double seconds{ 0 };
+   };
+
+   uint64_t s_NowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   std::vector<uint8_t> s_MakePacket(PacketType type)
+   {
+      std::vector<uint8_t> packet(PacketWireSize(static_cast<uint8_t>(type)), 0);
+      PacketHeader header{};
+      header.m_packetFormat = 2025;
+      header.m_gameYear = 25;
+      header.m_packetVersion = 1;
+      header.m_packetId = static_cast<uint8_t>(type);
+      header.m_sessionUID = 1;
+      memcpy(packet.data(), &header, sizeof(header));
+      return packet;
+   }
+
+   void s_Stamp(std::vector<uint8_t>& packet, uint32_t stamp)
+   {
+      memcpy(packet.data() + offsetof(PacketHeader, m_frameIdentifier), &stamp, sizeof(stamp));
+   }
+
+   bool s_Consistent(const ExtractorSnapshot& snapshot)
+   {
+      const uint32_t stamp = snapshot.lap.m_header.m_frameIdentifier;
+      return (snapshot.status.m_header.m_frameIdentifier == stamp) &&
+         (snapshot.lap.m_lapData[cs_stampCar].m_currentLapTimeInMS == stamp);
+   }
+
+   void s_Read(const F1PublishedExtractor& published, const std::atomic<bool>& quit, std::atomic<uint64_t>& reads,
+      std::atomic<uint64_t>& torn)
+   {
+      // too large for the stack of some platforms
+      std::vector<ExtractorSnapshot> snapshotStorage(1);
+      ExtractorSnapshot& snapshot = snapshotStorage[0];
+      uint64_t n = 0, bad = 0;
+      while (!quit.load(std::memory_order_relaxed))
+      {
+         if (!published.Read(snapshot))
+         {
+            std::this_thread::yield();
+            continue;
+         }
+         ++n;
+         if (!s_Consistent(snapshot))
+            ++bad;
+      }
+      reads += n;
+      torn += bad;
+   }
+
+   RunStats s_Run(unsigned readers, const Options& opt)
+   {
+      // the extractor holds one slot per packet type, it is too large for the stack
+      std::vector<F12025_PacketExtractor> extractorStorage(1);
+      F12025_PacketExtractor& extractor = extractorStorage[0];
+      std::vector<F1PublishedExtractor> publishedStorage(1);
+      F1PublishedExtractor& published = publishedStorage[0];
+
+      std::vector<uint8_t> lap = s_MakePacket(PacketType::PacketLapData);
+      std::vector<uint8_t> status = s_MakePacket(PacketType::PacketCarStatusData);
+      const size_t stampOffset = sizeof(PacketHeader) + cs_stampCar * sizeof(LapData) + offsetof(LapData, m_currentLapTimeInMS);
+
+      std::atomic<bool> quit{ false };
+      std::atomic<uint64_t> reads{ 0 }, torn{ 0 };
+      std::vector<std::thread> threads;
+      for (unsigned r = 0; r < readers; ++r)
+         threads.emplace_back(s_Read, std::cref(published), std::cref(quit), std::ref(reads), std::ref(torn));
+
+      RunStats stats;
+      const uint64_t beginNs = s_NowNs();
+      const uint64_t endNs = beginNs + static_cast<uint64_t>(opt.seconds * 1e9);
+      for (uint32_t stamp = 1;; ++stamp)
+      {
+         const uint64_t nowNs = s_NowNs();
+         if (nowNs >= endNs)
+            break;
+         if (opt.rate)
+         {
+            const uint64_t dueNs = beginNs + stamp * 1000000000ull / opt.rate;
+            if (dueNs > nowNs)
+               std::this_thread::sleep_for(std::chrono::nanoseconds(dueNs - nowNs));
+         }
+
+         s_Stamp(lap, stamp);
+         memcpy(lap.data() + stampOffset, &stamp, sizeof(stamp));
+         s_Stamp(status, stamp);
+         extractor.ProceedPacket(lap.data(), static_cast<unsigned>(lap.size()));
+         extractor.ProceedPacket(status.data(), static_cast<unsigned>(status.size()));
+
+         const uint64_t t0 = s_NowNs();
+         published.Publish(extractor);
+         const uint64_t publishNs = s_NowNs() - t0;
+         stats.publishNs += publishNs;
+         stats.publishMaxNs = std::max(stats.publishMaxNs, publishNs);
+         ++stats.publishes;
+      }
+      stats.seconds = (s_NowNs() - beginNs) / 1e9;
+
+      quit = true;
+      for (std::thread& thread : threads)
+         thread.join();
+      stats.reads = reads;
+      stats.torn = torn;
+      return stats;
+   }
+
+   bool s_ParseArgs(int argc, char** argv, Options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (!strcmp(argv[i], "--readers") && (i + 1 < argc))
+            opt.readers = atoi(argv[++i]);
+         else if (!strcmp(argv[i], "--seconds") && (i + 1 < argc))
+            opt.seconds = atof(argv[++i]);
+         else if (!strcmp(argv[i], "--rate") && (i + 1 < argc))
+            opt.rate = static_cast<unsigned>(atoi(argv[++i]));
+         else
+            return false;
+      }
+      return opt.seconds > 0;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options opt;
+   if (!s_ParseArgs(argc, argv, opt))
+   {
+      fprintf(stderr, "usage: %s [--readers n] [--seconds n] [--rate n]\n", argv[0]);
+      return 2;
+   }
+
+   std::vector<unsigned> runs;
+   if (opt.readers >= 0)
+      runs.push_back(static_cast<unsigned>(opt.readers));
+   else
+      runs = { 0, 1, 2, 4 };
+
+   printf("snapshot %zu bytes, %u hardware threads, %s\n\n", sizeof(ExtractorSnapshot), std::thread::hardware_concurrency(),
+      opt.rate ? "paced writer" : "writer as fast as possible");
+   printf("%8s %12s %14s %14s %14s %8s\n", "readers", "publishes/s", "publish us", "publish max us", "reads/s", "torn");
+   uint64_t torn = 0;
+   for (unsigned readers : runs)
+   {
+      const RunStats stats = s_Run(readers, opt);
+      printf("%8u %12.0f %14.2f %14.1f %14.0f %8llu\n", readers, stats.publishes / stats.seconds,
+         stats.publishes ? stats.publishNs / 1e3 / stats.publishes : 0.0, stats.publishMaxNs / 1e3, stats.reads / stats.seconds,
+         static_cast<unsigned long long>(stats.torn));
+      torn += stats.torn;
+   }
+   return torn ? 1 : 0;
+}
@@ -0,0 +1,213 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1BlackBox.h"
+
+#include <string.h>
+#include <system_error>
+
+namespace
+{
+   size_t s_RoundUpPow2(size_t val)
+   {
+      size_t res = 1;
+      while (res < val)
+         res <<= 1;
+      return res;
+   }
+}
+
+F1BlackBox::F1BlackBox(size_t capacityBytes, uint64_t windowNs) :
+   m_capacity(s_RoundUpPow2(capacityBytes < 64 * 1024 ? 64 * 1024 : capacityBytes)),
+   m_mask(m_capacity - 1),
+   m_windowNs(windowNs),
+   m_words(new std::atomic<uint64_t>[m_capacity / sizeof(uint64_t)]),
+   m_dumpBuffer(cs_captureMaxRecordLen)
+{
+   // touch the ring once, so the memory is committed up front and not on the first minutes of a session
+   for (size_t i = 0; i < m_capacity / sizeof(uint64_t); ++i)
+      m_words[i].store(0, std::memory_order_relaxed);
+}
+
+size_t F1BlackBox::MemoryBytes() const
+{
+   return sizeof(*this) + m_capacity + m_dumpBuffer.capacity();
+}
+
+void F1BlackBox::m_Store(uint64_t pos, const void* pSrc, size_t len)
+{
+   // pos is 8 byte aligned and records do not wrap
+   std::atomic<uint64_t>* pWords = m_words.get() + ((pos & m_mask) / sizeof(uint64_t));
+   const uint8_t* pBytes = static_cast<const uint8_t*>(pSrc);
+   while (len)
+   {
+      const size_t n = (len < sizeof(uint64_t)) ? len : sizeof(uint64_t);
+      uint64_t word = 0;
+      memcpy(&word, pBytes, n);
+      (pWords++)->store(word, std::memory_order_relaxed);
+      pBytes += n;
+      len -= n;
+   }
+}
+
+void F1BlackBox::m_Load(uint64_t pos, void* pDst, size_t len) const
+{
+   const std::atomic<uint64_t>* pWords = m_words.get() + ((pos & m_mask) / sizeof(uint64_t));
+   uint8_t* pBytes = static_cast<uint8_t*>(pDst);
+   while (len)
+   {
+      const size_t n = (len < sizeof(uint64_t)) ? len : sizeof(uint64_t);
+      const uint64_t word = (pWords++)->load(std::memory_order_relaxed);
+      memcpy(pBytes, &word, n);
+      pBytes += n;
+      len -= n;
+   }
+}
+
+void F1BlackBox::Push(const uint8_t* pData, unsigned len, uint64_t rxTimestampNs)
+{
+   const uint64_t rec = s_RecordSize(len);
+   if (!pData || !len || (len > cs_captureMaxRecordLen) || (rec > m_capacity / 2))
+   {
+      m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return;
+   }
+
+   const uint64_t pos = m_head.load(std::memory_order_relaxed);
+   const uint64_t toEnd = m_capacity - (pos & m_mask);
+   const uint64_t pad = (toEnd < rec) ? toEnd : 0;
+   const uint64_t newHead = pos + pad + rec;
+
+   // evict by size and age
+   uint64_t tail = m_tail.load(std::memory_order_relaxed);
+   uint64_t evicted = 0;
+   while (tail != pos)
+   {
+      RecordHeader hdr;
+      m_Load(tail, &hdr, sizeof(hdr));
+      if (hdr.len == WRAP)
+      {
+         tail += m_capacity - (tail & m_mask);
+         continue;
+      }
+
+      const bool full = (newHead - tail > m_capacity);
+      const bool old = (hdr.rxTimestampNs + m_windowNs < rxTimestampNs);
+      if (!full && !old)
+         break;
+
+      tail += s_RecordSize(hdr.len);
+      ++evicted;
+   }
+
+   // tail never stops at a wrap marker
+   if (tail == pos)
+      m_oldestNs.store(rxTimestampNs, std::memory_order_relaxed);
+   else if (evicted)
+   {
+      RecordHeader hdr;
+      m_Load(tail, &hdr, sizeof(hdr));
+      m_oldestNs.store(hdr.rxTimestampNs, std::memory_order_relaxed);
+   }
+
+   // a reader which sees any of the bytes written below also sees the new tail, see SeqLock
+   m_tail.store(tail, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+
+   if (pad)
+   {
+      const RecordHeader wrap{ WRAP, 0, 0 };
+      m_Store(pos, &wrap, sizeof(wrap));
+   }
+
+   const RecordHeader hdr{ len, 0, rxTimestampNs };
+   m_Store(pos + pad, &hdr, sizeof(hdr));
+   m_Store(pos + pad + sizeof(hdr), pData, len);
+   m_head.store(newHead, std::memory_order_release);
+
+   m_newestNs.store(rxTimestampNs, std::memory_order_relaxed);
+   m_pushed.store(m_pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   if (evicted)
+      m_evicted.store(m_evicted.load(std::memory_order_relaxed) + evicted, std::memory_order_relaxed);
+}
+
+bool F1BlackBox::Dump(const std::filesystem::path& path, CaptureCompression compression)
+{
+   if (m_dumping.exchange(true, std::memory_order_acquire))
+      return false;
+
+   const bool ok = m_Dump(path, compression);
+   m_dumping.store(false, std::memory_order_release);
+   return ok;
+}
+
+bool F1BlackBox::m_Dump(const std::filesystem::path& path, CaptureCompression compression)
+{
+   std::filesystem::path tmpPath = path;
+   tmpPath += ".tmp";
+
+   F1CaptureWriter writer;
+   writer.compression = compression;
+   writer.checkpointIntervalNs = 0; // the extractor state at the start of the ring is not known
+   if (!writer.Open(tmpPath))
+      return false;
+
+   // the records between tail and head at this point, the writer continues meanwhile
+   const uint64_t head = m_head.load(std::memory_order_acquire);
+   uint64_t pos = m_tail.load(std::memory_order_acquire);
+   bool ok = true;
+
+   while (ok && (pos < head))
+   {
+      RecordHeader hdr;
+      m_Load(pos, &hdr, sizeof(hdr));
+      if (hdr.len != WRAP)
+         m_Load(pos + sizeof(hdr), m_dumpBuffer.data(), (hdr.len <= m_dumpBuffer.size()) ? hdr.len : 0);
+
+      // evicted while copying: continue at the oldest record which is still there
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail > pos)
+      {
+         pos = tail;
+         continue;
+      }
+
+      if (hdr.len == WRAP)
+      {
+         pos += m_capacity - (pos & m_mask);
+         continue;
+      }
+
+      ok = writer.Write(m_dumpBuffer.data(), hdr.len, hdr.rxTimestampNs);
+      pos += s_RecordSize(hdr.len);
+   }
+
+   ok = writer.Close() && ok;
+
+   std::error_code ec;
+   if (ok)
+      std::filesystem::rename(tmpPath, path, ec);
+
+   if (!ok || ec)
+   {
+      std::filesystem::remove(tmpPath, ec);
+      return false;
+   }
+   return true;
+}
+
+F1BlackBoxStats F1BlackBox::Stats() const
+{
+   F1BlackBoxStats stats;
+   stats.pushed = m_pushed.load(std::memory_order_relaxed);
+   stats.evicted = m_evicted.load(std::memory_order_relaxed);
+   stats.dropped = m_dropped.load(std::memory_order_relaxed);
+   stats.heldBytes = m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_relaxed);
+   if (stats.heldBytes)
+   {
+      stats.oldestNs = m_oldestNs.load(std::memory_order_relaxed);
+      stats.newestNs = m_newestNs.load(std::memory_order_relaxed);
+   }
+   return stats;
+}
@@ -0,0 +1,92 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include "F1Capture.h"
+
+struct F1BlackBoxStats
+{
+   uint64_t pushed{ 0 };
+   uint64_t evicted{ 0 };    // datagrams dropped from the ring for newer ones
+   uint64_t dropped{ 0 };    // datagrams larger than half of the capacity, never stored
+   uint64_t heldBytes{ 0 };  // ring bytes in use
+   uint64_t oldestNs{ 0 };   // receive time of the oldest datagram in the ring, 0 if empty
+   uint64_t newestNs{ 0 };
+};
+
+// "Black box" recording: the datagrams of the last windowNs are kept in a ring of fixed size, so an incident can be
+// written to a capture file after it happened. The oldest datagrams are evicted when the window or the capacity is
+// exceeded, nothing is allocated after construction.
+//
+// One writer thread calls Push(), Dump() may run on another thread at the same time without blocking the writer:
+// the ring is copied record by record and a record which was evicted meanwhile is skipped. Like SeqLock the ring is
+// stored as atomic words, so a record overwritten during the copy is detected and never a data race.
+class F1BlackBox
+{
+public:
+   static constexpr size_t cs_defaultCapacity = 64 * 1024 * 1024;
+   static constexpr uint64_t cs_defaultWindowNs = 3 * 60 * 1'000'000'000ull;
+
+   // capacity is rounded up to a power of 2
+   explicit F1BlackBox(size_t capacityBytes = cs_defaultCapacity, uint64_t windowNs = cs_defaultWindowNs);
+   F1BlackBox(const F1BlackBox&) = delete;
+   F1BlackBox& operator=(const F1BlackBox&) = delete;
+
+   // --- writer ---
+
+   void Push(const uint8_t* pData, unsigned len, uint64_t rxTimestampNs);
+
+   // --- any thread ---
+
+   // writes the datagrams in the ring when the call starts to a capture file. The file is written under a temporary
+   // name and renamed when complete, so path is either the whole dump or not touched.
+   // False if the file can not be written or another dump is running.
+   bool Dump(const std::filesystem::path& path, CaptureCompression compression = CaptureCompression::Delta);
+
+   size_t Capacity() const { return m_capacity; }
+   uint64_t WindowNs() const { return m_windowNs; }
+
+   // memory allocated by the black box, fixed after construction
+   size_t MemoryBytes() const;
+
+   F1BlackBoxStats Stats() const;
+
+private:
+   static constexpr uint32_t WRAP = 0xFFFFFFFF; // rest of the buffer is unused, continue at offset 0
+
+   struct RecordHeader
+   {
+      uint32_t len;
+      uint32_t reserved;
+      uint64_t rxTimestampNs;
+   };
+   static_assert(sizeof(RecordHeader) == 16, "records are 16 byte aligned");
+
+   static uint64_t s_RecordSize(unsigned len) { return (sizeof(RecordHeader) + len + 15) & ~uint64_t(15); }
+
+   void m_Store(uint64_t pos, const void* pSrc, size_t len);
+   void m_Load(uint64_t pos, void* pDst, size_t len) const;
+   bool m_Dump(const std::filesystem::path& path, CaptureCompression compression);
+
+   const size_t m_capacity;
+   const uint64_t m_mask;
+   const uint64_t m_windowNs;
+   std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+   std::vector<uint8_t> m_dumpBuffer; // one record, for Dump()
+
+   // written by the writer only
+   alignas(64) std::atomic<uint64_t> m_head{ 0 };
+   std::atomic<uint64_t> m_tail{ 0 };
+   std::atomic<uint64_t> m_oldestNs{ 0 };
+   std::atomic<uint64_t> m_newestNs{ 0 };
+   std::atomic<uint64_t> m_pushed{ 0 };
+   std::atomic<uint64_t> m_evicted{ 0 };
+   std::atomic<uint64_t> m_dropped{ 0 };
+
+   alignas(64) std::atomic<bool> m_dumping{ false };
+};
@@ -0,0 +1,488 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1Capture.h"
+#include "F1DataDefs.h"
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+   constexpr size_t cs_writeBufferSize = 1024 * 1024;
+
+   CaptureRecordHeader s_MakeRecordHeader(const uint8_t* pData, unsigned len, uint64_t rxTimestampNs)
+   {
+      CaptureRecordHeader rec{};
+      rec.len = len;
+      rec.packetId = 255;
+      rec.rxTimestampNs = rxTimestampNs;
+
+      if (len >= sizeof(PacketHeader))
+      {
+         PacketHeader hdr;
+         memcpy(&hdr, pData, sizeof(hdr));
+         rec.packetId = hdr.m_packetId;
+         rec.sessionTime = hdr.m_sessionTime;
+         rec.frameIdentifier = hdr.m_frameIdentifier;
+      }
+      return rec;
+   }
+}
+
+bool CaptureIndexBuilder::Add(uint64_t offset, uint64_t record, const CaptureRecordHeader& rec, const PacketHeader* pHeader)
+{
+   // a checkpoint holds the state of the session of the datagrams before it
+   if (rec.kind == CaptureRecordKind::Checkpoint)
+   {
+      checkpoints.push_back(CaptureIndexEntry{ offset, record, rec.rxTimestampNs, m_sessionUID, rec.sessionTime, rec.frameIdentifier });
+      return false;
+   }
+
+   PacketHeader hdr{};
+   if (pHeader)
+      hdr = *pHeader;
+
+   // a new session always starts with an entry, so a session never shares an entry with the previous one
+   const bool newEntry = entries.empty() || (m_sinceEntry >= cs_captureIndexInterval) || (hdr.m_sessionUID != m_sessionUID);
+   if (newEntry)
+   {
+      entries.push_back(CaptureIndexEntry{ offset, record, rec.rxTimestampNs, hdr.m_sessionUID, hdr.m_sessionTime, hdr.m_overallFrameIdentifier });
+      m_sinceEntry = 0;
+      m_sessionUID = hdr.m_sessionUID;
+   }
+   ++m_sinceEntry;
+   return newEntry;
+}
+
+void CaptureIndexBuilder::Clear()
+{
+   entries.clear();
+   checkpoints.clear();
+   m_sinceEntry = 0;
+   m_sessionUID = 0;
+}
+
+bool F1CaptureWriter::Open(const std::filesystem::path& path)
+{
+   Close();
+
+   // the buffer must be set before the file is opened
+   m_buffer.resize(cs_writeBufferSize);
+   m_file.rdbuf()->pubsetbuf(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+   m_file.open(path, std::ios::binary | std::ios::trunc);
+   if (!m_file.is_open())
+      return false;
+
+   CaptureFileHeader hdr{};
+   memcpy(hdr.magic, cs_captureMagic, sizeof(hdr.magic));
+   hdr.version = cs_captureVersion;
+   hdr.headerSize = sizeof(CaptureFileHeader);
+   hdr.createdNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+   hdr.flags = (compression == CaptureCompression::Delta) ? cs_captureFlagDelta : 0;
+   m_file.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+
+   m_index.Clear();
+   m_codec.Reset();
+   m_delta = (compression == CaptureCompression::Delta);
+   m_resetPending = true;
+   m_offset = sizeof(hdr);
+   m_records = 0;
+   m_firstTimestampNs = 0;
+   m_lastTimestampNs = 0;
+   m_lastCheckpointNs = 0;
+   m_checkpointBytes = 0;
+   return m_file.good();
+}
+
+bool F1CaptureWriter::Write(const uint8_t* pData, unsigned len, uint64_t rxTimestampNs)
+{
+   if (!m_file.is_open() || !pData || !len || (len > cs_captureMaxRecordLen))
+      return false;
+
+   CaptureRecordHeader rec = s_MakeRecordHeader(pData, len, rxTimestampNs);
+   PacketHeader hdr;
+   if (len >= sizeof(hdr))
+      memcpy(&hdr, pData, sizeof(hdr));
+
+   // reading can start at each index entry, the references must not reach back
+   if (m_index.Add(m_offset, m_records, rec, (len >= sizeof(hdr)) ? &hdr : nullptr) || m_resetPending)
+   {
+      rec.flags |= cs_captureRecordReset;
+      m_codec.Reset();
+      m_resetPending = false;
+   }
+
+   const uint8_t* pPayload = pData;
+   if (m_delta)
+   {
+      m_encoded.clear();
+      if (m_codec.Encode(pData, len, m_encoded))
+      {
+         rec.kind = CaptureRecordKind::DeltaDatagram;
+         rec.len = static_cast<uint32_t>(m_encoded.size());
+         pPayload = m_encoded.data();
+      }
+   }
+
+   if (!m_records)
+      m_firstTimestampNs = m_lastCheckpointNs = rxTimestampNs;
+   m_lastTimestampNs = rxTimestampNs;
+
+   m_file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+   m_file.write(reinterpret_cast<const char*>(pPayload), rec.len);
+
+   m_offset += sizeof(rec) + rec.len;
+   ++m_records;
+   return m_file.good();
+}
+
+bool F1CaptureWriter::CheckpointDue(uint64_t rxTimestampNs) const
+{
+   return m_file.is_open() && checkpointIntervalNs && m_records && (rxTimestampNs - m_lastCheckpointNs >= checkpointIntervalNs);
+}
+
+bool F1CaptureWriter::WriteCheckpoint(const uint8_t* pData, size_t len, uint64_t rxTimestampNs, const PacketHeader& lastHeader)
+{
+   if (!m_file.is_open() || !pData || !len || (len > cs_captureMaxCheckpointLen))
+      return false;
+
+   CaptureRecordHeader rec{};
+   rec.len = static_cast<uint32_t>(len);
+   rec.packetId = 255;
+   rec.kind = CaptureRecordKind::Checkpoint;
+   rec.rxTimestampNs = rxTimestampNs;
+   rec.sessionTime = lastHeader.m_sessionTime;
+   rec.frameIdentifier = lastHeader.m_overallFrameIdentifier;
+   m_index.Add(m_offset, m_records, rec, nullptr);
+
+   m_file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+   m_file.write(reinterpret_cast<const char*>(pData), static_cast<std::streamsize>(len));
+
+   // reading can start after a checkpoint
+   m_offset += sizeof(rec) + len;
+   m_resetPending = true;
+   m_lastCheckpointNs = rxTimestampNs;
+   m_checkpointBytes += len;
+   return m_file.good();
+}
+
+bool F1CaptureWriter::Close()
+{
+   if (!m_file.is_open())
+      return false;
+
+   CaptureFileTrailer trailer{};
+   trailer.indexOffset = m_offset;
+   trailer.indexCount = m_index.entries.size();
+   trailer.recordCount = m_records;
+   trailer.firstTimestampNs = m_firstTimestampNs;
+   trailer.lastTimestampNs = m_lastTimestampNs;
+   trailer.checkpointOffset = trailer.indexOffset + trailer.indexCount * sizeof(CaptureIndexEntry);
+   trailer.checkpointCount = m_index.checkpoints.size();
+   memcpy(trailer.magic, cs_captureTrailerMagic, sizeof(trailer.magic));
+
+   if (!m_index.entries.empty())
+      m_file.write(reinterpret_cast<const char*>(m_index.entries.data()), static_cast<std::streamsize>(m_index.entries.size() * sizeof(CaptureIndexEntry)));
+   if (!m_index.checkpoints.empty())
+      m_file.write(reinterpret_cast<const char*>(m_index.checkpoints.data()), static_cast<std::streamsize>(m_index.checkpoints.size() * sizeof(CaptureIndexEntry)));
+   m_file.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+   const bool ok = m_file.good();
+   m_file.close();
+   m_index.Clear();
+   return ok;
+}
+
+bool F1CaptureReader::IsCapture(const std::filesystem::path& path)
+{
+   std::ifstream file(path, std::ios::binary);
+   char magic[sizeof(cs_captureMagic)] = {};
+   file.read(magic, sizeof(magic));
+   return file.good() && !memcmp(magic, cs_captureMagic, sizeof(magic));
+}
+
+bool F1CaptureReader::Open(const std::filesystem::path& path)
+{
+   Close();
+
+   m_file.open(path, std::ios::binary);
+   if (!m_file.is_open())
+      return false;
+
+   m_file.seekg(0, std::ios::end);
+   const uint64_t fileSize = static_cast<uint64_t>(m_file.tellg());
+   m_file.seekg(0);
+
+   CaptureFileHeader hdr{};
+   m_file.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (!m_file.good() || memcmp(hdr.magic, cs_captureMagic, sizeof(hdr.magic)) || (hdr.version != cs_captureVersion) ||
+      (hdr.headerSize < sizeof(hdr)) || (hdr.headerSize > fileSize))
+   {
+      Close();
+      return false;
+   }
+
+   m_dataBegin = hdr.headerSize;
+   m_delta = (hdr.flags & cs_captureFlagDelta) != 0;
+   if (!m_ReadIndex(fileSize) && !m_RebuildIndex(fileSize))
+   {
+      Close();
+      return false;
+   }
+
+   Rewind();
+   return true;
+}
+
+void F1CaptureReader::Close()
+{
+   if (m_file.is_open())
+      m_file.close();
+
+   m_file.clear();
+   m_index.clear();
+   m_indexed = false;
+   m_delta = false;
+   m_dataBegin = m_dataEnd = 0;
+   m_records = 0;
+   m_firstTimestampNs = m_lastTimestampNs = 0;
+   m_offset = m_position = 0;
+   m_peeked = false;
+}
+
+bool F1CaptureReader::m_ReadIndex(uint64_t fileSize)
+{
+   CaptureFileTrailer trailer{};
+   if (fileSize < m_dataBegin + sizeof(trailer))
+      return false;
+
+   m_file.seekg(static_cast<std::streamoff>(fileSize - sizeof(trailer)));
+   m_file.read(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+   if (!m_file.good() || memcmp(trailer.magic, cs_captureTrailerMagic, sizeof(trailer.magic)))
+   {
+      m_file.clear();
+      return false;
+   }
+
+   // the checkpoint index is not needed for streaming, only its position is checked
+   const uint64_t indexBytes = trailer.indexCount * sizeof(CaptureIndexEntry);
+   const uint64_t checkpointBytes = trailer.checkpointCount * sizeof(CaptureIndexEntry);
+   if ((trailer.indexOffset < m_dataBegin) || (trailer.indexOffset + indexBytes != trailer.checkpointOffset) ||
+      (trailer.checkpointOffset + checkpointBytes + sizeof(trailer) != fileSize))
+      return false;
+
+   m_index.resize(static_cast<size_t>(trailer.indexCount));
+   m_file.seekg(static_cast<std::streamoff>(trailer.indexOffset));
+   if (indexBytes)
+      m_file.read(reinterpret_cast<char*>(m_index.data()), static_cast<std::streamsize>(indexBytes));
+   if (!m_file.good())
+   {
+      m_file.clear();
+      m_index.clear();
+      return false;
+   }
+
+   m_dataEnd = trailer.indexOffset;
+   m_records = trailer.recordCount;
+   m_firstTimestampNs = trailer.firstTimestampNs;
+   m_lastTimestampNs = trailer.lastTimestampNs;
+   m_indexed = true;
+   return true;
+}
+
+bool F1CaptureReader::m_RebuildIndex(uint64_t fileSize)
+{
+   // no trailer: walk the record headers up to the last complete record
+   m_dataEnd = fileSize;
+   m_records = 0;
+
+   CaptureIndexBuilder builder;
+   uint64_t offset = m_dataBegin;
+   CaptureRecordHeader rec;
+   while (m_ReadRecordHeader(offset, rec))
+   {
+      const uint64_t recordOffset = offset;
+      offset += sizeof(rec) + rec.len;
+      if (!CaptureIsDatagram(rec))
+         continue;
+
+      unsigned len = 0;
+      const uint8_t* pPayload = m_ReadPayload(rec, len);
+      if (!pPayload)
+      {
+         offset = recordOffset;
+         break;
+      }
+
+      PacketHeader hdr;
+      if (len >= sizeof(hdr))
+         memcpy(&hdr, pPayload, sizeof(hdr));
+      builder.Add(recordOffset, m_records, rec, (len >= sizeof(hdr)) ? &hdr : nullptr);
+
+      if (!m_records)
+         m_firstTimestampNs = rec.rxTimestampNs;
+      m_lastTimestampNs = rec.rxTimestampNs;
+      ++m_records;
+   }
+
+   m_file.clear();
+   m_index = std::move(builder.entries);
+   m_dataEnd = offset;
+   m_indexed = false;
+   return true;
+}
+
+bool F1CaptureReader::m_ReadRecordHeader(uint64_t offset, CaptureRecordHeader& hdr)
+{
+   if (offset + sizeof(hdr) > m_dataEnd)
+      return false;
+
+   m_file.seekg(static_cast<std::streamoff>(offset));
+   m_file.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (!m_file.good())
+   {
+      m_file.clear();
+      return false;
+   }
+
+   return CaptureRecordValid(hdr) && (offset + sizeof(hdr) + hdr.len <= m_dataEnd);
+}
+
+const uint8_t* F1CaptureReader::m_ReadPayload(const CaptureRecordHeader& hdr, unsigned& len)
+{
+   if (m_payload.size() < hdr.len)
+      m_payload.resize(hdr.len);
+   m_file.read(reinterpret_cast<char*>(m_payload.data()), hdr.len);
+   if (!m_file.good())
+   {
+      m_file.clear();
+      return nullptr;
+   }
+
+   if (hdr.flags & cs_captureRecordReset)
+      m_codec.Reset();
+
+   if (hdr.kind == CaptureRecordKind::DeltaDatagram)
+      return m_codec.Decode(m_payload.data(), hdr.len, len);
+
+   // plain records are references for the following deltas
+   if (m_delta)
+      m_codec.Update(m_payload.data(), hdr.len);
+   len = hdr.len;
+   return m_payload.data();
+}
+
+void F1CaptureReader::m_SeekTo(uint64_t offset, uint64_t record)
+{
+   m_offset = offset;
+   m_position = record;
+   m_peeked = false;
+   m_file.clear();
+   m_file.seekg(static_cast<std::streamoff>(offset));
+}
+
+bool F1CaptureReader::Next(CaptureRecord& rec)
+{
+   if (!Peek(rec))
+      return false;
+
+   m_peeked = false;
+   m_offset = m_peekedEnd;
+   ++m_position;
+   return true;
+}
+
+bool F1CaptureReader::Peek(CaptureRecord& rec)
+{
+   if (m_peeked)
+   {
+      rec = m_peekedRecord;
+      return true;
+   }
+
+   if (!m_file.is_open() || (m_position >= m_records))
+      return false;
+
+   // sequential reads, the stream position is already at m_offset
+   CaptureRecordHeader hdr;
+   for (;;)
+   {
+      if (m_offset + sizeof(hdr) > m_dataEnd)
+         return false;
+
+      m_file.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+      if (!m_file.good() || !CaptureRecordValid(hdr) || (m_offset + sizeof(hdr) + hdr.len > m_dataEnd))
+      {
+         m_SeekTo(m_offset, m_position);
+         return false;
+      }
+
+      if (CaptureIsDatagram(hdr))
+         break;
+
+      m_offset += sizeof(hdr) + hdr.len;
+      m_file.seekg(static_cast<std::streamoff>(m_offset));
+   }
+
+   unsigned len = 0;
+   const uint8_t* pPayload = m_ReadPayload(hdr, len);
+   if (!pPayload)
+   {
+      m_SeekTo(m_offset, m_position);
+      return false;
+   }
+
+   m_peekedEnd = m_offset + sizeof(hdr) + hdr.len;
+   m_peekedRecord.pData = pPayload;
+   m_peekedRecord.len = len;
+   m_peekedRecord.packetId = hdr.packetId;
+   m_peekedRecord.rxTimestampNs = hdr.rxTimestampNs;
+   m_peekedRecord.sessionTime = hdr.sessionTime;
+   m_peekedRecord.frameIdentifier = hdr.frameIdentifier;
+   m_peeked = true;
+
+   rec = m_peekedRecord;
+   return true;
+}
+
+void F1CaptureReader::Rewind()
+{
+   m_SeekTo(m_dataBegin, 0);
+}
+
+bool F1CaptureReader::Seek(uint64_t timestampNs)
+{
+   if (!m_file.is_open())
+      return false;
+
+   // last index entry before the timestamp, then record by record (at most cs_captureIndexInterval)
+   auto it = std::upper_bound(m_index.begin(), m_index.end(), timestampNs,
+      [](uint64_t ts, const CaptureIndexEntry& entry) { return ts <= entry.rxTimestampNs; });
+
+   uint64_t offset = m_dataBegin;
+   uint64_t record = 0;
+   if (it != m_index.begin())
+   {
+      --it;
+      offset = it->offset;
+      record = it->record;
+   }
+
+   // the walked records are decoded, the following deltas refer to them
+   CaptureRecordHeader hdr;
+   unsigned len;
+   while ((record < m_records) && m_ReadRecordHeader(offset, hdr) && (!CaptureIsDatagram(hdr) || (hdr.rxTimestampNs < timestampNs)))
+   {
+      if (CaptureIsDatagram(hdr) && m_delta && !m_ReadPayload(hdr, len))
+         break;
+
+      offset += sizeof(hdr) + hdr.len;
+      if (CaptureIsDatagram(hdr))
+         ++record;
+   }
+
+   m_SeekTo(offset, record);
+   return record < m_records;
+}
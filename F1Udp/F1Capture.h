@@ -0,0 +1,259 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "F1CaptureCodec.h"
+
+struct PacketHeader;
+
+// Capture file of received datagrams, all values little endian:
+//   CaptureFileHeader
+//   per datagram: CaptureRecordHeader + payload
+//   between the datagrams, every checkpointInterval: CaptureRecordHeader (kind Checkpoint) + checkpoint (F1Checkpoint.h)
+//   CaptureIndexEntry[indexCount], one per cs_captureIndexInterval records and one at each session change
+//   CaptureIndexEntry[checkpointCount], one per checkpoint
+//   CaptureFileTrailer
+// Record numbers count the datagrams only, a checkpoint is the state after the datagrams before it.
+// With cs_captureFlagDelta most datagrams are stored as delta to the previous one of the same type (F1CaptureCodec.h).
+// The delta references are reset at every indexed record and after every checkpoint (cs_captureRecordReset),
+// so reading can start there.
+// The trailer is written by Close(). A file without one (e.g. after a crash) is still readable, the index is
+// rebuilt by reading the record headers.
+
+#pragma pack(push, 1)
+
+struct CaptureFileHeader
+{
+   char magic[8];       // cs_captureMagic
+   uint32_t version;    // cs_captureVersion
+   uint32_t headerSize; // sizeof(CaptureFileHeader), records start here
+   uint64_t createdNs;  // system clock, ns since 1970
+   uint32_t flags;      // cs_captureFlag...
+   uint32_t reserved;
+};
+
+enum class CaptureRecordKind : uint8_t
+{
+   Datagram = 0,
+   Checkpoint = 1,
+   DeltaDatagram = 2 // CaptureDeltaHeader + delta
+};
+
+struct CaptureRecordHeader
+{
+   uint32_t len;             // payload bytes following this header
+   uint8_t packetId;         // m_packetId, 255 if the payload has no complete PacketHeader or is a checkpoint
+   CaptureRecordKind kind;
+   uint8_t flags;            // cs_captureRecord...
+   uint8_t reserved;
+   uint64_t rxTimestampNs;   // receive time, system clock
+   float sessionTime;        // m_sessionTime
+   uint32_t frameIdentifier; // m_frameIdentifier, m_overallFrameIdentifier for checkpoints
+};
+
+struct CaptureIndexEntry
+{
+   uint64_t offset;        // file offset of the record
+   uint64_t record;        // record number, for checkpoints the number of the next datagram
+   uint64_t rxTimestampNs;
+   uint64_t sessionUID;    // of the record, 0 if it has no complete PacketHeader
+   float sessionTime;
+   uint32_t overallFrameIdentifier;
+};
+
+struct CaptureFileTrailer
+{
+   uint64_t indexOffset;
+   uint64_t indexCount;
+   uint64_t recordCount;
+   uint64_t firstTimestampNs;
+   uint64_t lastTimestampNs;
+   uint64_t checkpointOffset;
+   uint64_t checkpointCount;
+   char magic[8]; // cs_captureTrailerMagic
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(CaptureFileHeader) == 32);
+static_assert(sizeof(CaptureRecordHeader) == 24);
+static_assert(sizeof(CaptureIndexEntry) == 40);
+static_assert(sizeof(CaptureFileTrailer) == 64);
+
+inline constexpr char cs_captureMagic[8] = { 'K', 'R', 'F', '1', 'C', 'A', 'P', 0 };
+inline constexpr char cs_captureTrailerMagic[8] = { 'K', 'R', 'F', '1', 'I', 'D', 'X', 0 };
+inline constexpr uint32_t cs_captureVersion = 4; // 2: session and frame in the index, 3: checkpoints, 4: delta records
+inline constexpr uint32_t cs_captureFlagDelta = 1;   // file may contain DeltaDatagram records
+inline constexpr uint8_t cs_captureRecordReset = 1;  // delta references are reset before this record
+inline constexpr unsigned cs_captureIndexInterval = 256;
+inline constexpr unsigned cs_captureMaxRecordLen = 64 * 1024; // larger records are taken as a corrupt file
+inline constexpr unsigned cs_captureMaxCheckpointLen = 4 * 1024 * 1024;
+inline constexpr uint64_t cs_captureCheckpointIntervalNs = 10'000'000'000ull;
+
+// false for records of an unknown kind and for lengths which can only come from a corrupt file
+inline bool CaptureRecordValid(const CaptureRecordHeader& rec)
+{
+   switch (rec.kind)
+   {
+   case CaptureRecordKind::Datagram:
+   case CaptureRecordKind::DeltaDatagram:
+      return rec.len && (rec.len <= cs_captureMaxRecordLen);
+   case CaptureRecordKind::Checkpoint:
+      return rec.len && (rec.len <= cs_captureMaxCheckpointLen);
+   default:
+      return false;
+   }
+}
+
+inline bool CaptureIsDatagram(const CaptureRecordHeader& rec)
+{
+   return (rec.kind == CaptureRecordKind::Datagram) || (rec.kind == CaptureRecordKind::DeltaDatagram);
+}
+
+enum class CaptureCompression
+{
+   None,
+   Delta
+};
+
+// one record read from a capture, pData is valid until the next call to the reader
+struct CaptureRecord
+{
+   const uint8_t* pData{ nullptr };
+   unsigned len{ 0 };
+   uint8_t packetId{ 255 };
+   uint64_t rxTimestampNs{ 0 };
+   float sessionTime{ 0 };
+   uint32_t frameIdentifier{ 0 };
+};
+
+// Collects the index entries while records are appended, used by the writer and for files without index
+class CaptureIndexBuilder
+{
+public:
+   // pHeader: of the decoded payload, nullptr if it has no complete PacketHeader
+   // datagram records go to entries, checkpoint records to checkpoints. True if a datagram starts a new entry.
+   bool Add(uint64_t offset, uint64_t record, const CaptureRecordHeader& rec, const PacketHeader* pHeader);
+   void Clear();
+
+   std::vector<CaptureIndexEntry> entries;
+   std::vector<CaptureIndexEntry> checkpoints;
+
+private:
+   unsigned m_sinceEntry{ 0 };
+   uint64_t m_sessionUID{ 0 };
+};
+
+class F1CaptureWriter
+{
+public:
+   F1CaptureWriter() = default;
+   ~F1CaptureWriter() { Close(); }
+   F1CaptureWriter(const F1CaptureWriter&) = delete;
+   F1CaptureWriter& operator=(const F1CaptureWriter&) = delete;
+
+   // creates or truncates the file, with the current compression
+   bool Open(const std::filesystem::path& path);
+
+   bool Write(const uint8_t* pData, unsigned len, uint64_t rxTimestampNs);
+
+   // true if the checkpoint interval passed since the last checkpoint (or the first record)
+   bool CheckpointDue(uint64_t rxTimestampNs) const;
+
+   // checkpoint (F1Checkpoint.h) of the state after the records written so far, lastHeader: of the last packet
+   bool WriteCheckpoint(const uint8_t* pData, size_t len, uint64_t rxTimestampNs, const PacketHeader& lastHeader);
+
+   // writes the index, returns false if the file was not open or a write failed
+   bool Close();
+
+   bool IsOpen() const { return m_file.is_open(); }
+   uint64_t Records() const { return m_records; }
+   uint64_t Checkpoints() const { return m_index.checkpoints.size(); }
+   uint64_t CheckpointBytes() const { return m_checkpointBytes; }
+
+   uint64_t Bytes() const { return m_offset; }
+
+   // 0: no checkpoints
+   uint64_t checkpointIntervalNs{ cs_captureCheckpointIntervalNs };
+   CaptureCompression compression{ CaptureCompression::Delta };
+
+private:
+   std::ofstream m_file;
+   std::vector<char> m_buffer;
+   CaptureIndexBuilder m_index;
+   CaptureDeltaCodec m_codec;
+   std::vector<uint8_t> m_encoded;
+   bool m_delta{ false };
+   bool m_resetPending{ false };
+   uint64_t m_offset{ 0 };
+   uint64_t m_records{ 0 };
+   uint64_t m_firstTimestampNs{ 0 };
+   uint64_t m_lastTimestampNs{ 0 };
+   uint64_t m_lastCheckpointNs{ 0 };
+   uint64_t m_checkpointBytes{ 0 };
+};
+
+class F1CaptureReader
+{
+public:
+   F1CaptureReader() = default;
+   F1CaptureReader(const F1CaptureReader&) = delete;
+   F1CaptureReader& operator=(const F1CaptureReader&) = delete;
+
+   // reads header, trailer and index only. Checkpoint records are skipped, see F1ReplayEngine.
+   bool Open(const std::filesystem::path& path);
+   void Close();
+
+   // true if the file starts with the capture magic
+   static bool IsCapture(const std::filesystem::path& path);
+
+   bool IsOpen() const { return m_file.is_open(); }
+   bool Indexed() const { return m_indexed; } // false: no trailer, the index was rebuilt on Open()
+   uint64_t Records() const { return m_records; }
+   uint64_t FirstTimestampNs() const { return m_firstTimestampNs; }
+   uint64_t LastTimestampNs() const { return m_lastTimestampNs; }
+
+   // number of the record returned by the next Next()
+   uint64_t Position() const { return m_position; }
+
+   bool Next(CaptureRecord& rec);
+
+   // like Next(), but the record is returned again by the next call
+   bool Peek(CaptureRecord& rec);
+
+   void Rewind();
+
+   // position to the first record with rxTimestampNs >= timestampNs
+   bool Seek(uint64_t timestampNs);
+
+private:
+   bool m_ReadRecordHeader(uint64_t offset, CaptureRecordHeader& hdr);
+
+   // reads the payload of the record at the stream position and decodes it, nullptr on errors
+   const uint8_t* m_ReadPayload(const CaptureRecordHeader& hdr, unsigned& len);
+   bool m_ReadIndex(uint64_t fileSize);
+   bool m_RebuildIndex(uint64_t fileSize);
+   void m_SeekTo(uint64_t offset, uint64_t record);
+
+   std::ifstream m_file;
+   std::vector<uint8_t> m_payload;
+   CaptureDeltaCodec m_codec;
+   bool m_delta{ false };
+   std::vector<CaptureIndexEntry> m_index;
+   bool m_indexed{ false };
+   uint64_t m_dataBegin{ 0 };
+   uint64_t m_dataEnd{ 0 };
+   uint64_t m_records{ 0 };
+   uint64_t m_firstTimestampNs{ 0 };
+   uint64_t m_lastTimestampNs{ 0 };
+
+   uint64_t m_offset{ 0 };   // of the next record
+   uint64_t m_position{ 0 }; // record number of the next record
+   bool m_peeked{ false };
+   uint64_t m_peekedEnd{ 0 }; // offset after the peeked record
+   CaptureRecord m_peekedRecord{};
+};
@@ -0,0 +1,291 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1CaptureClr.h"
+
+namespace adjsw::F12025
+{
+   F1CaptureFile::F1CaptureFile(String^ filename)
+   {
+      m_pacer = new F1ReplayPacer();
+
+      pin_ptr<const wchar_t> pFilename = PtrToStringChars(filename);
+      const std::filesystem::path path(pFilename);
+
+      if (F1PcapReader::IsPcap(path))
+      {
+         m_pcap = new F1PcapReader();
+         m_pcap->Open(path);
+         return;
+      }
+
+      m_reader = new F1CaptureReader();
+      m_reader->Open(path);
+      m_engine = new F1ReplayEngine();
+      m_engine->Open(path);
+   }
+
+   F1CaptureFile::~F1CaptureFile()
+   {
+      this->!F1CaptureFile();
+   }
+
+   F1CaptureFile::!F1CaptureFile()
+   {
+      StopPlayback();
+
+      delete m_pacer;
+      m_pacer = nullptr;
+      delete m_reader;
+      m_reader = nullptr;
+      delete m_engine;
+      m_engine = nullptr;
+      delete m_pcap;
+      m_pcap = nullptr;
+   }
+
+   bool F1CaptureFile::IsCaptureFile(String^ filename)
+   {
+      pin_ptr<const wchar_t> pFilename = PtrToStringChars(filename);
+      const std::filesystem::path path(pFilename);
+      return F1CaptureReader::IsCapture(path) || F1PcapReader::IsPcap(path);
+   }
+
+   bool F1CaptureFile::ExportPcap(String^ capture, String^ pcap)
+   {
+      pin_ptr<const wchar_t> pCapture = PtrToStringChars(capture);
+      pin_ptr<const wchar_t> pPcap = PtrToStringChars(pcap);
+      return ExportCaptureToPcap(std::filesystem::path(pCapture), std::filesystem::path(pPcap));
+   }
+
+   UInt64 F1CaptureFile::Count::get()
+   {
+      if (m_pcap)
+         return m_pcap->Records();
+      return m_reader ? m_reader->Records() : 0;
+   }
+
+   UInt64 F1CaptureFile::Position::get()
+   {
+      if (m_playThread)
+         return m_playPosition;
+      if (m_pcap)
+         return m_pcap->Position();
+      return m_reader ? m_reader->Position() : 0;
+   }
+
+   uint64_t F1CaptureFile::m_FirstTimestampNs()
+   {
+      return m_pcap ? m_pcap->FirstTimestampNs() : m_reader->FirstTimestampNs();
+   }
+
+   UInt64 F1CaptureFile::DurationMs::get()
+   {
+      if (!IsOpen || !Count)
+         return 0;
+
+      const uint64_t lastNs = m_pcap ? m_pcap->LastTimestampNs() : m_reader->LastTimestampNs();
+      return (lastNs - m_FirstTimestampNs()) / 1000000;
+   }
+
+   UInt64 F1CaptureFile::NextTimestampMs::get()
+   {
+      if (!IsOpen)
+         return UInt64::MaxValue;
+
+      uint64_t rxTimestampNs;
+      if (m_pcap)
+      {
+         DatagramDesc datagram;
+         if (!m_pcap->Peek(datagram))
+            return UInt64::MaxValue;
+         rxTimestampNs = datagram.rxTimestampNs;
+      }
+      else
+      {
+         CaptureRecord rec;
+         if (!m_reader->Peek(rec))
+            return UInt64::MaxValue;
+         rxTimestampNs = rec.rxTimestampNs;
+      }
+
+      // pcap time stamps may go back (e.g. merged files)
+      const uint64_t firstNs = m_FirstTimestampNs();
+      return (rxTimestampNs > firstNs) ? (rxTimestampNs - firstNs) / 1000000 : 0;
+   }
+
+   void F1CaptureFile::Rewind()
+   {
+      if (!IsOpen)
+         return;
+
+      F1UdpClrMapper^ mapper = m_mapper;
+      const int emitPort = m_emitPort;
+      const bool playing = Playing;
+      StopPlayback();
+
+      if (m_pcap)
+         m_pcap->Rewind();
+      else
+         m_reader->Rewind();
+
+      if (playing)
+         StartPlayback(mapper, emitPort);
+   }
+
+   int F1CaptureFile::EnqueueUntil(UInt64 timestampMs, F1UdpClrMapper^ mapper)
+   {
+      if (!IsOpen)
+         return 0;
+
+      const uint64_t untilNs = m_FirstTimestampNs() + timestampMs * 1000000;
+      int cnt = 0;
+
+      if (m_pcap)
+      {
+         // the payloads point into the mapping, no copy until the mapper's queue
+         DatagramDesc datagram;
+         while (m_pcap->Peek(datagram) && (datagram.rxTimestampNs < untilNs))
+         {
+            if (!mapper->EnqueueDatagram(datagram.pData, datagram.len, datagram.rxTimestampNs))
+               break; // queue full, continue with the next call
+
+            m_pcap->Next(datagram);
+            ++cnt;
+         }
+         return cnt;
+      }
+
+      CaptureRecord rec;
+      while (m_reader->Peek(rec) && (rec.rxTimestampNs < untilNs))
+      {
+         if (!mapper->EnqueueDatagram(rec.pData, rec.len, rec.rxTimestampNs))
+            break; // queue full, continue with the next call
+
+         m_reader->Next(rec);
+         ++cnt;
+      }
+      return cnt;
+   }
+
+   bool F1CaptureFile::Seek(UInt64 timestampMs, F1UdpClrMapper^ mapper)
+   {
+      if (!m_reader || !m_reader->IsOpen() || !m_engine->IsOpen() || !mapper)
+         return false;
+
+      const int emitPort = m_emitPort;
+      const bool playing = Playing;
+      StopPlayback();
+
+      CaptureRecord rec;
+      PacketHeader hdr{};
+      bool restored = false;
+      if (m_reader->Seek(m_FirstTimestampNs() + timestampMs * 1000000) && m_reader->Peek(rec) && (rec.len >= sizeof(hdr)))
+      {
+         // the overall frame does not go back with a flashback, unlike the session time
+         memcpy(&hdr, rec.pData, sizeof(hdr));
+         const uint64_t position = m_reader->Position();
+         const std::vector<ReplaySession>& sessions = m_engine->Sessions();
+         for (size_t i = 0; i < sessions.size(); ++i)
+         {
+            if ((position < sessions[i].firstRecord) || (position >= sessions[i].endRecord))
+               continue;
+
+            std::unique_ptr<F12025_PacketExtractor> extractor = std::make_unique<F12025_PacketExtractor>();
+            std::unique_ptr<F1TimingModel> timing = std::make_unique<F1TimingModel>();
+            restored = m_engine->SeekFrame(i, hdr.m_overallFrameIdentifier, *extractor, *timing);
+            if (restored)
+               mapper->RestoreTiming(*timing);
+            break;
+         }
+      }
+
+      if (playing)
+         StartPlayback(mapper, emitPort);
+      return restored;
+   }
+
+   bool F1CaptureFile::StartPlayback(F1UdpClrMapper^ mapper, int emitPort)
+   {
+      StopPlayback();
+      if (!IsOpen || !mapper)
+         return false;
+
+      if (emitPort)
+      {
+         m_sender = new F1UdpSender();
+         if (!m_sender->Open(static_cast<uint16_t>(emitPort)))
+         {
+            delete m_sender;
+            m_sender = nullptr;
+            return false;
+         }
+      }
+
+      m_mapper = mapper;
+      m_emitPort = emitPort;
+      m_playPosition = m_pcap ? m_pcap->Position() : m_reader->Position();
+      m_pacer->Restart();
+      m_playThread = gcnew System::Threading::Thread(gcnew System::Threading::ThreadStart(this, &F1CaptureFile::m_PlaybackThread));
+      m_playThread->IsBackground = true;
+      m_playThread->Priority = System::Threading::ThreadPriority::AboveNormal;
+      m_playThread->Start();
+      return true;
+   }
+
+   void F1CaptureFile::StopPlayback()
+   {
+      if (m_playThread)
+      {
+         m_pacer->Stop();
+         m_playThread->Join();
+         m_playThread = nullptr;
+      }
+
+      delete m_sender;
+      m_sender = nullptr;
+      m_mapper = nullptr;
+   }
+
+   bool F1CaptureFile::m_Next(DatagramDesc& datagram)
+   {
+      if (m_pcap)
+         return m_pcap->Peek(datagram);
+
+      CaptureRecord rec;
+      if (!m_reader->Peek(rec))
+         return false;
+
+      datagram.pData = rec.pData;
+      datagram.len = rec.len;
+      datagram.rxTimestampNs = rec.rxTimestampNs;
+      return true;
+   }
+
+   void F1CaptureFile::m_PlaybackThread()
+   {
+      DatagramDesc datagram;
+      while (m_Next(datagram) && m_pacer->Wait(datagram))
+      {
+         // the queue is drained by the UI thread, wait for it when it is full
+         while (!m_mapper->EnqueueDatagram(datagram.pData, datagram.len, datagram.rxTimestampNs))
+         {
+            if (m_pacer->Stopped())
+               return;
+            System::Threading::Thread::Sleep(1);
+         }
+
+         if (m_sender)
+            m_sender->Send(datagram.pData, datagram.len);
+
+         if (m_pcap)
+            m_pcap->Next(datagram);
+         else
+         {
+            CaptureRecord rec;
+            m_reader->Next(rec);
+         }
+         m_playPosition = m_pcap ? m_pcap->Position() : m_reader->Position();
+      }
+   }
+}
@@ -0,0 +1,85 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include "F1Capture.h"
+#include "F1Pcap.h"
+#include "F1ReplayEngine.h"
+#include "F1ReplayPacer.h"
+#include "F1UdpReceiver.h"
+#include "F1UdpClrMapper.h"
+
+namespace adjsw::F12025
+{
+   // Capture file (F1UdpClrMapper::StartCapture()) or pcap / pcapng file (UDP port 20777) for playback.
+   // The packets stay native, they are queued to the mapper without a managed copy.
+   public ref class F1CaptureFile
+   {
+   public:
+      F1CaptureFile(String^ filename);
+      ~F1CaptureFile();
+      !F1CaptureFile();
+
+      // true for capture, pcap and pcapng files
+      static bool IsCaptureFile(String^ filename);
+
+      // writes the datagrams of a capture file to a pcap file, e.g. for Wireshark
+      static bool ExportPcap(String^ capture, String^ pcap);
+
+      property bool IsOpen { bool get() { return m_pcap ? m_pcap->IsOpen() : (m_reader && m_reader->IsOpen()); } };
+      property bool IsPcap { bool get() { return m_pcap != nullptr; } };
+      property UInt64 Count { UInt64 get(); };
+      property UInt64 Position { UInt64 get(); };
+      property UInt64 DurationMs { UInt64 get(); };
+
+      // receive time of the next record in ms since the first one, UInt64::MaxValue at the end
+      property UInt64 NextTimestampMs { UInt64 get(); };
+
+      void Rewind();
+
+      // queue all records received before timestampMs (since the first one), returns the number of records
+      int EnqueueUntil(UInt64 timestampMs, F1UdpClrMapper^ mapper);
+
+      // capture files only: position to the first record received at or after timestampMs (since the first one) and
+      // continue the mapper with the timing state at it, restored from the checkpoints of the capture (F1ReplayEngine)
+      bool Seek(UInt64 timestampMs, F1UdpClrMapper^ mapper);
+
+      // Paced playback (F1ReplayPacer.h) on a native thread: each record is queued to the mapper at the time of its
+      // timestamp, scaled by Speed. emitPort != 0: the records are also sent to 127.0.0.1:emitPort.
+      // EnqueueUntil() and NextTimestampMs must not be used meanwhile.
+      bool StartPlayback(F1UdpClrMapper^ mapper, int emitPort);
+      void StopPlayback();
+      property bool Playing { bool get() { return m_playThread != nullptr; } };
+
+      // 0.1 .. 50
+      property double Speed { double get() { return m_pacer->Speed(); } void set(double value) { m_pacer->SetSpeed(value); } };
+      property bool Paused { bool get() { return m_pacer->Paused(); } void set(bool value) { m_pacer->Pause(value); } };
+
+      // while paused: play the records of the next frame
+      void StepFrame() { m_pacer->StepFrame(); }
+
+      // capture time of the last played record since the first one
+      property UInt64 PlayedMs { UInt64 get() { return m_pacer->PositionNs() / 1000000; } };
+
+      // played - target time of the paced records
+      property double TimingMeanErrorUs { double get() { return m_pacer->Stats().MeanErrorUs(); } };
+      property double TimingP99ErrorUs { double get() { return m_pacer->Stats().AbsErrorPercentileNs(0.99) / 1000.0; } };
+      property double TimingMaxErrorUs { double get() { return m_pacer->Stats().errorMaxNs / 1000.0; } };
+      property UInt64 TimingLate { UInt64 get() { return m_pacer->Stats().late; } };
+
+   private:
+      uint64_t m_FirstTimestampNs();
+      bool m_Next(DatagramDesc& datagram);
+      void m_PlaybackThread();
+
+      F1CaptureReader* m_reader;
+      F1PcapReader* m_pcap; // instead of m_reader for pcap files
+      F1ReplayEngine* m_engine; // the same capture file as m_reader, for the state of Seek()
+      F1ReplayPacer* m_pacer;
+      F1UdpSender* m_sender;
+      F1UdpClrMapper^ m_mapper;
+      int m_emitPort;
+      System::Threading::Thread^ m_playThread;
+      volatile UInt64 m_playPosition; // Position while playing
+   };
+}
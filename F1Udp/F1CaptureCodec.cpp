@@ -0,0 +1,200 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1CaptureCodec.h"
+#include "F1DataDefs.h"
+
+#include <string.h>
+#include <algorithm>
+
+namespace
+{
+   // key: m_packetId, 255 for payloads without header, cs_historyKey + m_carIdx for the session history
+   constexpr unsigned cs_historyKey = 256;
+   constexpr unsigned cs_historyCars = 32;
+   constexpr unsigned cs_keyCount = cs_historyKey + cs_historyCars;
+
+   constexpr unsigned cs_maxRun = 128;
+   constexpr uint8_t cs_zeroToken = 0x80;
+}
+
+CaptureDeltaCodec::CaptureDeltaCodec()
+   : m_refs(cs_keyCount)
+{
+}
+
+void CaptureDeltaCodec::Reset()
+{
+   // O(1), the buffers are kept
+   if (!++m_generation)
+   {
+      for (Reference& ref : m_refs)
+         ref.generation = 0;
+      m_generation = 1;
+   }
+}
+
+unsigned CaptureDeltaCodec::s_Key(const uint8_t* pData, unsigned len)
+{
+   if (len < sizeof(PacketHeader))
+      return 255;
+
+   PacketHeader hdr;
+   memcpy(&hdr, pData, sizeof(hdr));
+   const uint8_t packetId = hdr.m_packetId;
+   if ((packetId == static_cast<uint8_t>(PacketType::PacketSessionHistoryData)) && (len > sizeof(PacketHeader)) &&
+      (pData[sizeof(PacketHeader)] < cs_historyCars))
+      return cs_historyKey + pData[sizeof(PacketHeader)];
+   return packetId;
+}
+
+uint8_t* CaptureDeltaCodec::m_Reference(unsigned key, unsigned len)
+{
+   Reference& ref = m_refs[key];
+   if (ref.generation != m_generation)
+   {
+      ref.data.clear();
+      ref.generation = m_generation;
+   }
+   ref.data.resize(len);
+   return ref.data.data();
+}
+
+bool CaptureDeltaCodec::Encode(const uint8_t* pData, unsigned len, std::vector<uint8_t>& out)
+{
+   const unsigned key = s_Key(pData, len);
+   const Reference& ref = m_refs[key];
+   const unsigned refLen = (ref.generation == m_generation) ? static_cast<unsigned>(ref.data.size()) : 0;
+   const uint8_t* pRef = ref.data.data();
+
+   const size_t begin = out.size();
+   bool smaller = (len <= 0xffff);
+   if (smaller)
+   {
+      const CaptureDeltaHeader hdr{ static_cast<uint16_t>(key), static_cast<uint16_t>(len) };
+      out.resize(begin + sizeof(hdr));
+      memcpy(out.data() + begin, &hdr, sizeof(hdr));
+
+      auto delta = [&](unsigned i) { return static_cast<uint8_t>(pData[i] ^ ((i < refLen) ? pRef[i] : 0)); };
+
+      unsigned i = 0;
+      while (i < len)
+      {
+         unsigned run = 0;
+         while ((i + run < len) && (run < cs_maxRun) && !delta(i + run))
+            ++run;
+
+         // a single zero is cheaper as literal, unless it ends the payload
+         if ((run >= 2) || (run && (i + run == len)))
+         {
+            out.push_back(static_cast<uint8_t>(cs_zeroToken + run - 1));
+            i += run;
+            continue;
+         }
+
+         // literals up to the next zero pair
+         unsigned lit = 0;
+         while ((i + lit < len) && (lit < cs_maxRun) && (delta(i + lit) || ((i + lit + 1 < len) && delta(i + lit + 1))))
+            ++lit;
+         if (!lit)
+            lit = 1;
+
+         out.push_back(static_cast<uint8_t>(lit - 1));
+         for (unsigned j = 0; j < lit; ++j)
+            out.push_back(delta(i + j));
+         i += lit;
+      }
+
+      smaller = (out.size() - begin < len);
+      if (!smaller)
+         out.resize(begin);
+   }
+
+   memcpy(m_Reference(key, len), pData, len);
+   return smaller;
+}
+
+void CaptureDeltaCodec::Update(const uint8_t* pData, unsigned len)
+{
+   memcpy(m_Reference(s_Key(pData, len), len), pData, len);
+}
+
+const uint8_t* CaptureDeltaCodec::Decode(const uint8_t* pData, unsigned len, unsigned& payloadLen)
+{
+   CaptureDeltaHeader hdr;
+   if (len < sizeof(hdr))
+      return nullptr;
+   memcpy(&hdr, pData, sizeof(hdr));
+   if (hdr.key >= cs_keyCount)
+      return nullptr;
+
+   // in place: the reference becomes the payload, bytes beyond the old reference are zero
+   uint8_t* pOut = m_Reference(hdr.key, hdr.len);
+   unsigned pos = sizeof(hdr);
+   unsigned i = 0;
+   while (i < hdr.len)
+   {
+      if (pos >= len)
+         return nullptr;
+
+      const uint8_t token = pData[pos++];
+      if (token >= cs_zeroToken)
+      {
+         i += token - cs_zeroToken + 1;
+         continue;
+      }
+
+      const unsigned lit = token + 1u;
+      if ((len - pos < lit) || (hdr.len - i < lit))
+         return nullptr;
+      for (unsigned j = 0; j < lit; ++j)
+         pOut[i + j] ^= pData[pos + j];
+      pos += lit;
+      i += lit;
+   }
+
+   if ((i != hdr.len) || (pos != len))
+      return nullptr;
+
+   payloadLen = hdr.len;
+   return pOut;
+}
+
+bool CaptureDeltaCodec::DecodeHeader(const uint8_t* pData, unsigned len, PacketHeader& hdr) const
+{
+   CaptureDeltaHeader delta;
+   if (len < sizeof(delta))
+      return false;
+   memcpy(&delta, pData, sizeof(delta));
+   if ((delta.key >= cs_keyCount) || (delta.len < sizeof(PacketHeader)))
+      return false;
+
+   uint8_t out[sizeof(PacketHeader)] = {};
+   const Reference& ref = m_refs[delta.key];
+   if (ref.generation == m_generation)
+      memcpy(out, ref.data.data(), (std::min)(ref.data.size(), sizeof(out)));
+
+   unsigned pos = sizeof(delta);
+   unsigned i = 0;
+   while ((i < sizeof(out)) && (pos < len))
+   {
+      const uint8_t token = pData[pos++];
+      if (token >= cs_zeroToken)
+      {
+         i += token - cs_zeroToken + 1;
+         continue;
+      }
+
+      const unsigned lit = (std::min)(token + 1u, len - pos);
+      for (unsigned j = 0; (j < lit) && (i + j < sizeof(out)); ++j)
+         out[i + j] ^= pData[pos + j];
+      pos += lit;
+      i += lit;
+   }
+
+   if (i < sizeof(out))
+      return false;
+
+   memcpy(&hdr, out, sizeof(hdr));
+   return true;
+}
@@ -0,0 +1,64 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+struct PacketHeader;
+
+// Delta coding of capture payloads. A payload is XORed with the previous payload of the same packet id (and car for
+// the session history), consecutive packets differ in a few fields only, so the result is mostly zero.
+// The zero runs are then collapsed:
+//   token < 0x80:  token + 1 literal bytes follow
+//   token >= 0x80: token - 0x7f zero bytes
+// Encoder and decoder must see the same records in the same order, both are reset at the same records
+// (cs_captureRecordReset in F1Capture.h).
+
+#pragma pack(push, 1)
+
+struct CaptureDeltaHeader
+{
+   uint16_t key; // reference slot
+   uint16_t len; // decoded payload bytes
+};
+
+#pragma pack(pop)
+
+class CaptureDeltaCodec
+{
+public:
+   CaptureDeltaCodec();
+
+   // forget all references
+   void Reset();
+
+   // Appends the delta to out and takes the payload as reference.
+   // False if the delta would not be smaller than the payload, the payload is to be stored as is then (still taken as reference).
+   bool Encode(const uint8_t* pData, unsigned len, std::vector<uint8_t>& out);
+
+   // takes a payload stored as is as reference
+   void Update(const uint8_t* pData, unsigned len);
+
+   // decodes a delta and takes the result as reference. The payload is valid until the next Reset() or a
+   // call for the same reference slot, nullptr if the delta is corrupt.
+   const uint8_t* Decode(const uint8_t* pData, unsigned len, unsigned& payloadLen);
+
+   // decodes the PacketHeader only and keeps the reference, false if the payload has no complete header
+   bool DecodeHeader(const uint8_t* pData, unsigned len, PacketHeader& hdr) const;
+
+private:
+   static unsigned s_Key(const uint8_t* pData, unsigned len);
+
+   struct Reference
+   {
+      std::vector<uint8_t> data;
+      uint32_t generation{ 0 }; // valid if == m_generation
+   };
+
+   // data of a valid reference, resized to len (new bytes are zero)
+   uint8_t* m_Reference(unsigned key, unsigned len);
+
+   std::vector<Reference> m_refs;
+   uint32_t m_generation{ 1 };
+};
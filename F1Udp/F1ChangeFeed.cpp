@@ -0,0 +1,129 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1ChangeFeed.h"
+
+#include <string.h>
+
+namespace
+{
+   size_t s_RoundUpPow2(size_t val)
+   {
+      size_t res = 1;
+      while (res < val)
+         res <<= 1;
+      return res;
+   }
+}
+
+F1ChangeFeed::F1ChangeFeed(size_t capacity) :
+   m_capacity(s_RoundUpPow2(capacity < 64 ? 64 : capacity)),
+   m_mask(m_capacity - 1),
+   m_words(new std::atomic<uint64_t>[m_capacity * cs_words])
+{
+   for (size_t i = 0; i < m_capacity * cs_words; ++i)
+      m_words[i].store(0, std::memory_order_relaxed);
+}
+
+void F1ChangeFeed::Push(const F1Change& change)
+{
+   const uint64_t head = m_head.load(std::memory_order_relaxed);
+
+   // a reader which sees any of the words written below also sees that the record before in the slot is gone
+   if (head >= m_capacity)
+   {
+      m_tail.store(head - m_capacity + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+   }
+
+   uint64_t words[cs_words];
+   memcpy(words, &change, sizeof(words));
+   std::atomic<uint64_t>* pWords = m_words.get() + (head & m_mask) * cs_words;
+   for (unsigned i = 0; i < cs_words; ++i)
+      pWords[i].store(words[i], std::memory_order_relaxed);
+
+   m_head.store(head + 1, std::memory_order_release);
+}
+
+void F1ChangeFeed::PushCar(float sessionTime, uint8_t car, F1ChangeCar& published, const F1ChangeCar& current, double lastLapTime)
+{
+   const auto push = [&](ChangeField field, auto& value, auto newValue, unsigned lap)
+   {
+      if (value == newValue)
+         return;
+
+      value = newValue;
+      Push(F1Change{ sessionTime, car, field, static_cast<uint16_t>(lap), static_cast<double>(newValue) });
+   };
+
+   push(ChangeField::Present, published.present, current.present, 0);
+   push(ChangeField::Position, published.pos, current.pos, 0);
+   push(ChangeField::LapNr, published.lapNr, current.lapNr, 0);
+   push(ChangeField::Status, published.status, current.status, 0);
+   push(ChangeField::Tyre, published.tyre, current.tyre, 0);
+   push(ChangeField::VisualTyre, published.visualTyre, current.visualTyre, 0);
+   push(ChangeField::TyreAge, published.tyreAge, current.tyreAge, 0);
+   push(ChangeField::Penalties, published.penaltySeconds, current.penaltySeconds, 0);
+   push(ChangeField::DeltaToPlayer, published.timedeltaToPlayer, current.timedeltaToPlayer, 0);
+   push(ChangeField::DeltaToLeader, published.timedeltaToLeader, current.timedeltaToLeader, 0);
+   push(ChangeField::DeltaToCarAhead, published.timedeltaToCarAhead, current.timedeltaToCarAhead, 0);
+
+   // the lap time of a lap is set when the next one starts
+   if (current.currentLap != published.currentLap)
+   {
+      push(ChangeField::LapTime, published.lap, lastLapTime, published.currentLap);
+      published.currentLap = current.currentLap;
+      published.sector1 = 0;
+      published.sector2 = 0;
+      published.lap = 0;
+   }
+
+   push(ChangeField::Sector1, published.sector1, current.sector1, current.currentLap);
+   push(ChangeField::Sector2, published.sector2, current.sector2, current.currentLap);
+   push(ChangeField::LapTime, published.lap, current.lap, current.currentLap);
+   push(ChangeField::FastestLap, published.fastestLap, current.fastestLap, 0);
+}
+
+unsigned F1ChangeFeed::Read(uint64_t& pos, F1Change* pChanges, unsigned maxCount, uint64_t* pLost) const
+{
+   const uint64_t head = m_head.load(std::memory_order_acquire);
+   uint64_t lost = 0;
+   if (pos > head)
+      pos = head; // a position of another feed
+
+   uint64_t tail = m_tail.load(std::memory_order_relaxed);
+   if (pos < tail)
+   {
+      lost += tail - pos;
+      pos = tail;
+   }
+
+   const uint64_t end = (head - pos < maxCount) ? head : pos + maxCount;
+   for (uint64_t k = pos; k < end; ++k)
+   {
+      uint64_t words[cs_words];
+      const std::atomic<uint64_t>* pWords = m_words.get() + (k & m_mask) * cs_words;
+      for (unsigned i = 0; i < cs_words; ++i)
+         words[i] = pWords[i].load(std::memory_order_relaxed);
+      memcpy(&pChanges[k - pos], words, sizeof(words));
+   }
+
+   // overwritten while copying: drop them
+   std::atomic_thread_fence(std::memory_order_acquire);
+   tail = m_tail.load(std::memory_order_relaxed);
+   unsigned count = static_cast<unsigned>(end - pos);
+   if (tail > pos)
+   {
+      const unsigned gone = static_cast<unsigned>(((tail < end) ? tail : end) - pos);
+      memmove(pChanges, pChanges + gone, (count - gone) * sizeof(F1Change));
+      count -= gone;
+      lost += tail - pos;
+      pos = tail;
+   }
+
+   if (pos < end)
+      pos = end;
+   if (pLost)
+      *pLost += lost;
+   return count;
+}
@@ -0,0 +1,112 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+// the field of a change record, the unit of its value
+enum class ChangeField : uint8_t
+{
+   SessionReset,    // a new session starts, the state of all cars is back to 0 (car cs_changeSession)
+   Present,         // 1: the car took part in the session
+   Position,
+   LapNr,
+   Status,          // TimingDriverStatus
+   Tyre,            // actual compound
+   VisualTyre,
+   TyreAge,         // laps
+   Penalties,       // seconds
+   DeltaToPlayer,   // seconds
+   DeltaToLeader,   // seconds, negative: laps behind
+   DeltaToCarAhead, // seconds, negative: laps behind
+   Sector1,         // seconds, of the lap index in F1Change::lap, 0: removed
+   Sector2,
+   LapTime,
+   FastestLap,      // seconds
+   Count
+};
+
+inline constexpr uint8_t cs_changeSession = 0xFF; // car of the records which are not about a car
+
+// One change: the new value of a field of a car
+struct F1Change
+{
+   float sessionTime;
+   uint8_t car;       // index of the car, cs_changeSession
+   ChangeField field;
+   uint16_t lap;      // lap index of the lap and sector times, 0 otherwise
+   double value;
+};
+static_assert(sizeof(F1Change) == 16, "two words per record");
+
+// the values of a car in the records pushed so far, see F1ChangeFeed::PushCar()
+struct F1ChangeCar
+{
+   uint8_t present{ 0 };
+   int pos{ 0 };
+   int lapNr{ 1 };
+   uint8_t status{ 0 };
+   uint8_t tyre{ 0 };
+   uint8_t visualTyre{ 0 };
+   int tyreAge{ 0 };
+   int penaltySeconds{ 0 };
+   float timedeltaToPlayer{ 0 };
+   float timedeltaToLeader{ 0 };
+   float timedeltaToCarAhead{ 0 };
+   unsigned currentLap{ 0 }; // lap index of sector1, sector2 and lap
+   double sector1{ 0 };
+   double sector2{ 0 };
+   double lap{ 0 };
+   double fastestLap{ 0 };
+};
+
+// Broadcast ring of change records: one writer, any number of readers which each keep their own position and never
+// block the writer or each other. A reader which falls behind by more than the capacity loses the oldest records,
+// they are counted. Like SeqLock the records are stored as atomic words, a record overwritten while it is read is
+// detected and never a data race. Nothing is allocated after construction.
+class F1ChangeFeed
+{
+public:
+   static constexpr size_t cs_defaultCapacity = 64 * 1024; // records
+
+   // capacity is rounded up to a power of 2
+   explicit F1ChangeFeed(size_t capacity = cs_defaultCapacity);
+   F1ChangeFeed(const F1ChangeFeed&) = delete;
+   F1ChangeFeed& operator=(const F1ChangeFeed&) = delete;
+
+   // --- writer ---
+
+   void Push(const F1Change& change);
+
+   // a record for each field of current which differs from published, published is updated. A car in a new lap gets
+   // the final time of the lap before first: lastLapTime, the lap time of the lap index published.currentLap.
+   void PushCar(float sessionTime, uint8_t car, F1ChangeCar& published, const F1ChangeCar& current, double lastLapTime);
+
+   // --- any thread ---
+
+   // up to maxCount records from position pos on, pos is advanced behind them. A new reader starts at Head() to
+   // get the following records only, at 0 for all which are still in the ring. Records which were overwritten before
+   // they were read are skipped and added to *pLost.
+   unsigned Read(uint64_t& pos, F1Change* pChanges, unsigned maxCount, uint64_t* pLost = nullptr) const;
+
+   // number of records pushed so far, the position behind the newest one
+   uint64_t Head() const { return m_head.load(std::memory_order_acquire); }
+
+   size_t Capacity() const { return m_capacity; }
+
+   // memory allocated by the feed, fixed after construction
+   size_t MemoryBytes() const { return sizeof(*this) + m_capacity * sizeof(F1Change); }
+
+private:
+   static constexpr unsigned cs_words = sizeof(F1Change) / sizeof(uint64_t);
+
+   const size_t m_capacity;
+   const uint64_t m_mask;
+   std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+
+   // written by the writer only
+   alignas(64) std::atomic<uint64_t> m_head{ 0 };
+   std::atomic<uint64_t> m_tail{ 0 }; // oldest record which is not overwritten (or being overwritten)
+};
@@ -0,0 +1,99 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1Checkpoint.h"
+#include "F1Journal.h"
+
+#include <string.h>
+
+size_t BeginCheckpointSection(std::vector<uint8_t>& out, uint32_t tag)
+{
+   const size_t section = out.size();
+   const CheckpointSection hdr{ tag, 0 };
+   out.resize(section + sizeof(hdr));
+   memcpy(out.data() + section, &hdr, sizeof(hdr));
+   return section;
+}
+
+void EndCheckpointSection(std::vector<uint8_t>& out, size_t section)
+{
+   CheckpointSection hdr;
+   memcpy(&hdr, out.data() + section, sizeof(hdr));
+   hdr.len = static_cast<uint32_t>(out.size() - section - sizeof(hdr));
+   memcpy(out.data() + section, &hdr, sizeof(hdr));
+}
+
+const uint8_t* FindCheckpointSection(const uint8_t* pData, size_t len, uint32_t tag, size_t& sectionLen)
+{
+   size_t pos = 0;
+   while (pData && (len - pos >= sizeof(CheckpointSection)))
+   {
+      CheckpointSection hdr;
+      memcpy(&hdr, pData + pos, sizeof(hdr));
+      pos += sizeof(hdr);
+      if (len - pos < hdr.len)
+         break;
+
+      if (hdr.tag == tag)
+      {
+         sectionLen = hdr.len;
+         return pData + pos;
+      }
+      pos += hdr.len;
+   }
+
+   sectionLen = 0;
+   return nullptr;
+}
+
+void SaveCheckpoint(const F12025_PacketExtractor& extractor, std::vector<uint8_t>& out)
+{
+   const size_t section = BeginCheckpointSection(out, cs_checkpointExtractorTag);
+   extractor.SaveState(out);
+   EndCheckpointSection(out, section);
+}
+
+bool RestoreCheckpoint(F12025_PacketExtractor& extractor, const uint8_t* pData, size_t len)
+{
+   size_t stateLen = 0;
+   const uint8_t* pState = FindCheckpointSection(pData, len, cs_checkpointExtractorTag, stateLen);
+   if (!pState)
+   {
+      extractor.Reset();
+      return false;
+   }
+   return extractor.RestoreState(pState, stateLen);
+}
+
+void SaveCheckpoint(const F1TimingModel& model, std::vector<uint8_t>& out)
+{
+   std::vector<JournalRecord> records;
+   SnapshotTimingModel(model, records);
+
+   const size_t section = BeginCheckpointSection(out, cs_checkpointTimingTag);
+   out.insert(out.end(), reinterpret_cast<const uint8_t*>(records.data()), reinterpret_cast<const uint8_t*>(records.data() + records.size()));
+   EndCheckpointSection(out, section);
+}
+
+bool RestoreCheckpoint(F1TimingModel& model, const uint8_t* pData, size_t len)
+{
+   size_t stateLen = 0;
+   const uint8_t* pState = FindCheckpointSection(pData, len, cs_checkpointTimingTag, stateLen);
+   std::vector<JournalRecord> records(pState ? stateLen / sizeof(JournalRecord) : 0);
+   bool valid = pState && !(stateLen % sizeof(JournalRecord));
+
+   for (size_t i = 0; valid && (i < records.size()); ++i)
+   {
+      memcpy(&records[i], pState + i * sizeof(JournalRecord), sizeof(JournalRecord));
+      valid = (records[i].crc == JournalCrc(records[i]));
+   }
+
+   if (!valid)
+   {
+      model.Clear();
+      model.ContinueSession(0, 0);
+      return false;
+   }
+   RestoreTimingModel(records, model);
+   return true;
+}
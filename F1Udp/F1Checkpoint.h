@@ -0,0 +1,52 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "F1PacketExtractor.h"
+#include "F1TimingModel.h"
+
+// State checkpoint as stored in captures (F1Capture.h): a list of sections {CheckpointSection, len bytes}.
+// The extractor section is always present. Other sections (e.g. a derived timing model) are optional,
+// readers skip the tags they do not know.
+
+#pragma pack(push, 1)
+
+struct CheckpointSection
+{
+   uint32_t tag;
+   uint32_t len; // bytes following this header
+};
+
+#pragma pack(pop)
+
+inline constexpr uint32_t CheckpointTag(char a, char b, char c, char d)
+{
+   return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+      (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+}
+
+inline constexpr uint32_t cs_checkpointExtractorTag = CheckpointTag('E', 'X', 'T', 'R');
+inline constexpr uint32_t cs_checkpointTimingTag = CheckpointTag('T', 'I', 'M', 'G'); // JournalRecords (F1Journal.h)
+
+// starts a section, the caller appends the data, EndCheckpointSection() sets the length. Returns the section position.
+size_t BeginCheckpointSection(std::vector<uint8_t>& out, uint32_t tag);
+void EndCheckpointSection(std::vector<uint8_t>& out, size_t section);
+
+// nullptr if the checkpoint has no (complete) section with the tag
+const uint8_t* FindCheckpointSection(const uint8_t* pData, size_t len, uint32_t tag, size_t& sectionLen);
+
+// appends the extractor section, further sections may follow
+void SaveCheckpoint(const F12025_PacketExtractor& extractor, std::vector<uint8_t>& out);
+
+// restores the extractor section, the extractor is reset if the checkpoint has none
+bool RestoreCheckpoint(F12025_PacketExtractor& extractor, const uint8_t* pData, size_t len);
+
+// appends the timing section: the state of the model as journal records (SnapshotTimingModel())
+void SaveCheckpoint(const F1TimingModel& model, std::vector<uint8_t>& out);
+
+// restores the timing section as a journal (RestoreTimingModel()), the model continues its session with the next
+// packet. Without a valid section the model is cleared and the next packet starts the session.
+bool RestoreCheckpoint(F1TimingModel& model, const uint8_t* pData, size_t len);
@@ -6,6 +6,7 @@ using namespace System;
 using namespace System::Collections::Generic;
 #include <string.h>
 #include <list>
+#include "F1LapStore.h"
 
 namespace adjsw::F12025
 {
@@ -151,6 +152,37 @@ namespace adjsw::F12025
       DSQ
    };
 
+   // field of a DriverChange, as ChangeField (F1ChangeFeed.h)
+   public enum class DriverChangeField
+   {
+      SessionReset,
+      Present,
+      Position,
+      LapNr,
+      Status,
+      Tyre,
+      VisualTyre,
+      TyreAge,
+      Penalties,
+      DeltaToPlayer,
+      DeltaToLeader,
+      DeltaToCarAhead,
+      Sector1,
+      Sector2,
+      LapTime,
+      FastestLap
+   };
+
+   // one change record of F1UdpClrMapper::ReadChanges(): the new value of a field of a driver
+   public value struct DriverChange
+   {
+      float SessionTime;
+      int Car;   // index into Drivers, 255: not about a car (SessionReset)
+      DriverChangeField Field;
+      int Lap;   // lap index of the lap and sector times, 0 otherwise
+      double Value;
+   };
+
 
    public enum class EventType
    {
@@ -323,23 +355,30 @@ namespace adjsw::F12025
       List<SessionEvent^>^ m_events;
    };
 
+   // a lap of a car in the F1LapStore of the mapper (one view per lap, created when the lap is used)
    public ref class LapData
    {
+   internal:
+      LapData(F1LapStore* store, int car, int slot) : m_store(store), m_car(car), m_slot(slot) {}
+
+      property int Slot {int get() { return m_slot; } }; // lap index or cs_lapStoreFastest
+      void ResetIncidents() { m_incidents = nullptr; }
+
    public:
       property System::UInt32 Sector1Ms {System::UInt32 get() { return m_DoubleSecToIntMsec(Sector1); } }
       property System::UInt32 Sector2Ms {System::UInt32 get() { return m_DoubleSecToIntMsec(Sector2); } }
       property System::UInt32 Sector3Ms {System::UInt32 get() { return m_DoubleSecToIntMsec(Sector3); } }
       property System::UInt32 LapMs {System::UInt32 get() { return m_DoubleSecToIntMsec(Lap); } }
 
-      property double Sector1;
-      property double Sector2;
+      property double Sector1 {double get() { return m_store->Sector1(m_car, m_slot); } void set(double val) { m_store->Sector1(m_car, m_slot) = val; } };
+      property double Sector2 {double get() { return m_store->Sector2(m_car, m_slot); } void set(double val) { m_store->Sector2(m_car, m_slot) = val; } };
       property double Sector3 {double get() { return (Lap != 0.0) ? Lap - (Sector1 + Sector2) : 0.0; } };
 
-      property double Lap;
-      property double LapsAccumulated;
-      property List<SessionEvent^>^ Incidents;
+      property double Lap {double get() { return m_store->Lap(m_car, m_slot); } void set(double val) { m_store->Lap(m_car, m_slot) = val; } };
+      property double LapsAccumulated {double get() { return m_store->LapsAccumulated(m_car, m_slot); } void set(double val) { m_store->LapsAccumulated(m_car, m_slot) = val; } };
+      property List<SessionEvent^>^ Incidents {List<SessionEvent^>^ get() { if (m_incidents == nullptr) m_incidents = gcnew List<SessionEvent^>(); return m_incidents; } void set(List<SessionEvent^>^ val) { m_incidents = val; } };
 
-      property bool Invalid;
+      property bool Invalid {bool get() { return m_store->Invalid(m_car, m_slot); } void set(bool val) { m_store->SetInvalid(m_car, m_slot, val); } };
 
       void CopyFrom(LapData^ lap)
       {
@@ -384,6 +423,60 @@ namespace adjsw::F12025
    private:
       // get double seconds to int milliseconds with correct rounding
       System::UInt32 m_DoubleSecToIntMsec(double d) { d *= 1000.0; d += 0.5; return (System::UInt32)d; }
+
+      F1LapStore* m_store;
+      int m_car;
+      int m_slot;
+      List<SessionEvent^>^ m_incidents;
+   };
+
+   // the laps of a car, indexed like an array of cs_timingMaxLaps laps (100 Laps ought to be enough for anybody)
+   public ref class LapList
+   {
+   internal:
+      LapList(F1LapStore* store, int car) : m_store(store), m_car(car)
+      {
+         m_views = gcnew array<LapData^>(cs_lapStoreSlots);
+      }
+
+      // the fastest lap record of the car
+      property LapData^ Fastest {LapData^ get() { return m_View(cs_lapStoreFastest); } };
+
+      // clears the times of the car, the views are kept
+      void Reset()
+      {
+         m_store->ClearCar(m_car);
+         for each (LapData^ lap in m_views)
+         {
+            if (lap != nullptr)
+               lap->ResetIncidents();
+         }
+      }
+
+   public:
+      property LapData^ default[int]
+      {
+         LapData^ get(int lap)
+         {
+            if ((lap < 0) || (lap >= Length))
+               throw gcnew IndexOutOfRangeException();
+            return m_View(lap);
+         }
+      };
+
+      property int Length {int get() { return cs_timingMaxLaps; } };
+
+   private:
+      LapData^ m_View(int slot)
+      {
+         if (m_views[slot] == nullptr)
+            m_views[slot] = gcnew LapData(m_store, m_car, slot);
+         return m_views[slot];
+      }
+
+      F1LapStore* m_store;
+      int m_car;
+      array<LapData^>^ m_views;
    };
 
    public ref class CarDetail
@@ -442,14 +535,17 @@ namespace adjsw::F12025
 
    public ref class DriverData : public System::ComponentModel::INotifyPropertyChanged
    {
-   public:
-      DriverData(SessionInfo^ inf)
+   internal:
+      DriverData(SessionInfo^ inf, F1LapStore* laps, int car)
       {
          m_driverNameNative = new char[48];
+         m_laps = gcnew LapList(laps, car);
          Reset();
          m_carDetail = gcnew CarDetail;
          m_sessionInfo = inf;
       }
+
+   public:
       ~DriverData() { delete m_driverNameNative; }
 
       void Reset()
@@ -462,13 +558,8 @@ namespace adjsw::F12025
          Pos = 0;
          LapNr = 1;
          Status = DriverStatus::Garage;
-         Laps = gcnew array<LapData^>(100); // 100 Laps ought to be enough for anybody
-         for (int i = 0; i < Laps->Length; ++i)
-         {
-            Laps[i] = gcnew LapData();
-            Laps[i]->Incidents = gcnew List<SessionEvent^>();
-         }
-         FastestLap = gcnew LapData();      
+         m_laps->Reset();
+         FastestLap = m_laps->Fastest;
          CurrentLap = Laps[0];
          IsPlayer = false;
          Present = false;
@@ -478,6 +569,7 @@ namespace adjsw::F12025
 
          TimedeltaToLeader = 0;
          TimedeltaToPlayer = 0;
+         TimedeltaToCarAhead = 0;
          Id = 0;
          AllowLapHistoryQuali = true;
       }
@@ -513,13 +605,14 @@ namespace adjsw::F12025
       property float TyreDamage {float get() { return m_tyreDamage; } void set(float val) { if (val != m_tyreDamage) { m_tyreDamage = val; NPC("TyreDamage"); } } };
       property int Pos {int get() { return m_pos; } void set(int val) { if (val != m_pos) { m_pos = val; NPC("Pos"); } } };
       property int LapNr {int get() { return m_lapNr; } void set(int val) { if (val != m_lapNr) { m_lapNr = val; NPC("LapNr"); } } };
-      property array<LapData^>^ Laps {array<LapData^>^ get() { return m_laps; } void set(array<LapData^>^ val) { m_laps = val; /*NPC("Laps");*/ }};
+      property LapList^ Laps {LapList^ get() { return m_laps; } };
       property LapData^ FastestLap {LapData^ get() { return m_fastestLap; } void set(LapData^ val) { m_fastestLap = val; NPC("FastestLap"); }};
       property LapData^ CurrentLap {LapData^ get() { return m_currentLap; } void set(LapData^ val) { m_currentLap = val; NPC("CurrentLap"); }};
       property int PenaltySeconds {int get() { return m_penaltySeconds; } void set(int val) { if (val != m_penaltySeconds) { m_penaltySeconds = val; NPC("PenaltySeconds"); } } };
       property float TimedeltaToPlayer {float get() { return m_timedeltaToPlayer; } void set(float val) { if (val != m_timedeltaToPlayer) { m_timedeltaToPlayer = val; NPC("TimedeltaToPlayer"); } } };
       property float LastTimedeltaToPlayer {float get() { return m_lastTimedeltaToPlayer; } void set(float val) { if (val != m_lastTimedeltaToPlayer) { m_lastTimedeltaToPlayer = val; NPC("LastTimedeltaToPlayer"); } } };
       property float TimedeltaToLeader {float get() { return m_timedeltaToLeader; } void set(float val) { if (val != m_timedeltaToLeader) { m_timedeltaToLeader = val; NPC("TimedeltaToLeader"); } } };
+      property float TimedeltaToCarAhead {float get() { return m_timedeltaToCarAhead; } void set(float val) { if (val != m_timedeltaToCarAhead) { m_timedeltaToCarAhead = val; NPC("TimedeltaToCarAhead"); } } }; // interval, negative: lapped count
       property float CarDamage {float get() { return m_carDamage; } void set(float val) { if (val != m_carDamage) { m_carDamage = val; NPC("CarDamage"); } } };
       property float TrackPositionPerc{ float get() { return m_trackPosPerc; } void set(float val) { if ((val != m_trackPosPerc) && (val > 0.f)) { m_trackPosPerc = val; NPC("TrackPositionPerc"); } } }
       
@@ -562,12 +655,13 @@ namespace adjsw::F12025
       int m_lapNr;
       int m_penaltySeconds;      
       float m_carDamage;
-      array<LapData^>^ m_laps;
+      LapList^ m_laps;
       LapData^ m_fastestLap;
       LapData^ m_currentLap;
       float m_timedeltaToPlayer;
       float m_lastTimedeltaToPlayer;
       float m_timedeltaToLeader;
+      float m_timedeltaToCarAhead;
       CarDetail^ m_carDetail;
       float m_trackPosPerc{ 0.f };
       SessionInfo^ m_sessionInfo;
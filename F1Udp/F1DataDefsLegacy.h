@@ -0,0 +1,321 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include "F1DataDefs.h"
+
+// Packets of older games, only the structs which differ from the F1 25 format (F1DataDefs.h).
+// taken from the "Data Output from F1 23" and "Data Output from F1 24" specifications.
+// The header and all packets not listed here are binary identical.
+
+#pragma pack(push, 1)
+
+namespace F1_2024
+{
+   inline constexpr uint32     cs_maxParticipantNameLen = 48;
+
+   struct ParticipantData
+   {
+      uint8       m_aiControlled;
+      uint8       m_driverId;
+      uint8       m_networkId;
+      uint8       m_teamId;
+      uint8       m_myTeam;
+      uint8       m_raceNumber;
+      uint8       m_nationality;
+      char        m_name[cs_maxParticipantNameLen];
+      uint8       m_yourTelemetry;
+      uint8       m_showOnlineNames;
+      uint16      m_techLevel;
+      uint8       m_platform;
+   };
+
+   struct PacketParticipantsData
+   {
+      PacketHeader    m_header;
+      uint8           m_numActiveCars;
+      ParticipantData m_participants[cs_maxNumCarsInUDPData];
+   };
+
+   static_assert(sizeof(PacketParticipantsData) == 1350);
+
+   // no m_resultReason
+   struct FinalClassificationData
+   {
+      uint8       m_position;
+      uint8       m_numLaps;
+      uint8       m_gridPosition;
+      uint8       m_points;
+      uint8       m_numPitStops;
+      uint8       m_resultStatus;
+      uint32      m_bestLapTimeInMS;
+      double      m_totalRaceTime;
+      uint8       m_penaltiesTime;
+      uint8       m_numPenalties;
+      uint8       m_numTyreStints;
+      uint8       m_tyreStintsActual[cs_maxTyreStints];
+      uint8       m_tyreStintsVisual[cs_maxTyreStints];
+      uint8       m_tyreStintsEndLaps[cs_maxTyreStints];
+   };
+
+   struct PacketFinalClassificationData
+   {
+      PacketHeader            m_header;
+      uint8                   m_numCars;
+      FinalClassificationData m_classificationData[cs_maxNumCarsInUDPData];
+   };
+
+   static_assert(sizeof(PacketFinalClassificationData) == 1020);
+
+   struct LobbyInfoData
+   {
+      uint8       m_aiControlled;
+      uint8       m_teamId;
+      uint8       m_nationality;
+      uint8       m_platform;
+      char        m_name[cs_maxParticipantNameLen];
+      uint8       m_carNumber;
+      uint8       m_yourTelemetry;
+      uint8       m_showOnlineNames;
+      uint16      m_techLevel;
+      uint8       m_readyStatus;
+   };
+
+   struct PacketLobbyInfoData
+   {
+      PacketHeader    m_header;
+      uint8           m_numPlayers;
+      LobbyInfoData   m_lobbyPlayers[cs_maxNumCarsInUDPData];
+   };
+
+   static_assert(sizeof(PacketLobbyInfoData) == 1306);
+
+   // no m_tyreBlisters
+   struct CarDamageData
+   {
+      float       m_tyresWear[4];
+      uint8       m_tyresDamage[4];
+      uint8       m_brakesDamage[4];
+      uint8       m_frontLeftWingDamage;
+      uint8       m_frontRightWingDamage;
+      uint8       m_rearWingDamage;
+      uint8       m_floorDamage;
+      uint8       m_diffuserDamage;
+      uint8       m_sidepodDamage;
+      uint8       m_drsFault;
+      uint8       m_ersFault;
+      uint8       m_gearBoxDamage;
+      uint8       m_engineDamage;
+      uint8       m_engineMGUHWear;
+      uint8       m_engineESWear;
+      uint8       m_engineCEWear;
+      uint8       m_engineICEWear;
+      uint8       m_engineMGUKWear;
+      uint8       m_engineTCWear;
+      uint8       m_engineBlown;
+      uint8       m_engineSeized;
+   };
+
+   struct PacketCarDamageData
+   {
+      PacketHeader    m_header;
+      CarDamageData   m_carDamageData[cs_maxNumCarsInUDPData];
+   };
+
+   static_assert(sizeof(PacketCarDamageData) == 953);
+
+   // F1 25 appended m_chassisPitch, m_wheelCamber and m_wheelCamberGain
+   inline constexpr unsigned cs_motionExSize = 237;
+}
+
+namespace F1_2023
+{
+   inline constexpr uint32     cs_maxWeatherForecastSamples = 56;
+
+   // F1 24 grew the forecast array and appended the fields from m_equalCarPerformance on
+   struct PacketSessionData
+   {
+      PacketHeader    m_header;
+      uint8       m_weather;
+      int8        m_trackTemperature;
+      int8        m_airTemperature;
+      uint8       m_totalLaps;
+      uint16      m_trackLength;
+      uint8       m_sessionType;
+      int8        m_trackId;
+      uint8       m_formula;
+      uint16      m_sessionTimeLeft;
+      uint16      m_sessionDuration;
+      uint8       m_pitSpeedLimit;
+      uint8       m_gamePaused;
+      uint8       m_isSpectating;
+      uint8       m_spectatorCarIndex;
+      uint8       m_sliProNativeSupport;
+      uint8       m_numMarshalZones;
+      MarshalZone m_marshalZones[cs_maxMarshalsZonePerLap];
+      uint8       m_safetyCarStatus;
+      uint8       m_networkGame;
+      uint8       m_numWeatherForecastSamples;
+      WeatherForecastSample m_weatherForecastSamples[cs_maxWeatherForecastSamples];
+      uint8       m_forecastAccuracy;
+      uint8       m_aiDifficulty;
+      uint32      m_seasonLinkIdentifier;
+      uint32      m_weekendLinkIdentifier;
+      uint32      m_sessionLinkIdentifier;
+      uint8       m_pitStopWindowIdealLap;
+      uint8       m_pitStopWindowLatestLap;
+      uint8       m_pitStopRejoinPosition;
+      uint8       m_steeringAssist;
+      uint8       m_brakingAssist;
+      uint8       m_gearboxAssist;
+      uint8       m_pitAssist;
+      uint8       m_pitReleaseAssist;
+      uint8       m_ERSAssist;
+      uint8       m_DRSAssist;
+      uint8       m_dynamicRacingLine;
+      uint8       m_dynamicRacingLineType;
+      uint8       m_gameMode;
+      uint8       m_ruleSet;
+      uint32      m_timeOfDay;
+      uint8       m_sessionLength;
+      uint8       m_speedUnitsLeadPlayer;
+      uint8       m_temperatureUnitsLeadPlayer;
+      uint8       m_speedUnitsSecondaryPlayer;
+      uint8       m_temperatureUnitsSecondaryPlayer;
+      uint8       m_numSafetyCarPeriods;
+      uint8       m_numVirtualSafetyCarPeriods;
+      uint8       m_numRedFlagPeriods;
+   };
+
+   static_assert(sizeof(PacketSessionData) == 644);
+
+   // deltas without minutes part, no speed trap
+   struct LapData
+   {
+      uint32      m_lastLapTimeInMS;
+      uint32      m_currentLapTimeInMS;
+      uint16      m_sector1TimeMSPart;
+      uint8       m_sector1TimeMinutesPart;
+      uint16      m_sector2TimeMSPart;
+      uint8       m_sector2TimeMinutesPart;
+      uint16      m_deltaToCarInFrontInMS;
+      uint16      m_deltaToRaceLeaderInMS;
+      float       m_lapDistance;
+      float       m_totalDistance;
+      float       m_safetyCarDelta;
+      uint8       m_carPosition;
+      uint8       m_currentLapNum;
+      uint8       m_pitStatus;
+      uint8       m_numPitStops;
+      uint8       m_sector;
+      uint8       m_currentLapInvalid;
+      uint8       m_penalties;
+      uint8       m_totalWarnings;
+      uint8       m_cornerCuttingWarnings;
+      uint8       m_numUnservedDriveThroughPens;
+      uint8       m_numUnservedStopGoPens;
+      uint8       m_gridPosition;
+      uint8       m_driverStatus;
+      uint8       m_resultStatus;
+      uint8       m_pitLaneTimerActive;
+      uint16      m_pitLaneTimeInLaneInMS;
+      uint16      m_pitStopTimerInMS;
+      uint8       m_pitStopShouldServePen;
+   };
+
+   struct PacketLapData
+   {
+      PacketHeader    m_header;
+      LapData     m_lapData[cs_maxNumCarsInUDPData];
+      uint8       m_timeTrialPBCarIdx;
+      uint8       m_timeTrialRivalCarIdx;
+   };
+
+   static_assert(sizeof(PacketLapData) == 1131);
+
+   // no m_techLevel
+   struct ParticipantData
+   {
+      uint8       m_aiControlled;
+      uint8       m_driverId;
+      uint8       m_networkId;
+      uint8       m_teamId;
+      uint8       m_myTeam;
+      uint8       m_raceNumber;
+      uint8       m_nationality;
+      char        m_name[F1_2024::cs_maxParticipantNameLen];
+      uint8       m_yourTelemetry;
+      uint8       m_showOnlineNames;
+      uint8       m_platform;
+   };
+
+   struct PacketParticipantsData
+   {
+      PacketHeader    m_header;
+      uint8           m_numActiveCars;
+      ParticipantData m_participants[cs_maxNumCarsInUDPData];
+   };
+
+   static_assert(sizeof(PacketParticipantsData) == 1306);
+
+   // no m_engineBraking, no m_nextFrontWingValue
+   struct CarSetupData
+   {
+      uint8       m_frontWing;
+      uint8       m_rearWing;
+      uint8       m_onThrottle;
+      uint8       m_offThrottle;
+      float       m_frontCamber;
+      float       m_rearCamber;
+      float       m_frontToe;
+      float       m_rearToe;
+      uint8       m_frontSuspension;
+      uint8       m_rearSuspension;
+      uint8       m_frontAntiRollBar;
+      uint8       m_rearAntiRollBar;
+      uint8       m_frontSuspensionHeight;
+      uint8       m_rearSuspensionHeight;
+      uint8       m_brakePressure;
+      uint8       m_brakeBias;
+      float       m_rearLeftTyrePressure;
+      float       m_rearRightTyrePressure;
+      float       m_frontLeftTyrePressure;
+      float       m_frontRightTyrePressure;
+      uint8       m_ballast;
+      float       m_fuelLoad;
+   };
+
+   struct PacketCarSetupData
+   {
+      PacketHeader    m_header;
+      CarSetupData    m_carSetupData[cs_maxNumCarsInUDPData];
+   };
+
+   static_assert(sizeof(PacketCarSetupData) == 1107);
+
+   // no m_yourTelemetry, m_showOnlineNames, m_techLevel
+   struct LobbyInfoData
+   {
+      uint8       m_aiControlled;
+      uint8       m_teamId;
+      uint8       m_nationality;
+      uint8       m_platform;
+      char        m_name[F1_2024::cs_maxParticipantNameLen];
+      uint8       m_carNumber;
+      uint8       m_readyStatus;
+   };
+
+   struct PacketLobbyInfoData
+   {
+      PacketHeader    m_header;
+      uint8           m_numPlayers;
+      LobbyInfoData   m_lobbyPlayers[cs_maxNumCarsInUDPData];
+   };
+
+   static_assert(sizeof(PacketLobbyInfoData) == 1218);
+
+   // F1 24 appended the aero heights, roll angles and m_chassisYaw
+   inline constexpr unsigned cs_motionExSize = 217;
+}
+
+#pragma pack(pop)
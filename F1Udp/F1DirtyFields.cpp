@@ -0,0 +1,94 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1DirtyFields.h"
+
+namespace
+{
+   uint32_t s_LapFields(const LapData& now, const LapData& last)
+   {
+      uint32_t dirty = 0;
+      if (now.m_resultStatus != last.m_resultStatus)
+         dirty |= cs_fieldPresent | cs_fieldStatus;
+
+      if ((now.m_pitStatus != last.m_pitStatus) || (now.m_driverStatus != last.m_driverStatus))
+         dirty |= cs_fieldStatus;
+
+      if (now.m_lapDistance != last.m_lapDistance)
+         dirty |= cs_fieldTrackPosition;
+
+      if (now.m_penalties != last.m_penalties)
+         dirty |= cs_fieldPenalties;
+
+      if ((now.m_currentLapNum != last.m_currentLapNum) || (now.m_carPosition != last.m_carPosition) ||
+         (now.m_lastLapTimeInMS != last.m_lastLapTimeInMS) || (now.m_currentLapInvalid != last.m_currentLapInvalid) ||
+         (now.m_sector1TimeMSPart != last.m_sector1TimeMSPart) || (now.m_sector1TimeMinutesPart != last.m_sector1TimeMinutesPart) ||
+         (now.m_sector2TimeMSPart != last.m_sector2TimeMSPart) || (now.m_sector2TimeMinutesPart != last.m_sector2TimeMinutesPart))
+         dirty |= cs_fieldTiming;
+
+      if ((now.m_deltaToRaceLeaderMSPart != last.m_deltaToRaceLeaderMSPart) || (now.m_deltaToRaceLeaderMinutesPart != last.m_deltaToRaceLeaderMinutesPart))
+         dirty |= cs_fieldLeaderDelta;
+
+      return dirty;
+   }
+
+   uint32_t s_StatusFields(const CarStatusData& now, const CarStatusData& last)
+   {
+      uint32_t dirty = 0;
+      if (now.m_actualTyreCompound != last.m_actualTyreCompound)
+         dirty |= cs_fieldTyre;
+
+      if (now.m_visualTyreCompound != last.m_visualTyreCompound)
+         dirty |= cs_fieldVisualTyre;
+
+      if (now.m_tyresAgeLaps != last.m_tyresAgeLaps)
+         dirty |= cs_fieldTyreAge;
+
+      return dirty;
+   }
+
+   unsigned s_Count(uint32_t fields)
+   {
+      unsigned count = 0;
+      for (; fields; fields &= fields - 1)
+         ++count;
+      return count;
+   }
+}
+
+void F1DirtyFields::Reset()
+{
+   m_valid = false;
+   m_player = -1;
+   m_leader = -1;
+   m_dirty.fill(cs_fieldAll);
+   m_touched.fill(0);
+}
+
+void F1DirtyFields::Update(const PacketLapData& lap, const PacketCarStatusData& status)
+{
+   ++m_updates;
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      uint32_t dirty = cs_fieldAll;
+      if (m_valid)
+         dirty = s_LapFields(lap.m_lapData[i], m_lap[i]) | s_StatusFields(status.m_carStatusData[i], m_status[i]);
+
+      m_dirty[i] = dirty | m_touched[i];
+      m_dirtyFields += s_Count(m_dirty[i]);
+      m_lap[i] = lap.m_lapData[i];
+      m_status[i] = status.m_carStatusData[i];
+   }
+   m_touched.fill(0);
+   m_valid = true;
+}
+
+uint32_t F1DirtyFields::m_Reference(int& last, int car)
+{
+   if (car != last)
+   {
+      last = car;
+      return cs_fieldAll;
+   }
+   return (car >= 0) ? m_dirty[car] : 0;
+}
@@ -0,0 +1,75 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <array>
+#include "F1DataDefs.h"
+
+// fields of a driver which are taken from the lap and status data of a frame
+enum DriverField : uint32_t
+{
+   cs_fieldPresent = 1u << 0,        // m_resultStatus
+   cs_fieldTrackPosition = 1u << 1,  // m_lapDistance (also changes the live gaps)
+   cs_fieldPenalties = 1u << 2,      // m_penalties
+   cs_fieldTyre = 1u << 3,           // m_actualTyreCompound
+   cs_fieldVisualTyre = 1u << 4,     // m_visualTyreCompound
+   cs_fieldTyreAge = 1u << 5,        // m_tyresAgeLaps
+   cs_fieldStatus = 1u << 6,         // m_resultStatus, m_pitStatus, m_driverStatus
+   cs_fieldTiming = 1u << 7,         // lap number, sector and lap times, position: the sector deltas
+   cs_fieldLeaderDelta = 1u << 8,    // m_deltaToRaceLeader
+   cs_fieldAll = (1u << 9) - 1
+};
+inline constexpr unsigned cs_driverFieldCount = 9;
+
+// the fields the deltas of a car to a reference car depend on, of both cars. The delta to the player is taken per
+// sector, the one to the leader is live (F1GapTracker.h).
+inline constexpr uint32_t cs_fieldsDeltaPlayer = cs_fieldPenalties | cs_fieldTiming;
+inline constexpr uint32_t cs_fieldsDeltaLeader = cs_fieldTrackPosition | cs_fieldTiming | cs_fieldLeaderDelta;
+
+// Per car, per field dirty mask of the frames: the lap and status records of a frame are compared with the ones of
+// the last Update(), so the driver list only applies the fields which changed instead of all fields of all cars.
+// State which does not come from the frame (events, session history, session data) marks fields with Touch().
+class F1DirtyFields
+{
+public:
+   F1DirtyFields() { Reset(); }
+
+   // everything is dirty with the next Update()
+   void Reset();
+
+   // compare with the records of the last Update(). A frame which was already seen (e.g. the driver list is
+   // updated again for a lobby packet) leaves only the touched fields dirty.
+   void Update(const PacketLapData& lap, const PacketCarStatusData& status);
+
+   // the changed fields of a car in the last Update()
+   uint32_t Dirty(unsigned car) const { return m_dirty[car]; }
+
+   // mark fields of a car dirty for the next Update()
+   void Touch(unsigned car, uint32_t fields) { m_touched[car] |= fields; }
+   void TouchAll(uint32_t fields)
+   {
+      for (uint32_t& touched : m_touched)
+         touched |= fields;
+   }
+
+   // dirty fields of the reference cars of the deltas (-1: none), all fields when it is another car than before
+   uint32_t Player(int car) { return m_Reference(m_player, car); }
+   uint32_t Leader(int car) { return m_Reference(m_leader, car); }
+
+   uint64_t Updates() const { return m_updates; }
+   uint64_t DirtyFields() const { return m_dirtyFields; } // sum of the dirty fields of all cars and updates
+
+private:
+   uint32_t m_Reference(int& last, int car);
+
+   std::array<LapData, cs_maxNumCarsInUDPData> m_lap;
+   std::array<CarStatusData, cs_maxNumCarsInUDPData> m_status;
+   std::array<uint32_t, cs_maxNumCarsInUDPData> m_dirty;
+   std::array<uint32_t, cs_maxNumCarsInUDPData> m_touched;
+   bool m_valid{ false };
+   int m_player{ -1 };
+   int m_leader{ -1 };
+   uint64_t m_updates{ 0 };
+   uint64_t m_dirtyFields{ 0 };
+};
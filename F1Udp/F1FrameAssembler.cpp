@@ -0,0 +1,155 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1FrameAssembler.h"
+
+#include <string.h>
+
+namespace
+{
+   template<typename PKT_TYPE>
+   bool s_Store(PKT_TYPE& target, const PacketRef& ref)
+   {
+      if (ref.len < sizeof(PKT_TYPE))
+         return false;
+
+      memcpy(&target, ref.pData, sizeof(PKT_TYPE));
+      return true;
+   }
+}
+
+F1FrameAssembler::F1FrameAssembler(uint16_t expected, uint64_t timeout) :
+   expectedMask(expected),
+   timeoutNs(timeout)
+{
+}
+
+bool F1FrameAssembler::IsFramePacket(PacketType type)
+{
+   switch (type)
+   {
+   case PacketType::PacketMotionData:
+   case PacketType::PacketLapData:
+   case PacketType::PacketCarTelemetryData:
+   case PacketType::PacketCarStatusData:
+   case PacketType::PacketCarDamageData:
+      return true;
+
+   default:
+      return false;
+   }
+}
+
+bool F1FrameAssembler::Add(const PacketRef& ref, uint64_t nowNs)
+{
+   if (!ref.pData || !IsFramePacket(ref.type) || (ref.len < sizeof(PacketHeader)))
+      return false;
+
+   PacketHeader hdr;
+   memcpy(&hdr, ref.pData, sizeof(hdr));
+
+   bool published = false;
+   if (m_building && ((hdr.m_frameIdentifier != m_Back().frameIdentifier) || (hdr.m_sessionUID != m_Back().sessionUID)))
+   {
+      m_Publish(false);
+      published = true;
+   }
+
+   if (!m_building)
+      m_Begin(hdr, nowNs);
+
+   FrameSnapshot& frame = m_Back();
+   bool stored = false;
+   switch (ref.type)
+   {
+   case PacketType::PacketMotionData:
+      stored = s_Store(frame.motion, ref);
+      break;
+
+   case PacketType::PacketLapData:
+      stored = s_Store(frame.lap, ref);
+      break;
+
+   case PacketType::PacketCarTelemetryData:
+      stored = s_Store(frame.telemetry, ref);
+      break;
+
+   case PacketType::PacketCarStatusData:
+      stored = s_Store(frame.status, ref);
+      break;
+
+   case PacketType::PacketCarDamageData:
+      stored = s_Store(frame.cardamage, ref);
+      break;
+
+   default:
+      break;
+   }
+
+   if (!stored)
+      return published;
+
+   frame.receivedMask |= PacketBit(ref.type);
+   frame.availableMask |= PacketBit(ref.type);
+
+   if ((frame.receivedMask & expectedMask) == expectedMask)
+   {
+      m_Publish(true);
+      published = true;
+   }
+
+   return published;
+}
+
+bool F1FrameAssembler::Poll(uint64_t nowNs)
+{
+   if (!m_building || (nowNs - m_frameStartNs < timeoutNs))
+      return false;
+
+   m_Publish(false);
+   return true;
+}
+
+void F1FrameAssembler::Reset()
+{
+   m_snapshots[0] = FrameSnapshot();
+   m_snapshots[1] = FrameSnapshot();
+   m_front = 0;
+   m_building = false;
+   m_frameStartNs = 0;
+}
+
+void F1FrameAssembler::m_Begin(const PacketHeader& hdr, uint64_t nowNs)
+{
+   // start from the last snapshot, so packets missing in this frame keep their last value (within the same session)
+   FrameSnapshot& frame = m_Back();
+   if (Current().sessionUID == hdr.m_sessionUID)
+      frame = Current();
+   else
+      frame = FrameSnapshot();
+
+   frame.sessionUID = hdr.m_sessionUID;
+   frame.frameIdentifier = hdr.m_frameIdentifier;
+   frame.overallFrameIdentifier = hdr.m_overallFrameIdentifier;
+   frame.sessionTime = hdr.m_sessionTime;
+   frame.receivedMask = 0;
+   frame.complete = false;
+
+   m_building = true;
+   m_frameStartNs = nowNs;
+}
+
+void F1FrameAssembler::m_Publish(bool complete)
+{
+   FrameSnapshot& frame = m_Back();
+   frame.complete = complete;
+   frame.sequence = Current().sequence + 1;
+
+   if (complete)
+      ++publishedComplete;
+   else
+      ++publishedIncomplete;
+
+   m_front ^= 1;
+   m_building = false;
+}
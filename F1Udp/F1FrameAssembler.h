@@ -0,0 +1,71 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include "F1DataDefs.h"
+#include "F1PacketView.h"
+
+// All per-frame packets of one m_frameIdentifier.
+// Packets which did not arrive for this frame (see receivedMask) are carried over from the previous snapshot.
+struct FrameSnapshot
+{
+   uint64_t sessionUID{ 0 };
+   uint32_t frameIdentifier{ 0 };
+   uint32_t overallFrameIdentifier{ 0 };
+   float sessionTime{ 0 };
+
+   uint32_t sequence{ 0 };      // incremented with every published snapshot, 0: nothing published yet
+   uint16_t receivedMask{ 0 };  // packets received for this frame, bit = PacketType
+   uint16_t availableMask{ 0 }; // packets received at least once since Reset()
+   bool complete{ false };      // false: published by timeout or because the next frame started
+
+   PacketMotionData motion{};
+   PacketLapData lap{};
+   PacketCarTelemetryData telemetry{};
+   PacketCarStatusData status{};
+   PacketCarDamageData cardamage{};
+};
+
+// Groups the per-frame packets by m_frameIdentifier and publishes a snapshot once the expected packets of a frame arrived.
+// Snapshots are double buffered: Current() is never written to, it stays unchanged until the next snapshot is published.
+class F1FrameAssembler
+{
+public:
+   // damage is sent at a lower rate than the others, thus not expected by default
+   static constexpr uint16_t cs_defaultExpected = PacketBit(PacketType::PacketLapData) | PacketBit(PacketType::PacketCarTelemetryData) | PacketBit(PacketType::PacketCarStatusData);
+
+   explicit F1FrameAssembler(uint16_t expected = cs_defaultExpected, uint64_t timeoutNs = 50000000ull);
+
+   static bool IsFramePacket(PacketType type);
+
+   // add an accepted packet (e.g. F12025_PacketExtractor::lastPacket), other packet types are ignored.
+   // Returns true if a snapshot was published, which is either the frame of this packet (complete)
+   // or the previous frame (incomplete) because this packet starts a new one.
+   bool Add(const PacketRef& ref, uint64_t nowNs);
+
+   // publish an incomplete frame after timeoutNs, returns true if a snapshot was published
+   bool Poll(uint64_t nowNs);
+
+   // drop all frames, e.g. on a new session
+   void Reset();
+
+   const FrameSnapshot& Current() const { return m_snapshots[m_front]; }
+
+   uint16_t expectedMask;
+   uint64_t timeoutNs;
+
+   uint64_t publishedComplete{ 0 };
+   uint64_t publishedIncomplete{ 0 };
+
+private:
+   FrameSnapshot& m_Back() { return m_snapshots[m_front ^ 1]; }
+
+   void m_Begin(const PacketHeader& hdr, uint64_t nowNs);
+   void m_Publish(bool complete);
+
+   FrameSnapshot m_snapshots[2];
+   unsigned m_front{ 0 };
+   bool m_building{ false }; // back buffer holds an unpublished frame
+   uint64_t m_frameStartNs{ 0 };
+};
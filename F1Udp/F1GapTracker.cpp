@@ -0,0 +1,78 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1GapTracker.h"
+
+static_assert((cs_gapSamples & (cs_gapSamples - 1)) == 0);
+
+void F1GapTracker::Clear()
+{
+   m_cars.fill(Car{ 0, 0, { 0.f, 0.f } });
+}
+
+const F1GapTracker::Sample& F1GapTracker::m_Sample(unsigned car, uint32_t k) const
+{
+   const Car& c = m_cars[car];
+   if (k == c.count)
+      return c.now;
+
+   return m_samples[car * cs_gapSamples + ((c.head - c.count + k) & (cs_gapSamples - 1))];
+}
+
+void F1GapTracker::Add(unsigned car, float totalDistance, float sessionTime)
+{
+   Car& c = m_cars[car];
+
+   // flashback / restart: forget the part which is driven again
+   while (c.count)
+   {
+      const Sample& newest = m_Sample(car, c.count - 1);
+      if ((newest.distance <= totalDistance) && (newest.time <= sessionTime))
+         break;
+
+      --c.head;
+      --c.count;
+   }
+
+   c.now = { totalDistance, sessionTime };
+   if (c.count && ((totalDistance - m_Sample(car, c.count - 1).distance) < cs_gapSampleMeters))
+      return;
+
+   m_samples[car * cs_gapSamples + (c.head & (cs_gapSamples - 1))] = c.now;
+   ++c.head;
+   if (c.count < cs_gapSamples)
+      ++c.count;
+}
+
+bool F1GapTracker::Gap(unsigned ahead, unsigned behind, float& seconds) const
+{
+   const Car& a = m_cars[ahead];
+   const Car& b = m_cars[behind];
+   const float distance = b.now.distance;
+
+   if (!a.count || !b.count || (distance >= a.now.distance) || (m_Sample(ahead, 0).distance > distance))
+      return false;
+
+   // first sample at or beyond the distance (at the latest "now"), the one before it is short of it
+   uint32_t lo = 0;
+   uint32_t hi = a.count;
+   while (lo < hi)
+   {
+      const uint32_t mid = (lo + hi) / 2;
+      if (m_Sample(ahead, mid).distance < distance)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   const Sample& s1 = m_Sample(ahead, lo);
+   float time = s1.time;
+   if (s1.distance != distance)
+   {
+      const Sample& s0 = m_Sample(ahead, lo - 1);
+      time = s0.time + (s1.time - s0.time) * ((distance - s0.distance) / (s1.distance - s0.distance));
+   }
+
+   seconds = b.now.time - time;
+   return true;
+}
@@ -0,0 +1,54 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include "F1DataDefs.h"
+
+inline constexpr unsigned cs_gapSamples = 2048;      // per car, power of 2
+inline constexpr float cs_gapSampleMeters = 10.f;    // min. distance between two samples of a car
+
+// Live gaps between cars, updated with every PacketLapData instead of once per sector.
+// Each car keeps a ring of (m_totalDistance, session time) samples. The gap of a car behind is the time since the
+// car ahead was at the current distance of the car behind, interpolated between the two samples of the car ahead
+// around it. The samples are taken at least cs_gapSampleMeters apart, so the ring holds about 20 km per car
+// (several laps on every track) in a fixed amount of memory.
+class F1GapTracker
+{
+public:
+   F1GapTracker() : m_samples(cs_gapSamples * cs_maxNumCarsInUDPData) { Clear(); }
+
+   void Clear();
+
+   // position of a car in a lap packet. A distance or time going backwards (flashback) drops the samples ahead of it.
+   void Add(unsigned car, float totalDistance, float sessionTime);
+
+   // seconds since the car ahead was at the current distance of the car behind.
+   // False if the car behind is not behind or the distance is older than the samples of the car ahead.
+   bool Gap(unsigned ahead, unsigned behind, float& seconds) const;
+
+   // last position of a car, 0 if none
+   float Distance(unsigned car) const { return m_cars[car].now.distance; }
+
+private:
+   struct Sample
+   {
+      float distance;
+      float time;
+   };
+
+   struct Car
+   {
+      uint32_t head;  // next sample written
+      uint32_t count; // samples in the ring
+      Sample now;     // the last position, not necessarily a sample
+   };
+
+   // k-th oldest sample, k == count: now
+   const Sample& m_Sample(unsigned car, uint32_t k) const;
+
+   std::vector<Sample> m_samples; // [car][cs_gapSamples]
+   std::array<Car, cs_maxNumCarsInUDPData> m_cars;
+};
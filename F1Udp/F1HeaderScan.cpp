@@ -0,0 +1,311 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1HeaderScan.h"
+#include "F1PacketExtractor.h"
+
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define F1_HEADERSCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define F1_HEADERSCAN_X86 0
+#endif
+
+// MSVC allows any intrinsic in any function, gcc and clang need the target per function
+#if defined(__GNUC__) || defined(__clang__)
+#define F1_TARGET(x) __attribute__((target(x)))
+#else
+#define F1_TARGET(x)
+#endif
+
+namespace
+{
+   // the header fields of a burst, one array per field. Unused lanes are zero and thus invalid (format 0).
+   struct GatheredHeaders
+   {
+      alignas(32) int32_t format[cs_headerScanMax];
+      alignas(32) int32_t version[cs_headerScanMax];
+      alignas(32) int32_t packetId[cs_headerScanMax];
+      alignas(32) int32_t len[cs_headerScanMax];
+      alignas(32) uint64_t sessionUID[cs_headerScanMax + 1]; // [0]: session before the burst, [i + 1]: datagram i
+   };
+
+   // lanes are processed in groups of 8 (one AVX2 register of int32)
+   unsigned s_Padded(unsigned count)
+   {
+      return (count + 7) & ~7u;
+   }
+
+   void s_Gather(const DatagramDesc* pDatagrams, unsigned count, uint64_t sessionUID, GatheredHeaders& g)
+   {
+      g.sessionUID[0] = sessionUID;
+
+      const unsigned padded = s_Padded(count);
+      for (unsigned i = 0; i < padded; ++i)
+      {
+         PacketHeader hdr{};
+         unsigned len = 0;
+         if ((i < count) && pDatagrams[i].pData && (pDatagrams[i].len >= sizeof(PacketHeader)))
+         {
+            memcpy(&hdr, pDatagrams[i].pData, sizeof(PacketHeader));
+            len = pDatagrams[i].len;
+         }
+
+         g.format[i] = hdr.m_packetFormat;
+         g.version[i] = hdr.m_packetVersion;
+         g.packetId[i] = hdr.m_packetId;
+         g.len[i] = (len > 0x7FFFFFFFu) ? 0x7FFFFFFF : static_cast<int32_t>(len);
+         g.sessionUID[i + 1] = hdr.m_sessionUID;
+      }
+   }
+
+   void s_ValidateScalar(const GatheredHeaders& g, unsigned padded, const HeaderScanTable& table, uint64_t& headerMask, uint64_t& validMask)
+   {
+      for (unsigned i = 0; i < padded; ++i)
+      {
+         const int32_t rel = g.format[i] - table.firstFormat;
+         if ((rel < 0) || (rel >= table.formatCount) || (g.version[i] != 1))
+            continue;
+
+         headerMask |= 1ull << i;
+
+         if ((g.packetId[i] < 0) || (g.packetId[i] >= 16))
+            continue;
+
+         const int32_t wireSize = table.wireSize[rel * 16 + g.packetId[i]];
+         if (wireSize && (g.len[i] >= wireSize))
+            validMask |= 1ull << i;
+      }
+   }
+
+   void s_CompareSessionsScalar(const GatheredHeaders& g, unsigned padded, uint64_t& differsMask, uint64_t& zeroMask)
+   {
+      for (unsigned i = 0; i < padded; ++i)
+      {
+         if (g.sessionUID[i + 1] != g.sessionUID[i])
+            differsMask |= 1ull << i;
+         if (!g.sessionUID[i + 1])
+            zeroMask |= 1ull << i;
+      }
+   }
+
+#if F1_HEADERSCAN_X86
+   void s_ValidateSse2(const GatheredHeaders& g, unsigned padded, const HeaderScanTable& table, uint64_t& headerMask, uint64_t& validMask)
+   {
+      const __m128i first = _mm_set1_epi32(table.firstFormat);
+      const __m128i formats = _mm_set1_epi32(table.formatCount);
+      const __m128i one = _mm_set1_epi32(1);
+      const __m128i ids = _mm_set1_epi32(16);
+      const __m128i minusOne = _mm_set1_epi32(-1);
+      const __m128i zero = _mm_setzero_si128();
+
+      for (unsigned i = 0; i < padded; i += 4)
+      {
+         const __m128i rel = _mm_sub_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(g.format + i)), first);
+         const __m128i fmtOk = _mm_and_si128(_mm_cmpgt_epi32(rel, minusOne), _mm_cmpgt_epi32(formats, rel));
+         const __m128i hdrOk = _mm_and_si128(fmtOk, _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(g.version + i)), one));
+
+         const __m128i id = _mm_load_si128(reinterpret_cast<const __m128i*>(g.packetId + i));
+         const __m128i idOk = _mm_and_si128(hdrOk, _mm_and_si128(_mm_cmpgt_epi32(id, minusOne), _mm_cmpgt_epi32(ids, id)));
+         const unsigned idBits = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(idOk)));
+
+         // no gather before AVX2, only the lanes with a valid index are looked up
+         alignas(16) int32_t wireSizes[4] = {};
+         for (unsigned k = 0; k < 4; ++k)
+         {
+            if (idBits & (1u << k))
+               wireSizes[k] = table.wireSize[(g.format[i + k] - table.firstFormat) * 16 + g.packetId[i + k]];
+         }
+
+         const __m128i ws = _mm_load_si128(reinterpret_cast<const __m128i*>(wireSizes));
+         const __m128i len = _mm_load_si128(reinterpret_cast<const __m128i*>(g.len + i));
+         const __m128i ok = _mm_andnot_si128(_mm_cmpeq_epi32(ws, zero), _mm_andnot_si128(_mm_cmpgt_epi32(ws, len), idOk));
+
+         headerMask |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(hdrOk))) << i;
+         validMask |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(ok))) << i;
+      }
+   }
+
+   void s_CompareSessionsSse2(const GatheredHeaders& g, unsigned padded, uint64_t& differsMask, uint64_t& zeroMask)
+   {
+      const __m128i zero = _mm_setzero_si128();
+
+      for (unsigned i = 0; i < padded; i += 2)
+      {
+         const __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.sessionUID + i + 1));
+         const __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.sessionUID + i));
+
+         // no 64 bit compare in SSE2: both 32 bit halves must be equal
+         __m128i eq = _mm_cmpeq_epi32(cur, prev);
+         eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+         __m128i isZero = _mm_cmpeq_epi32(cur, zero);
+         isZero = _mm_and_si128(isZero, _mm_shuffle_epi32(isZero, _MM_SHUFFLE(2, 3, 0, 1)));
+
+         differsMask |= static_cast<uint64_t>(~_mm_movemask_pd(_mm_castsi128_pd(eq)) & 0x3) << i;
+         zeroMask |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(isZero))) << i;
+      }
+   }
+
+   F1_TARGET("avx2") void s_ValidateAvx2(const GatheredHeaders& g, unsigned padded, const HeaderScanTable& table, uint64_t& headerMask, uint64_t& validMask)
+   {
+      const __m256i first = _mm256_set1_epi32(table.firstFormat);
+      const __m256i formats = _mm256_set1_epi32(table.formatCount);
+      const __m256i one = _mm256_set1_epi32(1);
+      const __m256i ids = _mm256_set1_epi32(16);
+      const __m256i minusOne = _mm256_set1_epi32(-1);
+      const __m256i zero = _mm256_setzero_si256();
+
+      for (unsigned i = 0; i < padded; i += 8)
+      {
+         const __m256i rel = _mm256_sub_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(g.format + i)), first);
+         const __m256i fmtOk = _mm256_and_si256(_mm256_cmpgt_epi32(rel, minusOne), _mm256_cmpgt_epi32(formats, rel));
+         const __m256i hdrOk = _mm256_and_si256(fmtOk, _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(g.version + i)), one));
+
+         const __m256i id = _mm256_load_si256(reinterpret_cast<const __m256i*>(g.packetId + i));
+         const __m256i idOk = _mm256_and_si256(hdrOk, _mm256_and_si256(_mm256_cmpgt_epi32(id, minusOne), _mm256_cmpgt_epi32(ids, id)));
+
+         // rejected lanes are not loaded and read as wire size 0
+         const __m256i index = _mm256_and_si256(_mm256_add_epi32(_mm256_slli_epi32(rel, 4), id), idOk);
+         const __m256i ws = _mm256_mask_i32gather_epi32(zero, table.wireSize, index, idOk, 4);
+         const __m256i len = _mm256_load_si256(reinterpret_cast<const __m256i*>(g.len + i));
+         const __m256i ok = _mm256_andnot_si256(_mm256_cmpeq_epi32(ws, zero), _mm256_andnot_si256(_mm256_cmpgt_epi32(ws, len), idOk));
+
+         headerMask |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(hdrOk))) << i;
+         validMask |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(ok))) << i;
+      }
+   }
+
+   F1_TARGET("avx2") void s_CompareSessionsAvx2(const GatheredHeaders& g, unsigned padded, uint64_t& differsMask, uint64_t& zeroMask)
+   {
+      const __m256i zero = _mm256_setzero_si256();
+
+      for (unsigned i = 0; i < padded; i += 4)
+      {
+         const __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(g.sessionUID + i + 1));
+         const __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(g.sessionUID + i));
+
+         differsMask |= static_cast<uint64_t>(~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(cur, prev))) & 0xF) << i;
+         zeroMask |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(cur, zero)))) << i;
+      }
+   }
+
+   HeaderScanPath s_DetectPath()
+   {
+#if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] < 7)
+         return HeaderScanPath::SSE2;
+
+      __cpuid(info, 1);
+      const bool osxsave = (info[2] & (1 << 27)) != 0;
+      const bool avx = (info[2] & (1 << 28)) != 0;
+      if (!osxsave || !avx || ((_xgetbv(0) & 0x6) != 0x6)) // OS saves the ymm registers
+         return HeaderScanPath::SSE2;
+
+      __cpuidex(info, 7, 0);
+      return (info[1] & (1 << 5)) ? HeaderScanPath::AVX2 : HeaderScanPath::SSE2;
+#else
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") ? HeaderScanPath::AVX2 : HeaderScanPath::SSE2;
+#endif
+   }
+#endif
+}
+
+HeaderScanPath HeaderScanBestPath()
+{
+#if F1_HEADERSCAN_X86
+   static const HeaderScanPath s_best = s_DetectPath();
+   return s_best;
+#else
+   return HeaderScanPath::Scalar;
+#endif
+}
+
+unsigned ScanHeaders(const DatagramDesc* pDatagrams, unsigned count, const HeaderScanTable& table, uint64_t sessionUID, HeaderScan& scan)
+{
+   return ScanHeaders(pDatagrams, count, table, sessionUID, scan, HeaderScanBestPath());
+}
+
+unsigned ScanHeaders(const DatagramDesc* pDatagrams, unsigned count, const HeaderScanTable& table, uint64_t sessionUID, HeaderScan& scan, HeaderScanPath path)
+{
+   if (count > cs_headerScanMax)
+      count = cs_headerScanMax;
+
+   GatheredHeaders g;
+   s_Gather(pDatagrams, count, sessionUID, g);
+
+   const unsigned padded = s_Padded(count);
+   const uint64_t countMask = (count == 64) ? ~0ull : ((1ull << count) - 1);
+   uint64_t headerMask = 0;
+   uint64_t validMask = 0;
+   uint64_t differsMask = 0;
+   uint64_t zeroMask = 0;
+
+#if !F1_HEADERSCAN_X86
+   path = HeaderScanPath::Scalar;
+#endif
+
+   switch (path)
+   {
+#if F1_HEADERSCAN_X86
+   case HeaderScanPath::AVX2:
+      s_ValidateAvx2(g, padded, table, headerMask, validMask);
+      s_CompareSessionsAvx2(g, padded, differsMask, zeroMask);
+      break;
+
+   case HeaderScanPath::SSE2:
+      s_ValidateSse2(g, padded, table, headerMask, validMask);
+      s_CompareSessionsSse2(g, padded, differsMask, zeroMask);
+      break;
+#endif
+
+   default:
+      s_ValidateScalar(g, padded, table, headerMask, validMask);
+      s_CompareSessionsScalar(g, padded, differsMask, zeroMask);
+      break;
+   }
+
+   scan.headerMask = headerMask & countMask;
+   scan.validMask = validMask & countMask;
+
+   if ((scan.headerMask == countMask) && !(zeroMask & countMask))
+   {
+      // usual burst: every datagram is a header of a running session, a change is a difference to the predecessor
+      scan.sessionChangedMask = differsMask & countMask;
+      scan.lastSessionUID = count ? g.sessionUID[count] : sessionUID;
+   }
+   else
+   {
+      // rejected datagrams and session UID 0 (menu) do not change the running session
+      scan.sessionChangedMask = 0;
+      uint64_t running = sessionUID;
+      for (unsigned i = 0; i < count; ++i)
+      {
+         const uint64_t uid = g.sessionUID[i + 1];
+         if (!(scan.headerMask & (1ull << i)) || !uid)
+            continue;
+
+         if (uid != running)
+            scan.sessionChangedMask |= 1ull << i;
+         running = uid;
+      }
+      scan.lastSessionUID = running;
+   }
+
+   for (unsigned i = 0; i < count; ++i)
+      scan.packetId[i] = static_cast<uint8_t>(g.packetId[i]);
+
+   uint64_t valid = scan.validMask;
+   unsigned cnt = 0;
+   for (; valid; valid &= valid - 1)
+      ++cnt;
+
+   return cnt;
+}
@@ -0,0 +1,47 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include "F1DataDefs.h"
+
+struct DatagramDesc;
+
+// Pre-pass over the headers of a datagram burst: validates format, version, packet id and length of up to
+// cs_headerScanMax datagrams at once and finds the session changes, before any payload is read.
+
+inline constexpr unsigned cs_headerScanMax = 64;
+inline constexpr unsigned cs_headerScanMaxFormats = 4;
+
+// wire size per m_packetFormat and m_packetId, the accepted formats must be consecutive (2023, 2024, 2025)
+struct HeaderScanTable
+{
+   uint16_t firstFormat{ 0 };
+   uint16_t formatCount{ 0 };
+   int32_t wireSize[cs_headerScanMaxFormats * 16]{}; // [m_packetFormat - firstFormat][m_packetId], 0: not sent in this format
+};
+
+// bit i refers to datagram i of the burst
+struct HeaderScan
+{
+   uint64_t headerMask{ 0 };         // complete header with accepted format and version 1
+   uint64_t validMask{ 0 };          // headerMask + known packet id + len >= wire size
+   uint64_t sessionChangedMask{ 0 }; // headerMask + non-zero m_sessionUID, which differs from the one before
+   uint64_t lastSessionUID{ 0 };     // session UID after the burst
+   uint8_t packetId[cs_headerScanMax]{}; // = PacketType, only set for headerMask
+};
+
+enum class HeaderScanPath
+{
+   Scalar,
+   SSE2,
+   AVX2
+};
+
+// best path of this CPU
+HeaderScanPath HeaderScanBestPath();
+
+// count <= cs_headerScanMax. sessionUID is the session before the burst (F12025_PacketExtractor::sessionUID).
+// Returns the number of valid datagrams.
+unsigned ScanHeaders(const DatagramDesc* pDatagrams, unsigned count, const HeaderScanTable& table, uint64_t sessionUID, HeaderScan& scan);
+unsigned ScanHeaders(const DatagramDesc* pDatagrams, unsigned count, const HeaderScanTable& table, uint64_t sessionUID, HeaderScan& scan, HeaderScanPath path);
@@ -0,0 +1,646 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1Journal.h"
+#include "F1MappedFile.h"
+
+#include <string.h>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+   constexpr uint8_t cs_journalSessionCar = 255;
+
+   // m_penaltyType values of the penalties served in the pits, as F1TimingModel::m_UpdateEventData()
+   constexpr uint8_t cs_pitPenalties[] = { 0, 1, 6, 16 };
+
+   struct CrcTable
+   {
+      CrcTable()
+      {
+         for (uint32_t i = 0; i < 256; ++i)
+         {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+               c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            table[i] = c;
+         }
+      }
+
+      uint32_t table[256];
+   };
+
+   const CrcTable s_crcTable;
+
+   JournalRecord s_Record(JournalKind kind, uint8_t car, uint16_t index, int32_t value)
+   {
+      JournalRecord rec{};
+      rec.kind = kind;
+      rec.car = car;
+      rec.index = index;
+      rec.value = value;
+      return rec;
+   }
+
+   bool s_SameLap(const TimingLap& a, const TimingLap& b)
+   {
+      return (a.sector1 == b.sector1) && (a.sector2 == b.sector2) && (a.lap == b.lap) && (a.lapsAccumulated == b.lapsAccumulated) &&
+         (a.invalid == b.invalid);
+   }
+
+   // penaltyServed has its own record
+   bool s_SameEvent(const TimingEvent& a, const TimingEvent& b)
+   {
+      return !memcmp(a.code, b.code, sizeof(a.code)) && (a.timeCode == b.timeCode) && (a.carIndex == b.carIndex) &&
+         (a.penaltyType == b.penaltyType) && (a.infringementType == b.infringementType) && (a.otherVehicleIdx == b.otherVehicleIdx) &&
+         (a.timeGained == b.timeGained) && (a.lapNum == b.lapNum) && (a.placesGained == b.placesGained);
+   }
+
+   // number of valid records behind the header, 0 without a valid header
+   uint64_t s_ValidRecords(const uint8_t* pData, uint64_t size, bool& validHeader, std::vector<JournalRecord>* pRecords)
+   {
+      JournalFileHeader hdr;
+      validHeader = false;
+      if (size < sizeof(hdr))
+         return 0;
+
+      memcpy(&hdr, pData, sizeof(hdr));
+      if (memcmp(hdr.magic, cs_journalMagic, sizeof(hdr.magic)) || (hdr.version != cs_journalVersion) || (hdr.recordSize != sizeof(JournalRecord)))
+         return 0;
+      validHeader = true;
+
+      uint64_t count = 0;
+      for (uint64_t offset = sizeof(hdr); offset + sizeof(JournalRecord) <= size; offset += sizeof(JournalRecord), ++count)
+      {
+         JournalRecord rec;
+         memcpy(&rec, pData + offset, sizeof(rec));
+         if (rec.crc != JournalCrc(rec))
+            break;
+         if (pRecords)
+            pRecords->push_back(rec);
+      }
+      return count;
+   }
+
+   // lap of a Lap record, nullptr if the index is out of range
+   TimingLap* s_Lap(TimingDriver& driver, unsigned index)
+   {
+      if (index == cs_journalFastestLap)
+         return &driver.fastestLapData;
+      return (index < cs_timingMaxLaps) ? &driver.laps[index] : nullptr;
+   }
+}
+
+JournalRecord JournalSession(uint64_t sessionUID, float connectTime)
+{
+   JournalRecord rec = s_Record(JournalKind::Session, cs_journalSessionCar, 0, 0);
+   memcpy(rec.data, &sessionUID, sizeof(sessionUID));
+   memcpy(rec.data + sizeof(sessionUID), &connectTime, sizeof(connectTime));
+   return rec;
+}
+
+JournalRecord JournalLap(uint8_t car, uint16_t index, const TimingLap& lap)
+{
+   JournalRecord rec = s_Record(JournalKind::Lap, car, index, lap.invalid ? 1 : 0);
+   const double times[4] = { lap.sector1, lap.sector2, lap.lap, lap.lapsAccumulated };
+   memcpy(rec.data, times, sizeof(times));
+   return rec;
+}
+
+JournalRecord JournalValue(JournalKind kind, uint8_t car, uint16_t index, int32_t value)
+{
+   return s_Record(kind, car, index, value);
+}
+
+JournalRecord JournalEvent(uint16_t index, const TimingEvent& e)
+{
+   JournalRecord rec = s_Record(JournalKind::Event, cs_journalSessionCar, index, 0);
+   memcpy(rec.data, &e, sizeof(e));
+   return rec;
+}
+
+uint32_t JournalCrc(const JournalRecord& rec)
+{
+   const uint8_t* p = reinterpret_cast<const uint8_t*>(&rec) + sizeof(rec.crc);
+   uint32_t crc = 0xFFFFFFFFu;
+   for (size_t i = 0; i < sizeof(rec) - sizeof(rec.crc); ++i)
+      crc = s_crcTable.table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+   return crc ^ 0xFFFFFFFFu;
+}
+
+bool LoadJournal(const std::filesystem::path& path, std::vector<JournalRecord>& records)
+{
+   records.clear();
+
+   F1MappedFile file;
+   if (!file.Open(path))
+      return false;
+
+   bool validHeader = false;
+   file.Prefetch(0, file.Size());
+   records.reserve(static_cast<size_t>(file.Size() / sizeof(JournalRecord)));
+   s_ValidRecords(file.Data(), file.Size(), validHeader, &records);
+   return validHeader;
+}
+
+uint64_t RestoreTimingModel(const std::vector<JournalRecord>& records, F1TimingModel& model)
+{
+   uint64_t sessionUID = 0;
+   float connectTime = 0;
+   model.Clear();
+
+   for (const JournalRecord& rec : records)
+   {
+      if (rec.kind == JournalKind::Session)
+      {
+         model.Clear();
+         memcpy(&sessionUID, rec.data, sizeof(sessionUID));
+         memcpy(&connectTime, rec.data + sizeof(sessionUID), sizeof(connectTime));
+         continue;
+      }
+
+      if (rec.kind == JournalKind::Event)
+      {
+         if (rec.index >= model.events.size())
+            model.events.resize(rec.index + 1);
+         TimingEvent& e = model.events[rec.index];
+         memcpy(&e, rec.data, sizeof(e));
+         if (!memcmp(e.code, "SEND", 4))
+            model.session.finished = true;
+         continue;
+      }
+
+      if (rec.kind == JournalKind::EventServed)
+      {
+         if (rec.index < model.events.size())
+            model.events[rec.index].penaltyServed = (rec.value != 0);
+         continue;
+      }
+
+      if (rec.car >= model.drivers.size())
+         continue;
+
+      TimingDriver& driver = model.drivers[rec.car];
+      driver.present = true;
+
+      switch (rec.kind)
+      {
+      case JournalKind::Lap:
+         if (TimingLap* pLap = s_Lap(driver, rec.index))
+         {
+            double times[4];
+            memcpy(times, rec.data, sizeof(times));
+            pLap->sector1 = times[0];
+            pLap->sector2 = times[1];
+            pLap->lap = times[2];
+            pLap->lapsAccumulated = times[3];
+            pLap->invalid = (rec.value != 0);
+         }
+         break;
+
+      case JournalKind::LapPosition:
+         driver.lapNr = rec.value;
+         if (rec.index < cs_timingMaxLaps)
+            driver.currentLap = rec.index;
+         break;
+
+      case JournalKind::Status:
+         driver.status = static_cast<TimingDriverStatus>(rec.value);
+         break;
+
+      case JournalKind::Penalty:
+         driver.penaltySeconds = rec.value;
+         break;
+
+      case JournalKind::Tyre:
+         if (rec.index >= driver.visualTyres.size())
+            driver.visualTyres.resize(rec.index + 1);
+         driver.visualTyres[rec.index] = static_cast<uint8_t>(rec.value);
+         break;
+
+      default:
+         break;
+      }
+   }
+
+   // the pit penalties refer to the events
+   for (uint32_t i = 0; i < model.events.size(); ++i)
+   {
+      const TimingEvent& e = model.events[i];
+      if (memcmp(e.code, "PENA", 4) || (e.carIndex >= model.drivers.size()))
+         continue;
+
+      for (uint8_t type : cs_pitPenalties)
+      {
+         if (e.penaltyType == type)
+            model.drivers[e.carIndex].pitPenalties.push_back(i);
+      }
+   }
+
+   if (sessionUID)
+      model.ContinueSession(sessionUID, connectTime);
+   return sessionUID;
+}
+
+void SnapshotTimingModel(const F1TimingModel& model, std::vector<JournalRecord>& records)
+{
+   const auto append = [&records](JournalRecord rec)
+   {
+      rec.crc = JournalCrc(rec);
+      records.push_back(rec);
+   };
+
+   if (!model.SessionUID())
+      return;
+
+   append(JournalSession(model.SessionUID(), model.SessionConnectTime()));
+   for (unsigned i = 0; i < model.drivers.size(); ++i)
+   {
+      const TimingDriver& driver = model.drivers[i];
+      if (!driver.present)
+         continue;
+
+      const uint8_t car = static_cast<uint8_t>(i);
+      for (unsigned k = 0; k < cs_timingMaxLaps; ++k)
+      {
+         if (!s_SameLap(driver.laps[k], TimingLap{}))
+            append(JournalLap(car, static_cast<uint16_t>(k), driver.laps[k]));
+      }
+      append(JournalLap(car, cs_journalFastestLap, driver.FastestLap()));
+      append(JournalValue(JournalKind::LapPosition, car, static_cast<uint16_t>(driver.currentLap), driver.lapNr));
+      append(JournalValue(JournalKind::Status, car, 0, static_cast<int32_t>(driver.status)));
+      append(JournalValue(JournalKind::Penalty, car, 0, driver.penaltySeconds));
+      for (unsigned k = 0; (k < driver.visualTyres.size()) && (k <= 0xFFFF); ++k)
+         append(JournalValue(JournalKind::Tyre, car, static_cast<uint16_t>(k), driver.visualTyres[k]));
+   }
+
+   // the event record holds penaltyServed as well
+   for (unsigned i = 0; (i < model.events.size()) && (i <= 0xFFFF); ++i)
+      append(JournalEvent(static_cast<uint16_t>(i), model.events[i]));
+}
+
+bool F1JournalWriter::Append(const JournalRecord& rec)
+{
+   if (!IsOpen())
+      return false;
+   return m_queue.Push(reinterpret_cast<const uint8_t*>(&rec), sizeof(rec));
+}
+
+unsigned F1JournalWriter::Flush()
+{
+   if (!IsOpen())
+      return 0;
+
+   DatagramDesc descs[64];
+   bool truncate = false;
+   m_buffer.clear();
+
+   while (unsigned cnt = m_queue.Peek(descs, 64))
+   {
+      for (unsigned i = 0; i < cnt; ++i)
+      {
+         JournalRecord rec;
+         if (descs[i].len != sizeof(rec))
+            continue;
+         memcpy(&rec, descs[i].pData, sizeof(rec));
+
+         // a new session: the records queued before belong to the old one
+         if (rec.kind == JournalKind::Session)
+         {
+            truncate = true;
+            m_buffer.clear();
+         }
+
+         rec.crc = JournalCrc(rec);
+         m_buffer.insert(m_buffer.end(), reinterpret_cast<const uint8_t*>(&rec), reinterpret_cast<const uint8_t*>(&rec) + sizeof(rec));
+      }
+      m_queue.Release();
+   }
+
+   if (truncate)
+   {
+      if (!m_Truncate(sizeof(JournalFileHeader)))
+         ++m_errors;
+      m_records = 0;
+   }
+
+   if (m_buffer.empty())
+      return 0;
+
+   const unsigned cnt = static_cast<unsigned>(m_buffer.size() / sizeof(JournalRecord));
+   if (!m_Write(m_buffer.data(), m_buffer.size()) || !m_Sync())
+   {
+      ++m_errors;
+      return 0;
+   }
+
+   ++m_syncs;
+   m_records += cnt;
+   return cnt;
+}
+
+#ifdef _WIN32
+
+bool F1JournalWriter::Open(const std::filesystem::path& path)
+{
+   Close();
+
+   uint64_t validRecords = 0;
+   bool validHeader = false;
+   {
+      F1MappedFile existing;
+      if (existing.Open(path))
+         validRecords = s_ValidRecords(existing.Data(), existing.Size(), validHeader, nullptr);
+   }
+
+   HANDLE hFile = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (hFile == INVALID_HANDLE_VALUE)
+      return false;
+   m_hFile = hFile;
+   m_records = validRecords;
+
+   if (!validHeader)
+   {
+      JournalFileHeader hdr{};
+      memcpy(hdr.magic, cs_journalMagic, sizeof(hdr.magic));
+      hdr.version = cs_journalVersion;
+      hdr.recordSize = sizeof(JournalRecord);
+      hdr.createdNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+      if (!m_Truncate(0) || !m_Write(&hdr, sizeof(hdr)) || !m_Sync())
+      {
+         Close();
+         return false;
+      }
+      return true;
+   }
+
+   // cut off a torn record
+   if (!m_Truncate(sizeof(JournalFileHeader) + validRecords * sizeof(JournalRecord)))
+   {
+      Close();
+      return false;
+   }
+   return true;
+}
+
+void F1JournalWriter::Close()
+{
+   if (!m_hFile)
+      return;
+
+   Flush();
+   CloseHandle(m_hFile);
+   m_hFile = nullptr;
+}
+
+bool F1JournalWriter::IsOpen() const
+{
+   return m_hFile != nullptr;
+}
+
+bool F1JournalWriter::m_Write(const void* pData, size_t len)
+{
+   const uint8_t* p = static_cast<const uint8_t*>(pData);
+   while (len)
+   {
+      DWORD written = 0;
+      const DWORD chunk = (len > 0x40000000) ? 0x40000000 : static_cast<DWORD>(len);
+      if (!WriteFile(m_hFile, p, chunk, &written, nullptr) || !written)
+         return false;
+      p += written;
+      len -= written;
+   }
+   return true;
+}
+
+bool F1JournalWriter::m_Truncate(uint64_t size)
+{
+   LARGE_INTEGER pos;
+   pos.QuadPart = static_cast<LONGLONG>(size);
+   return SetFilePointerEx(m_hFile, pos, nullptr, FILE_BEGIN) && SetEndOfFile(m_hFile);
+}
+
+bool F1JournalWriter::m_Sync()
+{
+   return FlushFileBuffers(m_hFile) != 0;
+}
+
+#else
+
+bool F1JournalWriter::Open(const std::filesystem::path& path)
+{
+   Close();
+
+   uint64_t validRecords = 0;
+   bool validHeader = false;
+   {
+      F1MappedFile existing;
+      if (existing.Open(path))
+         validRecords = s_ValidRecords(existing.Data(), existing.Size(), validHeader, nullptr);
+   }
+
+   m_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+   if (m_fd < 0)
+      return false;
+   m_records = validRecords;
+
+   if (!validHeader)
+   {
+      JournalFileHeader hdr{};
+      memcpy(hdr.magic, cs_journalMagic, sizeof(hdr.magic));
+      hdr.version = cs_journalVersion;
+      hdr.recordSize = sizeof(JournalRecord);
+      hdr.createdNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+      if (!m_Truncate(0) || !m_Write(&hdr, sizeof(hdr)) || !m_Sync())
+      {
+         Close();
+         return false;
+      }
+      return true;
+   }
+
+   // cut off a torn record
+   if (!m_Truncate(sizeof(JournalFileHeader) + validRecords * sizeof(JournalRecord)))
+   {
+      Close();
+      return false;
+   }
+   return true;
+}
+
+void F1JournalWriter::Close()
+{
+   if (m_fd < 0)
+      return;
+
+   Flush();
+   close(m_fd);
+   m_fd = -1;
+}
+
+bool F1JournalWriter::IsOpen() const
+{
+   return m_fd >= 0;
+}
+
+bool F1JournalWriter::m_Write(const void* pData, size_t len)
+{
+   const uint8_t* p = static_cast<const uint8_t*>(pData);
+   while (len)
+   {
+      const ssize_t written = write(m_fd, p, len);
+      if (written <= 0)
+         return false;
+      p += written;
+      len -= static_cast<size_t>(written);
+   }
+   return true;
+}
+
+bool F1JournalWriter::m_Truncate(uint64_t size)
+{
+   return (ftruncate(m_fd, static_cast<off_t>(size)) == 0) && (lseek(m_fd, static_cast<off_t>(size), SEEK_SET) >= 0);
+}
+
+bool F1JournalWriter::m_Sync()
+{
+   return fdatasync(m_fd) == 0;
+}
+
+#endif
+
+bool F1JournalRecorder::m_Append(const JournalRecord& rec)
+{
+   return m_sessionUID && m_writer.Append(rec);
+}
+
+void F1JournalRecorder::Reset(uint64_t sessionUID, float connectTime)
+{
+   m_sessionUID = sessionUID;
+   for (unsigned i = 0; i < m_drivers.size(); ++i)
+      m_drivers[i].Reset(i);
+   m_events.clear();
+
+   // without the session record the journal would mix two sessions: the recorder stays idle
+   if (!m_Append(JournalSession(sessionUID, connectTime)))
+      m_sessionUID = 0;
+}
+
+void F1JournalRecorder::Prime(const F1TimingModel& model, uint64_t sessionUID)
+{
+   m_sessionUID = sessionUID;
+   m_drivers = model.drivers;
+   m_events = model.events;
+}
+
+void F1JournalRecorder::Lap(unsigned car, unsigned index, const TimingLap& lap)
+{
+   if (car >= m_drivers.size())
+      return;
+
+   TimingLap* pShadow = s_Lap(m_drivers[car], index);
+   if (pShadow && !s_SameLap(*pShadow, lap) && m_Append(JournalLap(static_cast<uint8_t>(car), static_cast<uint16_t>(index), lap)))
+      *pShadow = lap;
+}
+
+void F1JournalRecorder::LapPosition(unsigned car, int lapNr, unsigned currentLap)
+{
+   if ((car >= m_drivers.size()) || (currentLap >= cs_timingMaxLaps))
+      return;
+
+   TimingDriver& shadow = m_drivers[car];
+   if (((shadow.lapNr != lapNr) || (shadow.currentLap != currentLap)) &&
+      m_Append(JournalValue(JournalKind::LapPosition, static_cast<uint8_t>(car), static_cast<uint16_t>(currentLap), lapNr)))
+   {
+      shadow.lapNr = lapNr;
+      shadow.currentLap = currentLap;
+   }
+}
+
+void F1JournalRecorder::Status(unsigned car, TimingDriverStatus status)
+{
+   if ((car < m_drivers.size()) && (m_drivers[car].status != status) &&
+      m_Append(JournalValue(JournalKind::Status, static_cast<uint8_t>(car), 0, static_cast<int32_t>(status))))
+      m_drivers[car].status = status;
+}
+
+void F1JournalRecorder::PenaltySeconds(unsigned car, int seconds)
+{
+   if ((car < m_drivers.size()) && (m_drivers[car].penaltySeconds != seconds) &&
+      m_Append(JournalValue(JournalKind::Penalty, static_cast<uint8_t>(car), 0, seconds)))
+      m_drivers[car].penaltySeconds = seconds;
+}
+
+void F1JournalRecorder::Tyre(unsigned car, unsigned stint, uint8_t visualTyre)
+{
+   if ((car >= m_drivers.size()) || (stint > 0xFFFF))
+      return;
+
+   std::vector<uint8_t>& tyres = m_drivers[car].visualTyres;
+   if (((stint >= tyres.size()) || (tyres[stint] != visualTyre)) &&
+      m_Append(JournalValue(JournalKind::Tyre, static_cast<uint8_t>(car), static_cast<uint16_t>(stint), visualTyre)))
+   {
+      if (stint >= tyres.size())
+         tyres.resize(stint + 1);
+      tyres[stint] = visualTyre;
+   }
+}
+
+void F1JournalRecorder::Event(unsigned index, const TimingEvent& e)
+{
+   if (index > 0xFFFF)
+      return;
+
+   if ((index < m_events.size()) && s_SameEvent(m_events[index], e))
+   {
+      EventServed(index, e.penaltyServed);
+      return;
+   }
+
+   if (m_Append(JournalEvent(static_cast<uint16_t>(index), e)))
+   {
+      if (index >= m_events.size())
+         m_events.resize(index + 1);
+      m_events[index] = e;
+   }
+}
+
+void F1JournalRecorder::EventServed(unsigned index, bool served)
+{
+   if ((index < m_events.size()) && (m_events[index].penaltyServed != served) &&
+      m_Append(JournalValue(JournalKind::EventServed, cs_journalSessionCar, static_cast<uint16_t>(index), served ? 1 : 0)))
+      m_events[index].penaltyServed = served;
+}
+
+void F1JournalRecorder::Record(const F1TimingModel& model, uint64_t sessionUID, float sessionTime)
+{
+   if (!sessionUID)
+      return;
+
+   // new session, or the session was started again ("SSTA" clears the events)
+   if ((sessionUID != m_sessionUID) || (model.events.size() < m_events.size()))
+      Reset(sessionUID, sessionTime);
+
+   for (unsigned i = 0; i < model.drivers.size(); ++i)
+   {
+      const TimingDriver& driver = model.drivers[i];
+      for (unsigned k = 0; k < cs_timingMaxLaps; ++k)
+         Lap(i, k, driver.laps[k]);
+      Lap(i, cs_journalFastestLap, driver.FastestLap());
+      LapPosition(i, driver.lapNr, driver.currentLap);
+      Status(i, driver.status);
+      PenaltySeconds(i, driver.penaltySeconds);
+      for (unsigned k = 0; k < driver.visualTyres.size(); ++k)
+         Tyre(i, k, driver.visualTyres[k]);
+   }
+
+   for (unsigned i = 0; i < model.events.size(); ++i)
+      Event(i, model.events[i]);
+}
@@ -0,0 +1,164 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <filesystem>
+#include <vector>
+#include "F1SpscRing.h"
+#include "F1TimingModel.h"
+
+// Write ahead journal of the decoded timing state of the current session (laps, sectors, lap position, driver
+// status, penalties, tyre stints, events), so the state is rebuilt after a crash or restart of the program
+// instead of being lost for the rest of the session. All values little endian:
+//   JournalFileHeader
+//   JournalRecord, fixed size, each with a CRC-32. A torn record at the end (crash during a write) and everything
+//   behind it is cut off when the journal is opened again.
+// A Session record starts the journal again, the file is truncated to the header: a journal holds one session.
+// Records are appended by the ingest thread to a queue only (no IO, never blocks), the writer thread writes the
+// queued records and syncs them to disk once per Flush() (group commit).
+// Replaying the records in order (last one wins) gives the state, see RestoreTimingModel().
+
+inline constexpr char cs_journalMagic[8] = { 'K', 'R', 'F', '1', 'J', 'R', 'N', 0 };
+inline constexpr uint32_t cs_journalVersion = 1;
+inline constexpr uint16_t cs_journalFastestLap = 0xFFFF; // Lap record of TimingDriver::fastestLapData
+inline constexpr unsigned cs_journalFlushMs = 100;       // group commit interval of the writer thread
+
+enum class JournalKind : uint8_t
+{
+   Session = 1, // data: sessionUID, session time of the first packet
+   Lap,         // index: lap or cs_journalFastestLap, value: invalid, data: the sector / lap times
+   LapPosition, // index: currentLap, value: lapNr
+   Status,      // value: TimingDriverStatus
+   Penalty,     // value: penaltySeconds
+   Tyre,        // index: stint, value: visual tyre compound
+   Event,       // index: number of the event, data: TimingEvent
+   EventServed  // index: number of the event, value: penaltyServed
+};
+
+#pragma pack(push, 1)
+
+struct JournalFileHeader
+{
+   char magic[8];       // cs_journalMagic
+   uint32_t version;    // cs_journalVersion
+   uint32_t recordSize; // sizeof(JournalRecord)
+   uint64_t createdNs;  // system clock, ns since 1970
+};
+
+struct JournalRecord
+{
+   uint32_t crc;  // CRC-32 of the bytes behind it
+   JournalKind kind;
+   uint8_t car;   // 255 for records of the session
+   uint16_t index;
+   int32_t value;
+   uint32_t reserved;
+   uint8_t data[32];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(JournalFileHeader) == 24);
+static_assert(sizeof(JournalRecord) == 48);
+static_assert(sizeof(TimingEvent) <= sizeof(JournalRecord::data));
+
+JournalRecord JournalSession(uint64_t sessionUID, float connectTime);
+JournalRecord JournalLap(uint8_t car, uint16_t index, const TimingLap& lap);
+JournalRecord JournalValue(JournalKind kind, uint8_t car, uint16_t index, int32_t value);
+JournalRecord JournalEvent(uint16_t index, const TimingEvent& e);
+
+uint32_t JournalCrc(const JournalRecord& rec);
+
+// the valid records of a journal, false if the file does not exist or is no journal
+bool LoadJournal(const std::filesystem::path& path, std::vector<JournalRecord>& records);
+
+// state of the records in model (cleared before), returns the session UID, 0 if there is no session.
+// The model continues the session with the next packet of it instead of clearing it.
+uint64_t RestoreTimingModel(const std::vector<JournalRecord>& records, F1TimingModel& model);
+
+// the records of the state of model (appended, with CRC), RestoreTimingModel() of them gives the state again
+void SnapshotTimingModel(const F1TimingModel& model, std::vector<JournalRecord>& records);
+
+// Append() by one ingest thread, Flush() by one writer thread. Open() / Close() while neither of them runs.
+class F1JournalWriter
+{
+public:
+   explicit F1JournalWriter(size_t queueBytes = 1024 * 1024) : m_queue(queueBytes) {}
+   ~F1JournalWriter() { Close(); }
+   F1JournalWriter(const F1JournalWriter&) = delete;
+   F1JournalWriter& operator=(const F1JournalWriter&) = delete;
+
+   // opens or creates the journal, the valid records of an existing one are kept (e.g. read by LoadJournal() before)
+   bool Open(const std::filesystem::path& path);
+
+   // flushes the queued records
+   void Close();
+
+   bool IsOpen() const;
+
+   // queue a record, false if the journal is not open or the queue is full (nothing is written then)
+   bool Append(const JournalRecord& rec);
+
+   // write the queued records and sync them to disk, returns the number of records written
+   unsigned Flush();
+
+   uint64_t Records() const { return m_records; } // in the file
+   uint64_t Syncs() const { return m_syncs; }
+   uint64_t Errors() const { return m_errors; }
+   F1SpscRingStats QueueStats() const { return m_queue.Stats(); }
+
+private:
+   bool m_Write(const void* pData, size_t len);
+   bool m_Truncate(uint64_t size);
+   bool m_Sync();
+
+   F1SpscRing m_queue;
+   std::vector<uint8_t> m_buffer;
+   uint64_t m_records{ 0 };
+   uint64_t m_syncs{ 0 };
+   uint64_t m_errors{ 0 };
+#ifdef _WIN32
+   void* m_hFile{ nullptr };
+#else
+   int m_fd{ -1 };
+#endif
+};
+
+// Appends the changes of the timing state to the journal, on the ingest thread.
+// The recorder keeps the last appended values, so every change is appended once. A record which did not fit into
+// the queue is not taken as appended and is tried again with the next call.
+class F1JournalRecorder
+{
+public:
+   explicit F1JournalRecorder(F1JournalWriter& writer) : m_writer(writer) {}
+
+   // new session (or restart of it), starts the journal again
+   void Reset(uint64_t sessionUID, float connectTime);
+
+   // continue with the state restored from the journal, nothing is appended for it
+   void Prime(const F1TimingModel& model, uint64_t sessionUID);
+
+   uint64_t SessionUID() const { return m_sessionUID; }
+   unsigned CurrentLap(unsigned car) const { return m_drivers[car].currentLap; } // of the last LapPosition()
+
+   void Lap(unsigned car, unsigned index, const TimingLap& lap); // index: lap or cs_journalFastestLap
+   void LapPosition(unsigned car, int lapNr, unsigned currentLap);
+   void Status(unsigned car, TimingDriverStatus status);
+   void PenaltySeconds(unsigned car, int seconds);
+   void Tyre(unsigned car, unsigned stint, uint8_t visualTyre);
+   void Event(unsigned index, const TimingEvent& e);
+   void EventServed(unsigned index, bool served);
+
+   // all of the above for the native model, compares the whole state: call it once per frame or batch, not per packet
+   void Record(const F1TimingModel& model, uint64_t sessionUID, float sessionTime);
+
+private:
+   bool m_Append(const JournalRecord& rec);
+
+   F1JournalWriter& m_writer;
+   uint64_t m_sessionUID{ 0 };
+   std::array<TimingDriver, cs_maxNumCarsInUDPData> m_drivers;
+   std::vector<TimingEvent> m_events;
+};
@@ -0,0 +1,25 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1LapStore.h"
+
+#include <algorithm>
+
+void F1LapStore::Clear()
+{
+   m_sector1.fill(0.0);
+   m_sector2.fill(0.0);
+   m_lap.fill(0.0);
+   m_lapsAccumulated.fill(0.0);
+   m_invalid.fill(0);
+}
+
+void F1LapStore::ClearCar(unsigned car)
+{
+   const unsigned first = m_Idx(car, 0);
+   std::fill_n(&m_sector1[first], cs_lapStoreSlots, 0.0);
+   std::fill_n(&m_sector2[first], cs_lapStoreSlots, 0.0);
+   std::fill_n(&m_lap[first], cs_lapStoreSlots, 0.0);
+   std::fill_n(&m_lapsAccumulated[first], cs_lapStoreSlots, 0.0);
+   std::fill_n(&m_invalid[first], cs_lapStoreSlots, uint8_t{ 0 });
+}
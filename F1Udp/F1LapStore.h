@@ -0,0 +1,45 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <array>
+#include "F1DataDefs.h"
+#include "F1TimingTable.h"
+
+inline constexpr unsigned cs_lapStoreFastest = cs_timingMaxLaps;    // slot of the fastest lap record of a car
+inline constexpr unsigned cs_lapStoreSlots = cs_timingMaxLaps + 1;
+
+// Lap and sector times of all cars, owned natively instead of by one managed object per lap. One contiguous array
+// per field, [car][slot]: a slot is a lap index or cs_lapStoreFastest. Times in seconds, 0 while not set.
+// The managed LapData objects are views into it (F1DataDefsClr.h).
+class F1LapStore
+{
+public:
+   F1LapStore() { Clear(); }
+
+   void Clear();
+   void ClearCar(unsigned car);
+
+   double& Sector1(unsigned car, unsigned slot) { return m_sector1[m_Idx(car, slot)]; }
+   double& Sector2(unsigned car, unsigned slot) { return m_sector2[m_Idx(car, slot)]; }
+   double& Lap(unsigned car, unsigned slot) { return m_lap[m_Idx(car, slot)]; }
+   double& LapsAccumulated(unsigned car, unsigned slot) { return m_lapsAccumulated[m_Idx(car, slot)]; }
+   double Sector1(unsigned car, unsigned slot) const { return m_sector1[m_Idx(car, slot)]; }
+   double Sector2(unsigned car, unsigned slot) const { return m_sector2[m_Idx(car, slot)]; }
+   double Lap(unsigned car, unsigned slot) const { return m_lap[m_Idx(car, slot)]; }
+   double LapsAccumulated(unsigned car, unsigned slot) const { return m_lapsAccumulated[m_Idx(car, slot)]; }
+
+   bool Invalid(unsigned car, unsigned slot) const { return m_invalid[m_Idx(car, slot)] != 0; }
+   void SetInvalid(unsigned car, unsigned slot, bool invalid) { m_invalid[m_Idx(car, slot)] = invalid ? 1 : 0; }
+
+private:
+   static unsigned m_Idx(unsigned car, unsigned slot) { return car * cs_lapStoreSlots + slot; }
+
+   static constexpr unsigned cs_size = cs_maxNumCarsInUDPData * cs_lapStoreSlots;
+   std::array<double, cs_size> m_sector1;
+   std::array<double, cs_size> m_sector2;
+   std::array<double, cs_size> m_lap;
+   std::array<double, cs_size> m_lapsAccumulated;
+   std::array<uint8_t, cs_size> m_invalid;
+};
@@ -0,0 +1,126 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool F1MappedFile::Open(const std::filesystem::path& path)
+{
+   Close();
+
+   HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+   if (hFile == INVALID_HANDLE_VALUE)
+      return false;
+   m_hFile = hFile;
+
+   LARGE_INTEGER size;
+   if (!GetFileSizeEx(hFile, &size) || !size.QuadPart || (static_cast<uint64_t>(size.QuadPart) > SIZE_MAX))
+   {
+      Close();
+      return false;
+   }
+   m_size = static_cast<uint64_t>(size.QuadPart);
+
+   m_hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (!m_hMapping)
+   {
+      Close();
+      return false;
+   }
+
+   m_pData = static_cast<const uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+   if (!m_pData)
+   {
+      Close();
+      return false;
+   }
+   return true;
+}
+
+void F1MappedFile::Close()
+{
+   if (m_pData)
+      UnmapViewOfFile(m_pData);
+   if (m_hMapping)
+      CloseHandle(m_hMapping);
+   if (m_hFile)
+      CloseHandle(m_hFile);
+
+   m_pData = nullptr;
+   m_hMapping = nullptr;
+   m_hFile = nullptr;
+   m_size = 0;
+}
+
+void F1MappedFile::Prefetch(uint64_t offset, uint64_t len) const
+{
+   if (!m_pData || (offset >= m_size))
+      return;
+
+   WIN32_MEMORY_RANGE_ENTRY range;
+   range.VirtualAddress = const_cast<uint8_t*>(m_pData + offset);
+   range.NumberOfBytes = static_cast<SIZE_T>((len < m_size - offset) ? len : m_size - offset);
+   PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool F1MappedFile::Open(const std::filesystem::path& path)
+{
+   Close();
+
+   int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+   if (fd < 0)
+      return false;
+
+   struct stat st;
+   if ((fstat(fd, &st) != 0) || (st.st_size <= 0))
+   {
+      close(fd);
+      return false;
+   }
+
+   // the mapping stays valid after the descriptor is closed
+   void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if (p == MAP_FAILED)
+      return false;
+
+   m_pData = static_cast<const uint8_t*>(p);
+   m_size = static_cast<uint64_t>(st.st_size);
+   madvise(p, static_cast<size_t>(m_size), MADV_RANDOM); // seeks jump around, Prefetch() reads ahead where needed
+   return true;
+}
+
+void F1MappedFile::Close()
+{
+   if (m_pData)
+      munmap(const_cast<uint8_t*>(m_pData), static_cast<size_t>(m_size));
+
+   m_pData = nullptr;
+   m_size = 0;
+}
+
+void F1MappedFile::Prefetch(uint64_t offset, uint64_t len) const
+{
+   if (!m_pData || (offset >= m_size))
+      return;
+
+   // madvise needs a page aligned start
+   const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+   const uint64_t begin = offset & ~(page - 1);
+   const uint64_t end = (len < m_size - offset) ? offset + len : m_size;
+   madvise(const_cast<uint8_t*>(m_pData + begin), static_cast<size_t>(end - begin), MADV_WILLNEED);
+}
+
+#endif
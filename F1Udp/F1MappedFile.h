@@ -0,0 +1,36 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file.
+// Large files need a 64 bit process, in a 32 bit process the mapping of a multi GB file fails.
+class F1MappedFile
+{
+public:
+   F1MappedFile() = default;
+   ~F1MappedFile() { Close(); }
+   F1MappedFile(const F1MappedFile&) = delete;
+   F1MappedFile& operator=(const F1MappedFile&) = delete;
+
+   bool Open(const std::filesystem::path& path);
+   void Close();
+
+   bool IsOpen() const { return m_pData != nullptr; }
+   const uint8_t* Data() const { return m_pData; }
+   uint64_t Size() const { return m_size; }
+
+   // hint that the range is read soon / sequentially
+   void Prefetch(uint64_t offset, uint64_t len) const;
+
+private:
+   const uint8_t* m_pData{ nullptr };
+   uint64_t m_size{ 0 };
+#ifdef _WIN32
+   void* m_hFile{ nullptr };
+   void* m_hMapping{ nullptr };
+#endif
+};
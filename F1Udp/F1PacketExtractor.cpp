@@ -2,31 +2,54 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "F1PacketExtractor.h"
+#include "F1PacketRegistry.h"
+#include "F1PacketFormats.h"
 
 #include <fstream>
+#include <iterator>
 #include <type_traits>
 
 unsigned F12025_PacketExtractor::ProceedPacket(const uint8_t* pData, unsigned len, PacketType* pType)
 {
-   if (len < sizeof(PacketHeader))
+   PacketResult res;
+   len = m_Proceed(pData, len, res);
+   if (pType)
+      *pType = res.type;
+
+   return len;
+}
+
+unsigned F12025_PacketExtractor::ProceedBatch(const DatagramDesc* pDatagrams, unsigned count, PacketResult* pResults)
+{
+   return ProceedBatch(pDatagrams, count, pResults, [](const PacketRef&, const PacketResult&, const DatagramDesc&) {});
+}
+
+unsigned F12025_PacketExtractor::m_Proceed(const uint8_t* pData, unsigned len, PacketResult& result)
+{
+   if (!pData || (len < sizeof(PacketHeader)))
       return len;
 
-   PacketType type = PacketType::UnknownOrIllformed;
-   if (pType)
-      *pType = type;
+   lastPacket = PacketRef();
 
    memcpy(&lastHeader, pData, sizeof(PacketHeader));
-   if ((lastHeader.m_packetFormat != 2025) || (lastHeader.m_packetVersion != 1)) // m_packetversion refers probably to each individual packet type, for now they should all be "1"
+   // no format selected yet: m_format 0 must not match a datagram with m_packetFormat 0
+   if (((lastHeader.m_packetFormat != m_format) || !m_pDispatch) && !m_SelectFormat(lastHeader.m_packetFormat))
+      return len;
+
+   if (lastHeader.m_packetVersion != 1) // m_packetversion refers probably to each individual packet type, for now they should all be "1"
       return len;
 
-   if (sessionUID != lastHeader.m_sessionUID)
+   return m_ProceedChecked(pData, len, (lastHeader.m_sessionUID != 0) && (sessionUID != lastHeader.m_sessionUID), result);
+}
+
+unsigned F12025_PacketExtractor::m_ProceedChecked(const uint8_t* pData, unsigned len, bool sessionChanged, PacketResult& result)
+{
+   if (sessionChanged)
    {
-      if (lastHeader.m_sessionUID != 0)
-      {
-         auto hdr = lastHeader;
-         *this = F12025_PacketExtractor();
-         lastHeader = hdr;
-      }
+      auto hdr = lastHeader;
+      Reset();
+      lastHeader = hdr;
+      result.flags |= PacketResult::SessionChanged;
    }
 
    if (lastHeader.m_sessionUID)
@@ -35,166 +58,250 @@ unsigned F12025_PacketExtractor::ProceedPacket(const uint8_t* pData, unsigned le
       sessionTime = lastHeader.m_sessionTime;
    }
 
-   switch (lastHeader.m_packetId)
+   const DispatchEntry& entry = (*m_pDispatch)[lastHeader.m_packetId];
+   if (entry.type == PacketType::UnknownOrIllformed)
+      return len;
+
+   const unsigned wireLen = len;
+   if (entry.decode)
    {
-   case 0:
-      if (CopyBytesToStruct(pData, len, &motion))
-      {
-         type = PacketType::PacketMotionData;
-      }
-      else
+      // older game: continue with the packet decoded to the F1 25 struct
+      if (len < entry.wireSize)
          return len;
-      break;
 
-   case 1:
-      if (CopyBytesToStruct(pData, len, &session))
-      {
-         type = PacketType::PacketSessionData;
-      }
-      else
-         return len;
-      break;
+      entry.decode(pData, m_decoded);
+      pData = m_decoded;
+      len = sizeof(m_decoded);
+   }
 
-   case 2:
-      if (CopyBytesToStruct(pData, len, &lap))
-      {
-         type = PacketType::PacketLapData;
-      }
-      else
-         return len;
-      break;
+   if (!(this->*entry.extract)(pData, len))
+      return wireLen;
 
-   case 3:
-      if (CopyBytesToStruct(pData, len, &event))
-      {
-         // Clear old Data when a new event starts
-         if (!strncmp((const char*)event.m_eventStringCode, "SSTA", 4))
-         {
-            auto eventCpy = this->event;
-            *this = F12025_PacketExtractor();
-            this->event = eventCpy;
-            this->lastHeader = event.m_header;
-         }
-         type = PacketType::PacketEventData;
-      }
-      else
-         return len;
-      break;
+   // Clear old Data when a new event starts (read from the buffer, in view mode the event member is not updated)
+   if ((entry.type == PacketType::PacketEventData) && !strncmp((const char*)pData + offsetof(PacketEventData, m_eventStringCode), "SSTA", 4))
+   {
+      auto hdr = lastHeader;
+      Reset();
+      if (mode == ExtractMode::Copy)
+         event.epoch = m_epoch; // the event itself was just stored, keep it
+      lastHeader = hdr;
+      result.flags |= PacketResult::SessionStarted;
+   }
 
-   case 4:
-      if (CopyBytesToStruct(pData, len, &participants))
-      {
-         type = PacketType::PacketParticipantsData;
-      }
-      else
-         return len;
-      break;
+   result.type = entry.type;
+   result.flags |= PacketResult::Valid;
 
-   case 5:
-      if (CopyBytesToStruct(pData, len, &setups))
-      {
-         type = PacketType::PacketCarSetupData;
-      }
-      else
-         return len;
-      break;
+   lastPacket.type = entry.type;
+   lastPacket.pData = pData;
+   lastPacket.len = len;
 
-   case 6:
-      if (CopyBytesToStruct(pData, len, &telemetry))
-      {
-         type = PacketType::PacketCarTelemetryData;
-      }
-      else
-         return len;
-      break;
+   return entry.decode ? entry.wireSize : len;
+}
 
-   case 7:
-      if (CopyBytesToStruct(pData, len, &status))
-      {
-         type = PacketType::PacketCarStatusData;
-      }
-      else
-         return len;
-      break;
+bool F12025_PacketExtractor::Retain(const PacketRef& ref)
+{
+   if (!ref.pData || (ref.type == PacketType::UnknownOrIllformed))
+      return false;
 
-   case 8:
-      if (CopyBytesToStruct(pData, len, &classification))
-      {
-         type = PacketType::PacketFinalClassificationData;
-      }
-      else
-         return len;
-      break;
+   const DispatchEntry& entry = s_Dispatch(static_cast<uint8_t>(ref.type));
+   if (entry.type != ref.type)
+      return false;
 
-   case 9:
-      if (CopyBytesToStruct(pData, len, &lobby))
+   return (this->*entry.retain)(ref.pData, ref.len);
+}
+
+template<uint16_t FORMAT, typename ENTRY>
+void F12025_PacketExtractor::s_DecodeEntry(const uint8_t* pData, uint8_t* pOut)
+{
+   WireFormat<FORMAT, typename ENTRY::Packet>::Decode(pData, reinterpret_cast<typename ENTRY::Packet*>(pOut));
+}
+
+template<uint16_t FORMAT, typename ENTRY>
+constexpr F12025_PacketExtractor::DispatchEntry F12025_PacketExtractor::s_MakeDispatchEntry()
+{
+   using Wire = WireFormat<FORMAT, typename ENTRY::Packet>;
+   static_assert(Wire::size <= sizeof(m_decoded), "decode buffer too small");
+
+   if constexpr (!Wire::supported)
+      return DispatchEntry();
+   else if constexpr (Wire::native)
+      return DispatchEntry{ ENTRY::packetType, &F12025_PacketExtractor::m_ExtractEntry<ENTRY>, &F12025_PacketExtractor::m_RetainEntry<ENTRY>, Wire::size, nullptr };
+   else
+      return DispatchEntry{ ENTRY::packetType, &F12025_PacketExtractor::m_ExtractEntry<ENTRY>, &F12025_PacketExtractor::m_RetainEntry<ENTRY>, Wire::size, &s_DecodeEntry<FORMAT, ENTRY> };
+}
+
+template<uint16_t FORMAT, typename... ENTRIES>
+constexpr F12025_PacketExtractor::DispatchTable F12025_PacketExtractor::s_MakeDispatchTable(PacketRegistryList<ENTRIES...>)
+{
+   DispatchTable table{};
+   ((table[ENTRIES::id] = s_MakeDispatchEntry<FORMAT, ENTRIES>()), ...);
+   return table;
+}
+
+template<uint16_t FORMAT>
+const F12025_PacketExtractor::DispatchTable& F12025_PacketExtractor::s_DispatchTable()
+{
+   static constexpr DispatchTable s_table = s_MakeDispatchTable<FORMAT>(PacketRegistry{});
+   return s_table;
+}
+
+const F12025_PacketExtractor::DispatchEntry& F12025_PacketExtractor::s_Dispatch(uint8_t packetId)
+{
+   return s_DispatchTable<2025>()[packetId];
+}
+
+bool F12025_PacketExtractor::IsSupportedFormat(uint16_t packetFormat)
+{
+   for (uint16_t format : cs_supportedPacketFormats)
+   {
+      if (format == packetFormat)
+         return true;
+   }
+   return false;
+}
+
+const F12025_PacketExtractor::DispatchTable* F12025_PacketExtractor::s_FormatTable(uint16_t packetFormat)
+{
+   switch (packetFormat)
+   {
+   case 2023:
+      return &s_DispatchTable<2023>();
+
+   case 2024:
+      return &s_DispatchTable<2024>();
+
+   case 2025:
+      return &s_DispatchTable<2025>();
+
+   default:
+      return nullptr;
+   }
+}
+
+bool F12025_PacketExtractor::m_SelectFormat(uint16_t packetFormat)
+{
+   // only when the game changes, the hot path just uses m_pDispatch
+   const DispatchTable* pDispatch = s_FormatTable(packetFormat);
+   if (!pDispatch)
+      return false;
+
+   m_pDispatch = pDispatch;
+   m_format = packetFormat;
+   return true;
+}
+
+namespace
+{
+#pragma pack(push, 1)
+   struct ExtractorStateHeader
+   {
+      uint32_t version;
+      uint16_t format;
+      uint16_t packets;
+      uint64_t sessionUID;
+      float sessionTime;
+      PacketHeader lastHeader;
+   };
+
+   struct ExtractorStatePacket
+   {
+      uint8_t packetId;
+      uint32_t len;
+   };
+#pragma pack(pop)
+
+   constexpr uint32_t cs_extractorStateVersion = 1;
+
+   void s_Append(std::vector<uint8_t>& out, const void* pData, size_t len)
+   {
+      const uint8_t* p = static_cast<const uint8_t*>(pData);
+      out.insert(out.end(), p, p + len);
+   }
+}
+
+void F12025_PacketExtractor::SaveState(std::vector<uint8_t>& out) const
+{
+   const size_t headerPos = out.size();
+   ExtractorStateHeader hdr{};
+   hdr.version = cs_extractorStateVersion;
+   hdr.format = m_format;
+   hdr.sessionUID = sessionUID;
+   hdr.sessionTime = sessionTime;
+   hdr.lastHeader = lastHeader;
+   s_Append(out, &hdr, sizeof(hdr));
+
+   // the slots hold F1 25 structs for all formats
+   for (unsigned id = 0; id <= static_cast<unsigned>(PacketType::PacketLapPositions); ++id)
+   {
+      VisitPacket(*this, static_cast<PacketType>(id), [&](const auto& pkt)
       {
-         type = PacketType::PacketLobbyInfoData;
-      }
-      else
-         return len;
-      break;
+         using PKT_TYPE = std::decay_t<decltype(pkt)>;
+         if (!Has<PKT_TYPE>())
+            return;
+
+         const ExtractorStatePacket rec{ static_cast<uint8_t>(id), static_cast<uint32_t>(sizeof(PKT_TYPE)) };
+         s_Append(out, &rec, sizeof(rec));
+         s_Append(out, &pkt, sizeof(PKT_TYPE));
+         ++hdr.packets;
+      });
+   }
 
-   case 10:
-      if (CopyBytesToStruct(pData, len, &cardamage))
+   memcpy(out.data() + headerPos, &hdr, sizeof(hdr));
+}
+
+bool F12025_PacketExtractor::RestoreState(const uint8_t* pData, size_t len)
+{
+   Reset();
+
+   ExtractorStateHeader hdr;
+   if (!pData || (len < sizeof(hdr)))
+      return false;
+
+   memcpy(&hdr, pData, sizeof(hdr));
+   if ((hdr.version != cs_extractorStateVersion) || (hdr.format && !m_SelectFormat(hdr.format)))
+      return false;
+
+   size_t pos = sizeof(hdr);
+   for (unsigned i = 0; i < hdr.packets; ++i)
+   {
+      ExtractorStatePacket rec;
+      if (len - pos < sizeof(rec))
       {
-         type = PacketType::PacketCarDamageData;
+         Reset();
+         return false;
       }
-      else
-         return len;
-      break;
+      memcpy(&rec, pData + pos, sizeof(rec));
+      pos += sizeof(rec);
 
-   case 11:
-      if (CopyBytesToStruct(pData, len, &history))
+      if ((len - pos < rec.len) || !Retain(PacketRef{ static_cast<PacketType>(rec.packetId), pData + pos, rec.len }))
       {
-         type = PacketType::PacketSessionHistoryData;
+         Reset();
+         return false;
       }
-      else
-         return len;
-      break;
-
-    case 12:
-         if (CopyBytesToStruct(pData, len, &tyreSets))
-         {
-            type = PacketType::PacketTyreSetsData;
-         }
-         else
-            return len;
-         break;
-
-    case 13:
-       if (CopyBytesToStruct(pData, len, &motionEx))
-       {
-          type = PacketType::PacketMotionExData;
-       }
-       else
-          return len;
-       break;
-
-    case 14:
-       if (CopyBytesToStruct(pData, len, &timeTrial))
-       {
-          type = PacketType::PacketTimeTrialData;
-       }
-       else
-          return len;
-       break;
-
-    case 15:
-       if (CopyBytesToStruct(pData, len, &lapPositions))
-       {
-          type = PacketType::PacketLapPositions;
-       }
-       else
-          return len;
-       break;
-
+      pos += rec.len;
    }
 
-   if (pType)
-      *pType = type;
+   sessionUID = hdr.sessionUID;
+   sessionTime = hdr.sessionTime;
+   lastHeader = hdr.lastHeader;
+   return true;
+}
 
-   return len;
+void F12025_PacketExtractor::Reset()
+{
+   // keep the configuration, drop all data by starting a new epoch
+   ++m_epoch;
+   if (!m_epoch)
+   {
+      // wrapped around, make sure no slot of the (very) old epoch 1 becomes valid again
+      ForEachPacketSlot(*this, [](auto& slot) { slot.epoch = 0; });
+      m_epoch = 1;
+   }
+
+   lastPacket = PacketRef();
+   sessionUID = 0;
+   sessionTime = 0;
+   lastHeader = PacketHeader();
 }
 
 const char* IdToTrackName(unsigned i)
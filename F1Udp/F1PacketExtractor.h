@@ -5,34 +5,185 @@
 #include <stdint.h>
 #include <string.h>
 #include <fstream>
+#include <array>
+#include <vector>
 #include "F1DataDefs.h"
+#include "F1HeaderScan.h"
+#include "F1PacketView.h"
+
+enum class ExtractMode
+{
+   Copy, // every accepted packet is copied into the corresponding member (default)
+   View  // only the header is copied, the packet is accessible by lastPacket until Retain() is called
+};
+
+template<typename... ENTRIES>
+struct PacketRegistryList;
+
+// one received datagram, e.g. from a recvmmsg() burst
+struct DatagramDesc
+{
+   const uint8_t* pData{ nullptr };
+   unsigned len{ 0 };
+   uint64_t rxTimestampNs{ 0 }; // receive time, not interpreted by the extractor
+};
+
+// outcome of one datagram of ProceedBatch()
+struct PacketResult
+{
+   enum Flags : uint8_t
+   {
+      Valid = 0x01,          // header and size ok, type is set
+      SessionChanged = 0x02, // new session UID, all data received before this packet was dropped
+      SessionStarted = 0x04  // SSTA event, all data received before this packet was dropped
+   };
+
+   PacketType type{ PacketType::UnknownOrIllformed };
+   uint8_t flags{ 0 };
+
+   bool IsValid() const { return (flags & Valid) != 0; }
+};
+static_assert(sizeof(PacketResult) == 2, "PacketResult is meant to be compact");
+
+// storage for the last packet of one type, tagged with the extractor epoch it was received in.
+// Slots from an older epoch read as empty, so a reset does not need to touch the (large) packet data.
+template<typename PKT_TYPE>
+struct PacketSlot
+{
+   PKT_TYPE data;
+   uint32_t epoch{ 0 }; // 0: never written
+};
 
 struct F12025_PacketExtractor
 {
    unsigned ProceedPacket(const uint8_t* pData, unsigned len, PacketType* pType = nullptr);
 
+   // Proceed count datagrams in order, pResults must hold count entries. Returns the number of valid packets.
+   // onPacket(const PacketRef&, const PacketResult&, const DatagramDesc&) is called right after each valid packet,
+   // while lastPacket still refers to it, so packets can be retained in view mode before the next one resets the session.
+   // The headers are checked per datagram as in ProceedPacket(): a pre-pass with ScanHeaders() (F1HeaderScan.h) costs more
+   // than these few compares, the header has to be read for the packet anyway.
+   unsigned ProceedBatch(const DatagramDesc* pDatagrams, unsigned count, PacketResult* pResults);
+
+   template<typename FUNC>
+   unsigned ProceedBatch(const DatagramDesc* pDatagrams, unsigned count, PacketResult* pResults, FUNC&& onPacket);
+
+   // copy a viewed packet into the corresponding member, so it outlives the receive buffer
+   bool Retain(const PacketRef& ref);
+
+   // last packet of the given type received in this session, a zeroed packet if none was received yet.
+   // (defined in F1PacketRegistry.h)
+   template<typename PKT_TYPE>
+   const PKT_TYPE& Get() const;
+
+   template<typename PKT_TYPE>
+   bool Has() const;
+
+   // let the slot read as empty until the next packet of this type arrives
+   template<typename PKT_TYPE>
+   void Invalidate();
+
+   // drop all session data, O(1)
+   void Reset();
+
+   // append the session data (all valid slots + header state) to out, e.g. for a capture checkpoint
+   void SaveState(std::vector<uint8_t>& out) const;
+
+   // replace the session data by a state of SaveState(), false if the state is malformed (the extractor is reset then)
+   bool RestoreState(const uint8_t* pData, size_t len);
+
+   uint32_t Epoch() const { return m_epoch; }
+
+   // m_packetFormat of the packets received so far (2023, 2024 or 2025), 0 if none yet.
+   // Packets of older games are decoded into the F1 25 structs, see F1PacketFormats.h
+   uint16_t Format() const { return m_format; }
+   static bool IsSupportedFormat(uint16_t packetFormat);
+
+   ExtractMode mode{ ExtractMode::Copy };
+   PacketRef lastPacket{}; // points into the buffer passed to ProceedPacket() (or to the decoded packet of older games), valid in both modes
+
    uint64_t sessionUID{ 0 };
    float sessionTime{0};
    PacketHeader lastHeader{};
-   PacketMotionData motion{};
-   PacketSessionData session{};
-   PacketLapData lap{};
-   PacketEventData event {};
-   PacketParticipantsData participants{};
-   PacketCarSetupData setups{};
-   PacketCarTelemetryData telemetry{};
-   PacketCarStatusData status{};
-   PacketFinalClassificationData classification{};
-   PacketLobbyInfoData lobby{};
-   PacketCarDamageData cardamage{};
-   PacketSessionHistoryData history{};
-   PacketTyreSetsData tyreSets{};
-   PacketMotionExData motionEx{};
-   PacketTimeTrialData timeTrial{};
-   PacketLapPositionsData lapPositions{};
+   PacketSlot<PacketMotionData> motion{};
+   PacketSlot<PacketSessionData> session{};
+   PacketSlot<PacketLapData> lap{};
+   PacketSlot<PacketEventData> event{};
+   PacketSlot<PacketParticipantsData> participants{};
+   PacketSlot<PacketCarSetupData> setups{};
+   PacketSlot<PacketCarTelemetryData> telemetry{};
+   PacketSlot<PacketCarStatusData> status{};
+   PacketSlot<PacketFinalClassificationData> classification{};
+   PacketSlot<PacketLobbyInfoData> lobby{};
+   PacketSlot<PacketCarDamageData> cardamage{};
+   PacketSlot<PacketSessionHistoryData> history{};
+   PacketSlot<PacketTyreSetsData> tyreSets{};
+   PacketSlot<PacketMotionExData> motionEx{};
+   PacketSlot<PacketTimeTrialData> timeTrial{};
+   PacketSlot<PacketLapPositionsData> lapPositions{};
 
    template<typename PKT_TYPE>
    static bool CopyBytesToStruct(const uint8_t* pData, unsigned& len, PKT_TYPE* pPkt);
+
+private:
+   // per m_packetId, generated from PacketRegistry (F1PacketRegistry.h)
+   struct DispatchEntry
+   {
+      PacketType type{ PacketType::UnknownOrIllformed };
+      bool (F12025_PacketExtractor::* extract)(const uint8_t* pData, unsigned& len) { nullptr };
+      bool (F12025_PacketExtractor::* retain)(const uint8_t* pData, unsigned len) { nullptr };
+      unsigned wireSize{ 0 };
+      void (*decode)(const uint8_t* pData, uint8_t* pOut) { nullptr }; // nullptr: wire format is the F1 25 struct
+   };
+
+   using DispatchTable = std::array<DispatchEntry, 256>;
+
+   // one datagram without the pType / return value handling of ProceedPacket(), sets result.flags
+   unsigned m_Proceed(const uint8_t* pData, unsigned len, PacketResult& result);
+
+   // lastHeader is set and checked, continues with the session handling and the packet itself
+   unsigned m_ProceedChecked(const uint8_t* pData, unsigned len, bool sessionChanged, PacketResult& result);
+
+   template<uint16_t FORMAT, typename ENTRY>
+   static constexpr DispatchEntry s_MakeDispatchEntry();
+
+   template<uint16_t FORMAT, typename... ENTRIES>
+   static constexpr DispatchTable s_MakeDispatchTable(PacketRegistryList<ENTRIES...>);
+
+   template<uint16_t FORMAT>
+   static const DispatchTable& s_DispatchTable();
+
+   template<uint16_t FORMAT, typename ENTRY>
+   static void s_DecodeEntry(const uint8_t* pData, uint8_t* pOut);
+
+   // F1 25 table, also used by Retain() as retained packets are always decoded
+   static const DispatchEntry& s_Dispatch(uint8_t packetId);
+
+   // nullptr for an unsupported m_packetFormat
+   static const DispatchTable* s_FormatTable(uint16_t packetFormat);
+
+   bool m_SelectFormat(uint16_t packetFormat);
+
+   template<typename ENTRY>
+   bool m_ExtractEntry(const uint8_t* pData, unsigned& len) { return m_Extract(pData, len, this->*ENTRY::member); }
+
+   template<typename ENTRY>
+   bool m_RetainEntry(const uint8_t* pData, unsigned len) { return m_Store(pData, len, this->*ENTRY::member); }
+
+   template<typename PKT_TYPE>
+   bool m_Extract(const uint8_t* pData, unsigned& len, PacketSlot<PKT_TYPE>& slot);
+
+   template<typename PKT_TYPE>
+   bool m_Store(const uint8_t* pData, unsigned& len, PacketSlot<PKT_TYPE>& slot);
+
+   template<typename PKT_TYPE>
+   inline static const PKT_TYPE s_emptyPacket{};
+
+   uint32_t m_epoch{ 1 };
+
+   uint16_t m_format{ 0 };
+   const DispatchTable* m_pDispatch{ nullptr };
+   alignas(8) uint8_t m_decoded[2048]; // packet of an older game, decoded to the F1 25 struct
 };
 
 
@@ -48,3 +199,48 @@ bool F12025_PacketExtractor::CopyBytesToStruct(const uint8_t* pData, unsigned& l
 
    return false;
 }
+
+template<typename FUNC>
+unsigned F12025_PacketExtractor::ProceedBatch(const DatagramDesc* pDatagrams, unsigned count, PacketResult* pResults, FUNC&& onPacket)
+{
+   unsigned valid = 0;
+   for (unsigned i = 0; i < count; ++i)
+   {
+      const DatagramDesc& datagram = pDatagrams[i];
+      PacketResult& res = pResults[i];
+      res = PacketResult();
+      m_Proceed(datagram.pData, datagram.len, res);
+
+      if (res.IsValid())
+      {
+         ++valid;
+         onPacket(static_cast<const PacketRef&>(lastPacket), static_cast<const PacketResult&>(res), datagram);
+      }
+   }
+   return valid;
+}
+
+template<typename PKT_TYPE>
+bool F12025_PacketExtractor::m_Store(const uint8_t* pData, unsigned& len, PacketSlot<PKT_TYPE>& slot)
+{
+   if (!CopyBytesToStruct(pData, len, &slot.data))
+      return false;
+
+   slot.epoch = m_epoch;
+   return true;
+}
+
+template<typename PKT_TYPE>
+bool F12025_PacketExtractor::m_Extract(const uint8_t* pData, unsigned& len, PacketSlot<PKT_TYPE>& slot)
+{
+   if (mode == ExtractMode::Copy)
+      return m_Store(pData, len, slot);
+
+   if (sizeof(PKT_TYPE) <= len)
+   {
+      len = sizeof(PKT_TYPE);
+      return true;
+   }
+
+   return false;
+}
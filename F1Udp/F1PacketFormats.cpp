@@ -0,0 +1,249 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1PacketFormats.h"
+
+#include <stddef.h>
+
+namespace
+{
+   // names got shorter with F1 25, cut at a character boundary of the utf-8 string
+   template<size_t DST_LEN, size_t SRC_LEN>
+   void s_CopyName(char(&dst)[DST_LEN], const char(&src)[SRC_LEN])
+   {
+      size_t len = 0;
+      while ((len < SRC_LEN) && src[len])
+         ++len;
+
+      if (len >= DST_LEN)
+      {
+         len = DST_LEN - 1;
+         while (len && ((static_cast<uint8_t>(src[len]) & 0xC0) == 0x80))
+            --len;
+      }
+
+      memcpy(dst, src, len);
+      memset(dst + len, 0, DST_LEN - len);
+   }
+
+   // byte offset of a member, for the memcpy of field ranges
+   template<typename T>
+   uint8_t* s_At(T& obj, size_t offset) { return reinterpret_cast<uint8_t*>(&obj) + offset; }
+
+   template<typename T>
+   const uint8_t* s_At(const T& obj, size_t offset) { return reinterpret_cast<const uint8_t*>(&obj) + offset; }
+}
+
+void DecodePacket(const F1_2024::PacketParticipantsData& in, PacketParticipantsData& out)
+{
+   out = PacketParticipantsData();
+   out.m_header = in.m_header;
+   out.m_numActiveCars = in.m_numActiveCars;
+
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      const F1_2024::ParticipantData& src = in.m_participants[i];
+      ParticipantData& dst = out.m_participants[i];
+      dst.m_aiControlled = src.m_aiControlled;
+      dst.m_driverId = src.m_driverId;
+      dst.m_networkId = src.m_networkId;
+      dst.m_teamId = src.m_teamId;
+      dst.m_myTeam = src.m_myTeam;
+      dst.m_raceNumber = src.m_raceNumber;
+      dst.m_nationality = src.m_nationality;
+      s_CopyName(dst.m_name, src.m_name);
+      dst.m_yourTelemetry = src.m_yourTelemetry;
+      dst.m_showOnlineNames = src.m_showOnlineNames;
+      dst.m_techLevel = src.m_techLevel;
+      dst.m_platform = src.m_platform;
+   }
+}
+
+void DecodePacket(const F1_2024::PacketFinalClassificationData& in, PacketFinalClassificationData& out)
+{
+   out = PacketFinalClassificationData();
+   out.m_header = in.m_header;
+   out.m_numCars = in.m_numCars;
+
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      const F1_2024::FinalClassificationData& src = in.m_classificationData[i];
+      FinalClassificationData& dst = out.m_classificationData[i];
+      dst.m_position = src.m_position;
+      dst.m_numLaps = src.m_numLaps;
+      dst.m_gridPosition = src.m_gridPosition;
+      dst.m_points = src.m_points;
+      dst.m_numPitStops = src.m_numPitStops;
+      dst.m_resultStatus = src.m_resultStatus;
+      dst.m_bestLapTimeInMS = src.m_bestLapTimeInMS;
+      dst.m_totalRaceTime = src.m_totalRaceTime;
+      dst.m_penaltiesTime = src.m_penaltiesTime;
+      dst.m_numPenalties = src.m_numPenalties;
+      dst.m_numTyreStints = src.m_numTyreStints;
+      memcpy(dst.m_tyreStintsActual, src.m_tyreStintsActual, sizeof(dst.m_tyreStintsActual));
+      memcpy(dst.m_tyreStintsVisual, src.m_tyreStintsVisual, sizeof(dst.m_tyreStintsVisual));
+      memcpy(dst.m_tyreStintsEndLaps, src.m_tyreStintsEndLaps, sizeof(dst.m_tyreStintsEndLaps));
+   }
+}
+
+void DecodePacket(const F1_2024::PacketLobbyInfoData& in, PacketLobbyInfoData& out)
+{
+   out = PacketLobbyInfoData();
+   out.m_header = in.m_header;
+   out.m_numPlayers = in.m_numPlayers;
+
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      const F1_2024::LobbyInfoData& src = in.m_lobbyPlayers[i];
+      LobbyInfoData& dst = out.m_lobbyPlayers[i];
+      dst.m_aiControlled = src.m_aiControlled;
+      dst.m_teamId = src.m_teamId;
+      dst.m_nationality = src.m_nationality;
+      dst.m_platform = src.m_platform;
+      s_CopyName(dst.m_name, src.m_name);
+      dst.m_carNumber = src.m_carNumber;
+      dst.m_yourTelemetry = src.m_yourTelemetry;
+      dst.m_showOnlineNames = src.m_showOnlineNames;
+      dst.m_techLevel = src.m_techLevel;
+      dst.m_readyStatus = src.m_readyStatus;
+   }
+}
+
+void DecodePacket(const F1_2024::PacketCarDamageData& in, PacketCarDamageData& out)
+{
+   out = PacketCarDamageData();
+   out.m_header = in.m_header;
+
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      const F1_2024::CarDamageData& src = in.m_carDamageData[i];
+      CarDamageData& dst = out.m_carDamageData[i];
+
+      // same order, only the blisters are missing in between
+      memcpy(dst.m_tyresWear, src.m_tyresWear, sizeof(dst.m_tyresWear));
+      memcpy(dst.m_tyresDamage, src.m_tyresDamage, sizeof(dst.m_tyresDamage));
+      memcpy(dst.m_brakesDamage, src.m_brakesDamage, sizeof(dst.m_brakesDamage));
+      memcpy(s_At(dst, offsetof(CarDamageData, m_frontLeftWingDamage)), s_At(src, offsetof(F1_2024::CarDamageData, m_frontLeftWingDamage)), sizeof(F1_2024::CarDamageData) - offsetof(F1_2024::CarDamageData, m_frontLeftWingDamage));
+   }
+   static_assert(sizeof(CarDamageData) - offsetof(CarDamageData, m_frontLeftWingDamage) == sizeof(F1_2024::CarDamageData) - offsetof(F1_2024::CarDamageData, m_frontLeftWingDamage));
+}
+
+void DecodePacket(const F1_2023::PacketSessionData& in, PacketSessionData& out)
+{
+   out = PacketSessionData();
+
+   // identical up to the forecast samples
+   memcpy(&out, &in, offsetof(F1_2023::PacketSessionData, m_weatherForecastSamples));
+   memcpy(out.m_weatherForecastSamples, in.m_weatherForecastSamples, sizeof(in.m_weatherForecastSamples));
+
+   // identical from m_forecastAccuracy up to m_numRedFlagPeriods
+   constexpr size_t restLen = sizeof(F1_2023::PacketSessionData) - offsetof(F1_2023::PacketSessionData, m_forecastAccuracy);
+   static_assert(offsetof(PacketSessionData, m_equalCarPerformance) - offsetof(PacketSessionData, m_forecastAccuracy) == restLen);
+   memcpy(s_At(out, offsetof(PacketSessionData, m_forecastAccuracy)), s_At(in, offsetof(F1_2023::PacketSessionData, m_forecastAccuracy)), restLen);
+}
+
+void DecodePacket(const F1_2023::PacketLapData& in, PacketLapData& out)
+{
+   out = PacketLapData();
+   out.m_header = in.m_header;
+   out.m_timeTrialPBCarIdx = in.m_timeTrialPBCarIdx;
+   out.m_timeTrialRivalCarIdx = in.m_timeTrialRivalCarIdx;
+
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      const F1_2023::LapData& src = in.m_lapData[i];
+      LapData& dst = out.m_lapData[i];
+      dst.m_lastLapTimeInMS = src.m_lastLapTimeInMS;
+      dst.m_currentLapTimeInMS = src.m_currentLapTimeInMS;
+      dst.m_sector1TimeMSPart = src.m_sector1TimeMSPart;
+      dst.m_sector1TimeMinutesPart = src.m_sector1TimeMinutesPart;
+      dst.m_sector2TimeMSPart = src.m_sector2TimeMSPart;
+      dst.m_sector2TimeMinutesPart = src.m_sector2TimeMinutesPart;
+      dst.m_deltaToCarInFrontMSPart = src.m_deltaToCarInFrontInMS % 60000;
+      dst.m_deltaToCarInFrontMinutesPart = static_cast<uint8>(src.m_deltaToCarInFrontInMS / 60000);
+      dst.m_deltaToRaceLeaderMSPart = src.m_deltaToRaceLeaderInMS % 60000;
+      dst.m_deltaToRaceLeaderMinutesPart = static_cast<uint8>(src.m_deltaToRaceLeaderInMS / 60000);
+      dst.m_lapDistance = src.m_lapDistance;
+      dst.m_totalDistance = src.m_totalDistance;
+      dst.m_safetyCarDelta = src.m_safetyCarDelta;
+      dst.m_carPosition = src.m_carPosition;
+      dst.m_currentLapNum = src.m_currentLapNum;
+      dst.m_pitStatus = src.m_pitStatus;
+      dst.m_numPitStops = src.m_numPitStops;
+      dst.m_sector = src.m_sector;
+      dst.m_currentLapInvalid = src.m_currentLapInvalid;
+      dst.m_penalties = src.m_penalties;
+      dst.m_totalWarnings = src.m_totalWarnings;
+      dst.m_cornerCuttingWarnings = src.m_cornerCuttingWarnings;
+      dst.m_numUnservedDriveThroughPens = src.m_numUnservedDriveThroughPens;
+      dst.m_numUnservedStopGoPens = src.m_numUnservedStopGoPens;
+      dst.m_gridPosition = src.m_gridPosition;
+      dst.m_driverStatus = src.m_driverStatus;
+      dst.m_resultStatus = src.m_resultStatus;
+      dst.m_pitLaneTimerActive = src.m_pitLaneTimerActive;
+      dst.m_pitLaneTimeInLaneInMS = src.m_pitLaneTimeInLaneInMS;
+      dst.m_pitStopTimerInMS = src.m_pitStopTimerInMS;
+      dst.m_pitStopShouldServePen = src.m_pitStopShouldServePen;
+      dst.m_speedTrapFastestLap = 255; // not set
+   }
+}
+
+void DecodePacket(const F1_2023::PacketParticipantsData& in, PacketParticipantsData& out)
+{
+   out = PacketParticipantsData();
+   out.m_header = in.m_header;
+   out.m_numActiveCars = in.m_numActiveCars;
+
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      const F1_2023::ParticipantData& src = in.m_participants[i];
+      ParticipantData& dst = out.m_participants[i];
+      dst.m_aiControlled = src.m_aiControlled;
+      dst.m_driverId = src.m_driverId;
+      dst.m_networkId = src.m_networkId;
+      dst.m_teamId = src.m_teamId;
+      dst.m_myTeam = src.m_myTeam;
+      dst.m_raceNumber = src.m_raceNumber;
+      dst.m_nationality = src.m_nationality;
+      s_CopyName(dst.m_name, src.m_name);
+      dst.m_yourTelemetry = src.m_yourTelemetry;
+      dst.m_showOnlineNames = src.m_showOnlineNames;
+      dst.m_platform = src.m_platform;
+   }
+}
+
+void DecodePacket(const F1_2023::PacketCarSetupData& in, PacketCarSetupData& out)
+{
+   out = PacketCarSetupData();
+   out.m_header = in.m_header;
+
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      const F1_2023::CarSetupData& src = in.m_carSetupData[i];
+      CarSetupData& dst = out.m_carSetupData[i];
+
+      // m_engineBraking was added after m_brakeBias
+      memcpy(&dst, &src, offsetof(F1_2023::CarSetupData, m_rearLeftTyrePressure));
+      memcpy(s_At(dst, offsetof(CarSetupData, m_rearLeftTyrePressure)), s_At(src, offsetof(F1_2023::CarSetupData, m_rearLeftTyrePressure)), sizeof(F1_2023::CarSetupData) - offsetof(F1_2023::CarSetupData, m_rearLeftTyrePressure));
+   }
+}
+
+void DecodePacket(const F1_2023::PacketLobbyInfoData& in, PacketLobbyInfoData& out)
+{
+   out = PacketLobbyInfoData();
+   out.m_header = in.m_header;
+   out.m_numPlayers = in.m_numPlayers;
+
+   for (unsigned i = 0; i < cs_maxNumCarsInUDPData; ++i)
+   {
+      const F1_2023::LobbyInfoData& src = in.m_lobbyPlayers[i];
+      LobbyInfoData& dst = out.m_lobbyPlayers[i];
+      dst.m_aiControlled = src.m_aiControlled;
+      dst.m_teamId = src.m_teamId;
+      dst.m_nationality = src.m_nationality;
+      dst.m_platform = src.m_platform;
+      s_CopyName(dst.m_name, src.m_name);
+      dst.m_carNumber = src.m_carNumber;
+      dst.m_readyStatus = src.m_readyStatus;
+   }
+}
@@ -0,0 +1,95 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "F1DataDefs.h"
+#include "F1DataDefsLegacy.h"
+
+// The F1 25 structs (F1DataDefs.h) are the common model, packets of older games are decoded into them.
+// WireFormat<FORMAT, PKT_TYPE> describes how PKT_TYPE is sent by the game with the given m_packetFormat,
+// fields which the older game does not send are zero.
+
+// all m_packetFormat values the extractor accepts
+inline constexpr uint16_t cs_supportedPacketFormats[] = { 2023, 2024, 2025 };
+
+// default: binary identical to the F1 25 struct, used in place
+template<uint16_t FORMAT, typename PKT_TYPE>
+struct WireFormat
+{
+   static constexpr bool supported = true;
+   static constexpr bool native = true;
+   static constexpr unsigned size = sizeof(PKT_TYPE);
+
+   static void Decode(const uint8_t* pData, PKT_TYPE* pOut) { memcpy(pOut, pData, sizeof(PKT_TYPE)); }
+};
+
+// packet type did not exist in this game
+struct UnsupportedWireFormat
+{
+   static constexpr bool supported = false;
+   static constexpr bool native = false;
+   static constexpr unsigned size = 0;
+};
+
+// older struct, decoded field by field
+void DecodePacket(const F1_2024::PacketParticipantsData& in, PacketParticipantsData& out);
+void DecodePacket(const F1_2024::PacketFinalClassificationData& in, PacketFinalClassificationData& out);
+void DecodePacket(const F1_2024::PacketLobbyInfoData& in, PacketLobbyInfoData& out);
+void DecodePacket(const F1_2024::PacketCarDamageData& in, PacketCarDamageData& out);
+void DecodePacket(const F1_2023::PacketSessionData& in, PacketSessionData& out);
+void DecodePacket(const F1_2023::PacketLapData& in, PacketLapData& out);
+void DecodePacket(const F1_2023::PacketParticipantsData& in, PacketParticipantsData& out);
+void DecodePacket(const F1_2023::PacketCarSetupData& in, PacketCarSetupData& out);
+void DecodePacket(const F1_2023::PacketLobbyInfoData& in, PacketLobbyInfoData& out);
+
+template<typename WIRE_TYPE, typename PKT_TYPE>
+struct ConvertedWireFormat
+{
+   static constexpr bool supported = true;
+   static constexpr bool native = false;
+   static constexpr unsigned size = sizeof(WIRE_TYPE);
+
+   static void Decode(const uint8_t* pData, PKT_TYPE* pOut)
+   {
+      WIRE_TYPE in;
+      memcpy(&in, pData, sizeof(WIRE_TYPE));
+      DecodePacket(in, *pOut);
+   }
+};
+
+// older struct is a prefix of the F1 25 one
+template<typename PKT_TYPE, unsigned SIZE>
+struct PrefixWireFormat
+{
+   static constexpr bool supported = true;
+   static constexpr bool native = false;
+   static constexpr unsigned size = SIZE;
+
+   static void Decode(const uint8_t* pData, PKT_TYPE* pOut)
+   {
+      memcpy(pOut, pData, SIZE);
+      memset(reinterpret_cast<uint8_t*>(pOut) + SIZE, 0, sizeof(PKT_TYPE) - SIZE);
+   }
+};
+
+// F1 24
+template<> struct WireFormat<2024, PacketParticipantsData> : ConvertedWireFormat<F1_2024::PacketParticipantsData, PacketParticipantsData> {};
+template<> struct WireFormat<2024, PacketFinalClassificationData> : ConvertedWireFormat<F1_2024::PacketFinalClassificationData, PacketFinalClassificationData> {};
+template<> struct WireFormat<2024, PacketLobbyInfoData> : ConvertedWireFormat<F1_2024::PacketLobbyInfoData, PacketLobbyInfoData> {};
+template<> struct WireFormat<2024, PacketCarDamageData> : ConvertedWireFormat<F1_2024::PacketCarDamageData, PacketCarDamageData> {};
+template<> struct WireFormat<2024, PacketMotionExData> : PrefixWireFormat<PacketMotionExData, F1_2024::cs_motionExSize> {};
+template<> struct WireFormat<2024, PacketLapPositionsData> : UnsupportedWireFormat {};
+
+// F1 23
+template<> struct WireFormat<2023, PacketSessionData> : ConvertedWireFormat<F1_2023::PacketSessionData, PacketSessionData> {};
+template<> struct WireFormat<2023, PacketLapData> : ConvertedWireFormat<F1_2023::PacketLapData, PacketLapData> {};
+template<> struct WireFormat<2023, PacketParticipantsData> : ConvertedWireFormat<F1_2023::PacketParticipantsData, PacketParticipantsData> {};
+template<> struct WireFormat<2023, PacketCarSetupData> : ConvertedWireFormat<F1_2023::PacketCarSetupData, PacketCarSetupData> {};
+template<> struct WireFormat<2023, PacketFinalClassificationData> : WireFormat<2024, PacketFinalClassificationData> {};
+template<> struct WireFormat<2023, PacketLobbyInfoData> : ConvertedWireFormat<F1_2023::PacketLobbyInfoData, PacketLobbyInfoData> {};
+template<> struct WireFormat<2023, PacketCarDamageData> : WireFormat<2024, PacketCarDamageData> {};
+template<> struct WireFormat<2023, PacketMotionExData> : PrefixWireFormat<PacketMotionExData, F1_2023::cs_motionExSize> {};
+template<> struct WireFormat<2023, PacketTimeTrialData> : UnsupportedWireFormat {};
+template<> struct WireFormat<2023, PacketLapPositionsData> : UnsupportedWireFormat {};
@@ -0,0 +1,170 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "F1DataDefs.h"
+#include "F1PacketView.h"
+#include "F1PacketExtractor.h"
+
+// Everything the extractor knows about one packet type.
+// PacketType doubles as m_packetId, WIRE_SIZE is the length of the udp packet as given by the specification.
+template<typename PKT_TYPE, PacketType TYPE, PacketSlot<PKT_TYPE> F12025_PacketExtractor::* MEMBER, unsigned WIRE_SIZE>
+struct PacketRegistryEntry
+{
+   static_assert(sizeof(PKT_TYPE) == WIRE_SIZE, "packet struct does not match the binary format of the udp packet");
+   static_assert(TYPE != PacketType::UnknownOrIllformed);
+
+   using Packet = PKT_TYPE;
+   static constexpr PacketType packetType = TYPE;
+   static constexpr uint8_t id = static_cast<uint8_t>(TYPE);
+   static constexpr unsigned size = WIRE_SIZE;
+   static constexpr PacketSlot<PKT_TYPE> F12025_PacketExtractor::* member = MEMBER;
+};
+
+template<typename... ENTRIES>
+struct PacketRegistryList
+{
+   static constexpr unsigned count = sizeof...(ENTRIES);
+};
+
+// adding a packet type only needs a new line here (+ the member in F12025_PacketExtractor)
+using PacketRegistry = PacketRegistryList<
+   PacketRegistryEntry<PacketMotionData, PacketType::PacketMotionData, &F12025_PacketExtractor::motion, 1349>,
+   PacketRegistryEntry<PacketSessionData, PacketType::PacketSessionData, &F12025_PacketExtractor::session, 753>,
+   PacketRegistryEntry<PacketLapData, PacketType::PacketLapData, &F12025_PacketExtractor::lap, 1285>,
+   PacketRegistryEntry<PacketEventData, PacketType::PacketEventData, &F12025_PacketExtractor::event, 45>,
+   PacketRegistryEntry<PacketParticipantsData, PacketType::PacketParticipantsData, &F12025_PacketExtractor::participants, 1284>,
+   PacketRegistryEntry<PacketCarSetupData, PacketType::PacketCarSetupData, &F12025_PacketExtractor::setups, 1133>,
+   PacketRegistryEntry<PacketCarTelemetryData, PacketType::PacketCarTelemetryData, &F12025_PacketExtractor::telemetry, 1352>,
+   PacketRegistryEntry<PacketCarStatusData, PacketType::PacketCarStatusData, &F12025_PacketExtractor::status, 1239>,
+   PacketRegistryEntry<PacketFinalClassificationData, PacketType::PacketFinalClassificationData, &F12025_PacketExtractor::classification, 1042>,
+   PacketRegistryEntry<PacketLobbyInfoData, PacketType::PacketLobbyInfoData, &F12025_PacketExtractor::lobby, 954>,
+   PacketRegistryEntry<PacketCarDamageData, PacketType::PacketCarDamageData, &F12025_PacketExtractor::cardamage, 1041>,
+   PacketRegistryEntry<PacketSessionHistoryData, PacketType::PacketSessionHistoryData, &F12025_PacketExtractor::history, 1460>,
+   PacketRegistryEntry<PacketTyreSetsData, PacketType::PacketTyreSetsData, &F12025_PacketExtractor::tyreSets, 231>,
+   PacketRegistryEntry<PacketMotionExData, PacketType::PacketMotionExData, &F12025_PacketExtractor::motionEx, 273>,
+   PacketRegistryEntry<PacketTimeTrialData, PacketType::PacketTimeTrialData, &F12025_PacketExtractor::timeTrial, 101>,
+   PacketRegistryEntry<PacketLapPositionsData, PacketType::PacketLapPositions, &F12025_PacketExtractor::lapPositions, 1131>
+>;
+
+
+namespace F1PacketRegistryDetail
+{
+   template<typename T>
+   struct Identity { using type = T; };
+
+   template<typename PKT_TYPE, typename LIST>
+   struct EntryOf;
+
+   template<typename PKT_TYPE>
+   struct EntryOf<PKT_TYPE, PacketRegistryList<>>
+   {
+      static_assert(!std::is_same_v<PKT_TYPE, PKT_TYPE>, "packet type is not registered in PacketRegistry");
+   };
+
+   template<typename PKT_TYPE, typename FIRST, typename... REST>
+   struct EntryOf<PKT_TYPE, PacketRegistryList<FIRST, REST...>> :
+      std::conditional_t<std::is_same_v<typename FIRST::Packet, PKT_TYPE>, Identity<FIRST>, EntryOf<PKT_TYPE, PacketRegistryList<REST...>>>
+   {};
+
+   template<typename... ENTRIES>
+   constexpr std::array<unsigned, 256> MakeSizeTable(PacketRegistryList<ENTRIES...>)
+   {
+      std::array<unsigned, 256> table{};
+      ((table[ENTRIES::id] = ENTRIES::size), ...);
+      return table;
+   }
+
+   template<typename VISITOR, typename... ENTRIES>
+   bool VisitRef(const PacketRef& ref, VISITOR&& visitor, PacketRegistryList<ENTRIES...>)
+   {
+      static_assert((std::is_invocable_v<VISITOR, PacketView<typename ENTRIES::Packet>> && ...), "visitor must accept a view of every registered packet type");
+      return ((ref.type == ENTRIES::packetType ? (visitor(PacketView<typename ENTRIES::Packet>(ref.pData)), true) : false) || ...);
+   }
+
+   template<typename VISITOR, typename... ENTRIES>
+   bool VisitMember(const F12025_PacketExtractor& ex, PacketType type, VISITOR&& visitor, PacketRegistryList<ENTRIES...>)
+   {
+      static_assert((std::is_invocable_v<VISITOR, const typename ENTRIES::Packet&> && ...), "visitor must accept every registered packet type");
+      return ((type == ENTRIES::packetType ? (visitor(ex.Get<typename ENTRIES::Packet>()), true) : false) || ...);
+   }
+
+   template<typename FUNC, typename... ENTRIES>
+   void ForEachSlot(F12025_PacketExtractor& ex, FUNC&& func, PacketRegistryList<ENTRIES...>)
+   {
+      (func(ex.*ENTRIES::member), ...);
+   }
+}
+
+// registry entry for a packet struct, e.g. PacketEntryOf<PacketLapData>::size
+template<typename PKT_TYPE>
+using PacketEntryOf = typename F1PacketRegistryDetail::EntryOf<PKT_TYPE, PacketRegistry>::type;
+
+template<typename PKT_TYPE>
+constexpr PacketType PacketTypeOf()
+{
+   return PacketEntryOf<PKT_TYPE>::packetType;
+}
+
+// size on the wire for a m_packetId, 0 for unknown ids
+inline constexpr unsigned PacketWireSize(uint8_t packetId)
+{
+   constexpr auto s_sizes = F1PacketRegistryDetail::MakeSizeTable(PacketRegistry{});
+   return s_sizes[packetId];
+}
+
+template<typename PKT_TYPE>
+const PKT_TYPE& F12025_PacketExtractor::Get() const
+{
+   const PacketSlot<PKT_TYPE>& slot = this->*PacketEntryOf<PKT_TYPE>::member;
+   return (slot.epoch == m_epoch) ? slot.data : s_emptyPacket<PKT_TYPE>;
+}
+
+template<typename PKT_TYPE>
+bool F12025_PacketExtractor::Has() const
+{
+   return (this->*PacketEntryOf<PKT_TYPE>::member).epoch == m_epoch;
+}
+
+template<typename PKT_TYPE>
+void F12025_PacketExtractor::Invalidate()
+{
+   (this->*PacketEntryOf<PKT_TYPE>::member).epoch = 0;
+}
+
+template<typename PKT_TYPE>
+PacketView<PKT_TYPE> PacketRef::As() const
+{
+   if ((type != PacketTypeOf<PKT_TYPE>()) || (len < sizeof(PKT_TYPE)))
+      return PacketView<PKT_TYPE>();
+
+   return PacketView<PKT_TYPE>(pData);
+}
+
+// calls visitor(PacketView<T>) with the typed view of ref, returns false if ref is no known packet
+template<typename VISITOR>
+bool VisitPacket(const PacketRef& ref, VISITOR&& visitor)
+{
+   if (!ref.pData)
+      return false;
+
+   return F1PacketRegistryDetail::VisitRef(ref, std::forward<VISITOR>(visitor), PacketRegistry{});
+}
+
+// calls func(PacketSlot<T>&) for every packet slot of the extractor
+template<typename FUNC>
+void ForEachPacketSlot(F12025_PacketExtractor& ex, FUNC&& func)
+{
+   F1PacketRegistryDetail::ForEachSlot(ex, std::forward<FUNC>(func), PacketRegistry{});
+}
+
+// calls visitor(const T&) with the last packet of the given type, see F12025_PacketExtractor::Get()
+template<typename VISITOR>
+bool VisitPacket(const F12025_PacketExtractor& ex, PacketType type, VISITOR&& visitor)
+{
+   return F1PacketRegistryDetail::VisitMember(ex, type, std::forward<VISITOR>(visitor), PacketRegistry{});
+}
@@ -0,0 +1,109 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "F1DataDefs.h"
+
+// Read-only view into a received packet, the data is NOT copied.
+// The view is only valid as long as the buffer it points to is valid, use Retain() to get a copy which outlives the buffer.
+// The structs from F1DataDefs.h are packed, thus fields can sit on any address. All reads go through memcpy,
+// so the view works for any buffer alignment.
+template<typename PKT_TYPE>
+class PacketView
+{
+   static_assert(std::is_trivially_copyable_v<PKT_TYPE>, "views are only possible for plain packet structs");
+
+   // type of the member of PKT_TYPE a member pointer refers to
+   template<auto pField>
+   using MemberType = std::remove_cv_t<std::remove_reference_t<decltype(std::declval<const PKT_TYPE&>().*pField)>>;
+
+public:
+   PacketView() = default;
+   explicit PacketView(const uint8_t* pData) : m_pData(pData) {}
+
+   bool IsValid() const { return m_pData != nullptr; }
+   const uint8_t* Data() const { return m_pData; }
+   static constexpr unsigned Size() { return sizeof(PKT_TYPE); }
+
+   // read a single field, e.g.: view.Get<&PacketLapData::m_timeTrialPBCarIdx>()
+   template<auto pField>
+   auto Get() const
+   {
+      MemberType<pField> val;
+      memcpy(&val, m_pData + cs_offsetOf<pField>, sizeof(val));
+      return val;
+   }
+
+   // view of a nested struct, e.g.: view.Sub<&PacketLapPositionsData::m_header>().Get<&PacketHeader::m_frameIdentifier>()
+   template<auto pField>
+   PacketView<MemberType<pField>> Sub() const
+   {
+      return PacketView<MemberType<pField>>(m_pData + cs_offsetOf<pField>);
+   }
+
+   // view of one element of an array member, e.g.: view.At<&PacketLapData::m_lapData>(3).Get<&LapData::m_carPosition>()
+   template<auto pArray>
+   PacketView<std::remove_extent_t<MemberType<pArray>>> At(size_t idx) const
+   {
+      using ELEM_TYPE = std::remove_extent_t<MemberType<pArray>>;
+      static_assert(std::is_array_v<MemberType<pArray>>, "At() needs an array member");
+      return PacketView<ELEM_TYPE>(m_pData + cs_offsetOf<pArray> + idx * sizeof(ELEM_TYPE));
+   }
+
+   // copy the packet out of the buffer
+   PKT_TYPE Retain() const
+   {
+      PKT_TYPE pkt;
+      Retain(&pkt);
+      return pkt;
+   }
+
+   void Retain(PKT_TYPE* pTarget) const
+   {
+      memcpy(pTarget, m_pData, sizeof(PKT_TYPE));
+   }
+
+private:
+   template<auto pField>
+   static size_t s_OffsetOf()
+   {
+      static_assert(std::is_same_v<decltype(pField), MemberType<pField> PKT_TYPE::*>, "member pointer of another struct");
+      // offsetof() needs a member name, for member pointers measure on storage which is neither initialized nor read
+      union Probe
+      {
+         Probe() {}
+         PKT_TYPE pkt;
+      } probe;
+      return reinterpret_cast<const uint8_t*>(std::addressof(probe.pkt.*pField)) - reinterpret_cast<const uint8_t*>(&probe.pkt);
+   }
+
+   // measured once per member pointer at startup, the accessors only load it
+   template<auto pField>
+   static inline const size_t cs_offsetOf = s_OffsetOf<pField>();
+
+   const uint8_t* m_pData{ nullptr };
+};
+
+// untyped reference to the last packet accepted by the extractor, size and header are already checked
+struct PacketRef
+{
+   PacketType type{ PacketType::UnknownOrIllformed };
+   const uint8_t* pData{ nullptr };
+   unsigned len{ 0 };
+
+   // returns an invalid view, if the packet is not of the requested type (defined in F1PacketRegistry.h)
+   template<typename PKT_TYPE>
+   PacketView<PKT_TYPE> As() const;
+};
+
+// bit of a packet type in a packet mask (packet ids 0..15)
+inline constexpr uint16_t PacketBit(PacketType type)
+{
+   return static_cast<uint16_t>(1u << static_cast<unsigned>(type));
+}
@@ -0,0 +1,689 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1Pcap.h"
+#include "F1Capture.h"
+
+#include <string.h>
+
+namespace
+{
+   // first 4 bytes of the file as little endian value
+   constexpr uint32_t cs_pcapMagicUs = 0xA1B2C3D4;
+   constexpr uint32_t cs_pcapMagicUsSwapped = 0xD4C3B2A1;
+   constexpr uint32_t cs_pcapMagicNs = 0xA1B23C4D;
+   constexpr uint32_t cs_pcapMagicNsSwapped = 0x4D3CB2A1;
+   constexpr uint32_t cs_pcapNgSectionHeader = 0x0A0D0D0A;
+   constexpr uint32_t cs_pcapNgByteOrder = 0x1A2B3C4D;
+   constexpr uint32_t cs_pcapNgByteOrderSwapped = 0x4D3C2B1A;
+
+   // pcapng block types
+   constexpr uint32_t cs_blockInterface = 1;
+   constexpr uint32_t cs_blockPacket = 2; // obsolete
+   constexpr uint32_t cs_blockSimplePacket = 3;
+   constexpr uint32_t cs_blockEnhancedPacket = 6;
+
+   // link types
+   constexpr uint16_t cs_linkNull = 0;
+   constexpr uint16_t cs_linkEthernet = 1;
+   constexpr uint16_t cs_linkRawOpenBsd = 12;
+   constexpr uint16_t cs_linkRawBsd = 14;
+   constexpr uint16_t cs_linkRaw = 101;
+   constexpr uint16_t cs_linkLoop = 108;
+   constexpr uint16_t cs_linkLinuxSll = 113;
+   constexpr uint16_t cs_linkIPv4 = 228;
+   constexpr uint16_t cs_linkIPv6 = 229;
+   constexpr uint16_t cs_linkLinuxSll2 = 276;
+
+   constexpr uint32_t cs_maxFrameLen = 256 * 1024; // larger records are taken as a corrupt file
+   constexpr uint64_t cs_prefetchSize = 16 * 1024 * 1024;
+
+   enum class Network
+   {
+      None,
+      IPv4,
+      IPv6
+   };
+
+   enum class UdpResult
+   {
+      Datagram,
+      Other,
+      Fragment,
+      Truncated
+   };
+
+   uint16_t s_Be16(const uint8_t* p)
+   {
+      return static_cast<uint16_t>((p[0] << 8) | p[1]);
+   }
+
+   uint32_t s_Le32(const uint8_t* p)
+   {
+      uint32_t val;
+      memcpy(&val, p, sizeof(val));
+      return val;
+   }
+
+   uint32_t s_Swap32(uint32_t val)
+   {
+      return (val >> 24) | ((val >> 8) & 0xFF00) | ((val << 8) & 0xFF0000) | (val << 24);
+   }
+
+   Network s_EtherType(uint16_t type)
+   {
+      switch (type)
+      {
+      case 0x0800: return Network::IPv4;
+      case 0x86DD: return Network::IPv6;
+      default: return Network::None;
+      }
+   }
+
+   // skips the link layer header
+   Network s_LinkPayload(uint16_t linkType, const uint8_t*& p, uint32_t& len)
+   {
+      switch (linkType)
+      {
+      case cs_linkEthernet:
+      {
+         if (len < 14)
+            return Network::None;
+
+         uint16_t type = s_Be16(p + 12);
+         p += 14;
+         len -= 14;
+         while ((type == 0x8100) || (type == 0x88A8) || (type == 0x9100)) // VLAN tags
+         {
+            if (len < 4)
+               return Network::None;
+            type = s_Be16(p + 2);
+            p += 4;
+            len -= 4;
+         }
+         return s_EtherType(type);
+      }
+
+      case cs_linkNull:
+      case cs_linkLoop:
+      {
+         // address family in the byte order of the capturing host (NULL) or big endian (LOOP)
+         if (len < 4)
+            return Network::None;
+
+         uint32_t family = s_Le32(p);
+         if (family > 0xFFFF)
+            family = s_Swap32(family);
+         p += 4;
+         len -= 4;
+
+         switch (family)
+         {
+         case 2: return Network::IPv4;
+         case 23: // Windows
+         case 24: // BSD
+         case 28:
+         case 30: return Network::IPv6;
+         default: return Network::None;
+         }
+      }
+
+      case cs_linkRaw:
+      case cs_linkRawOpenBsd:
+      case cs_linkRawBsd:
+         if (!len)
+            return Network::None;
+         return ((p[0] >> 4) == 4) ? Network::IPv4 : (((p[0] >> 4) == 6) ? Network::IPv6 : Network::None);
+
+      case cs_linkIPv4:
+         return Network::IPv4;
+
+      case cs_linkIPv6:
+         return Network::IPv6;
+
+      case cs_linkLinuxSll:
+      {
+         if (len < 16)
+            return Network::None;
+         const uint16_t type = s_Be16(p + 14);
+         p += 16;
+         len -= 16;
+         return s_EtherType(type);
+      }
+
+      case cs_linkLinuxSll2:
+      {
+         if (len < 20)
+            return Network::None;
+         const uint16_t type = s_Be16(p);
+         p += 20;
+         len -= 20;
+         return s_EtherType(type);
+      }
+
+      default:
+         return Network::None;
+      }
+   }
+
+   // the UDP payload of an IP packet, len: captured bytes
+   UdpResult s_UdpPayload(Network net, const uint8_t* p, uint32_t len, uint16_t port, DatagramDesc& datagram)
+   {
+      uint8_t proto = 0;
+      if (net == Network::IPv4)
+      {
+         if ((len < 20) || ((p[0] >> 4) != 4))
+            return UdpResult::Other;
+
+         const uint32_t headerLen = (p[0] & 0x0F) * 4u;
+         if ((headerLen < 20) || (len < headerLen))
+            return UdpResult::Other;
+
+         proto = p[9];
+         if (proto != 17)
+            return UdpResult::Other;
+
+         if (s_Be16(p + 6) & 0x3FFF) // more fragments or fragment offset
+            return UdpResult::Fragment;
+
+         p += headerLen;
+         len -= headerLen;
+      }
+      else if (net == Network::IPv6)
+      {
+         if ((len < 40) || ((p[0] >> 4) != 6))
+            return UdpResult::Other;
+
+         proto = p[6];
+         p += 40;
+         len -= 40;
+
+         // hop-by-hop, routing and destination options
+         while ((proto == 0) || (proto == 43) || (proto == 60))
+         {
+            if ((len < 8) || (len < (p[1] + 1u) * 8))
+               return UdpResult::Other;
+
+            const uint32_t extLen = (p[1] + 1u) * 8;
+            proto = p[0];
+            p += extLen;
+            len -= extLen;
+         }
+
+         if (proto == 44)
+            return UdpResult::Fragment;
+         if (proto != 17)
+            return UdpResult::Other;
+      }
+      else
+         return UdpResult::Other;
+
+      if (len < 8)
+         return UdpResult::Truncated;
+
+      if (port && (s_Be16(p + 2) != port))
+         return UdpResult::Other;
+
+      const uint32_t udpLen = s_Be16(p + 4);
+      if (udpLen <= 8)
+         return UdpResult::Other;
+
+      if (len - 8 < udpLen - 8)
+         return UdpResult::Truncated;
+
+      datagram.pData = p + 8;
+      datagram.len = udpLen - 8;
+      return UdpResult::Datagram;
+   }
+}
+
+bool F1PcapReader::IsPcap(const std::filesystem::path& path)
+{
+   std::ifstream file(path, std::ios::binary);
+   uint8_t magic[4] = {};
+   file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+   if (!file.good())
+      return false;
+
+   switch (s_Le32(magic))
+   {
+   case cs_pcapMagicUs:
+   case cs_pcapMagicUsSwapped:
+   case cs_pcapMagicNs:
+   case cs_pcapMagicNsSwapped:
+   case cs_pcapNgSectionHeader:
+      return true;
+   default:
+      return false;
+   }
+}
+
+uint16_t F1PcapReader::m_U16(const uint8_t* p) const
+{
+   uint16_t val;
+   memcpy(&val, p, sizeof(val));
+   return m_swap ? static_cast<uint16_t>((val >> 8) | (val << 8)) : val;
+}
+
+uint32_t F1PcapReader::m_U32(const uint8_t* p) const
+{
+   const uint32_t val = s_Le32(p);
+   return m_swap ? s_Swap32(val) : val;
+}
+
+bool F1PcapReader::Open(const std::filesystem::path& path, uint16_t port)
+{
+   Close();
+
+   if (!m_file.Open(path) || (m_file.Size() < 24))
+   {
+      Close();
+      return false;
+   }
+
+   const uint8_t* pData = m_file.Data();
+   switch (s_Le32(pData))
+   {
+   case cs_pcapMagicUs:
+   case cs_pcapMagicNs:
+      m_swap = false;
+      break;
+
+   case cs_pcapMagicUsSwapped:
+   case cs_pcapMagicNsSwapped:
+      m_swap = true;
+      break;
+
+   case cs_pcapNgSectionHeader:
+      m_ng = true;
+      break;
+
+   default:
+      Close();
+      return false;
+   }
+
+   if (!m_ng)
+   {
+      m_nanoseconds = (m_U32(pData) == cs_pcapMagicNs);
+      m_linkType = static_cast<uint16_t>(m_U32(pData + 20)); // upper bits: FCS length
+      m_dataBegin = 24;
+   }
+
+   m_port = port;
+
+   // one pass for the number of datagrams and the time range
+   Rewind();
+   DatagramDesc datagram;
+   while (m_Advance(datagram, &m_stats))
+   {
+      if (!m_firstTimestampNs)
+         m_firstTimestampNs = datagram.rxTimestampNs;
+      m_lastTimestampNs = datagram.rxTimestampNs;
+   }
+
+   Rewind();
+   return true;
+}
+
+void F1PcapReader::Close()
+{
+   m_file.Close();
+   m_ng = false;
+   m_swap = false;
+   m_port = 0;
+   m_linkType = 0;
+   m_nanoseconds = false;
+   m_interfaces.clear();
+   m_dataBegin = 0;
+   m_stats = F1PcapStats();
+   m_firstTimestampNs = 0;
+   m_lastTimestampNs = 0;
+   Rewind();
+}
+
+void F1PcapReader::Rewind()
+{
+   m_offset = m_dataBegin;
+   m_prefetchEnd = m_dataBegin;
+   m_position = 0;
+   m_peeked = false;
+   m_interfaces.clear();
+   m_lastTimestampNsNg = 0;
+}
+
+bool F1PcapReader::Next(DatagramDesc& datagram)
+{
+   if (!Peek(datagram))
+      return false;
+
+   m_peeked = false;
+   ++m_position;
+   return true;
+}
+
+bool F1PcapReader::Peek(DatagramDesc& datagram)
+{
+   if (!m_peeked)
+   {
+      if (!IsOpen() || (m_position >= m_stats.datagrams) || !m_Advance(m_peekedDatagram, nullptr))
+         return false;
+      m_peeked = true;
+   }
+
+   datagram = m_peekedDatagram;
+   return true;
+}
+
+unsigned F1PcapReader::NextBatch(DatagramDesc* pDatagrams, unsigned maxCount)
+{
+   unsigned cnt = 0;
+   while ((cnt < maxCount) && Next(pDatagrams[cnt]))
+      ++cnt;
+   return cnt;
+}
+
+bool F1PcapReader::m_Advance(DatagramDesc& datagram, F1PcapStats* pStats)
+{
+   const uint8_t* pFrame;
+   uint32_t capLen;
+   uint32_t origLen;
+   uint16_t linkType;
+   uint64_t timestampNs;
+
+   while (m_NextFrame(pFrame, capLen, origLen, linkType, timestampNs))
+   {
+      UdpResult res = UdpResult::Other;
+      const Network net = s_LinkPayload(linkType, pFrame, capLen);
+      if (net != Network::None)
+         res = s_UdpPayload(net, pFrame, capLen, m_port, datagram);
+
+      if (pStats)
+      {
+         ++pStats->frames;
+         switch (res)
+         {
+         case UdpResult::Datagram: ++pStats->datagrams; break;
+         case UdpResult::Other: ++pStats->other; break;
+         case UdpResult::Fragment: ++pStats->fragments; break;
+         case UdpResult::Truncated: ++pStats->truncated; break;
+         }
+      }
+
+      if (res == UdpResult::Datagram)
+      {
+         datagram.rxTimestampNs = timestampNs;
+         return true;
+      }
+   }
+   return false;
+}
+
+bool F1PcapReader::m_NextFrame(const uint8_t*& pFrame, uint32_t& capLen, uint32_t& origLen, uint16_t& linkType, uint64_t& timestampNs)
+{
+   const uint8_t* pData = m_file.Data();
+   const uint64_t size = m_file.Size();
+
+   // the mapping is opened for random access, read ahead for the sequential walk
+   if (m_offset + cs_prefetchSize / 2 > m_prefetchEnd)
+   {
+      m_file.Prefetch(m_offset, cs_prefetchSize);
+      m_prefetchEnd = m_offset + cs_prefetchSize;
+   }
+
+   if (!m_ng)
+   {
+      if (m_offset + 16 > size)
+         return false;
+
+      const uint8_t* pRec = pData + m_offset;
+      capLen = m_U32(pRec + 8);
+      origLen = m_U32(pRec + 12);
+      if ((capLen > cs_maxFrameLen) || (m_offset + 16 + capLen > size))
+         return false;
+
+      const uint64_t frac = m_U32(pRec + 4);
+      timestampNs = m_U32(pRec) * 1000000000ull + (m_nanoseconds ? frac : frac * 1000);
+      linkType = m_linkType;
+      pFrame = pRec + 16;
+      m_offset += 16 + capLen;
+      return true;
+   }
+
+   for (;;)
+   {
+      if (m_offset + 12 > size)
+         return false;
+
+      const uint8_t* pBlock = pData + m_offset;
+      uint32_t type = s_Le32(pBlock);
+      if (type == cs_pcapNgSectionHeader)
+      {
+         // the byte order of each section is given by its header
+         const uint32_t byteOrder = s_Le32(pBlock + 8);
+         if ((byteOrder != cs_pcapNgByteOrder) && (byteOrder != cs_pcapNgByteOrderSwapped))
+            return false;
+         m_swap = (byteOrder == cs_pcapNgByteOrderSwapped);
+         m_interfaces.clear();
+      }
+      else
+         type = m_U32(pBlock);
+
+      const uint32_t blockLen = m_U32(pBlock + 4);
+      if ((blockLen < 12) || (blockLen & 3) || (m_offset + blockLen > size))
+         return false;
+
+      const uint8_t* pBody = pBlock + 8;
+      const uint32_t bodyLen = blockLen - 12;
+      m_offset += blockLen;
+
+      switch (type)
+      {
+      case cs_blockInterface:
+         if (!m_ReadInterface(pBody, bodyLen))
+            return false;
+         break;
+
+      case cs_blockEnhancedPacket:
+      case cs_blockPacket:
+      {
+         if (bodyLen < 20)
+            return false;
+
+         uint32_t itfId;
+         if (type == cs_blockEnhancedPacket)
+            itfId = m_U32(pBody);
+         else
+            itfId = m_U16(pBody);
+
+         capLen = m_U32(pBody + 12);
+         origLen = m_U32(pBody + 16);
+         if (capLen > bodyLen - 20)
+            return false;
+
+         const Interface itf = (itfId < m_interfaces.size()) ? m_interfaces[itfId] : Interface{ 0xFFFF };
+         timestampNs = m_ToNs(itf, (static_cast<uint64_t>(m_U32(pBody + 4)) << 32) | m_U32(pBody + 8));
+         m_lastTimestampNsNg = timestampNs;
+         linkType = itf.linkType;
+         pFrame = pBody + 20;
+         return true;
+      }
+
+      case cs_blockSimplePacket:
+      {
+         // no time stamp, interface 0
+         if (bodyLen < 4)
+            return false;
+
+         origLen = m_U32(pBody);
+         capLen = (origLen < bodyLen - 4) ? origLen : bodyLen - 4;
+         timestampNs = m_lastTimestampNsNg;
+         linkType = m_interfaces.empty() ? 0xFFFF : m_interfaces[0].linkType;
+         pFrame = pBody + 4;
+         return true;
+      }
+
+      default:
+         break; // statistics, name resolution, custom blocks
+      }
+   }
+}
+
+bool F1PcapReader::m_ReadInterface(const uint8_t* pBody, uint32_t bodyLen)
+{
+   if (bodyLen < 8)
+      return false;
+
+   Interface itf;
+   itf.linkType = m_U16(pBody);
+
+   // options: code, length, value padded to 4 bytes
+   uint32_t pos = 8;
+   while (pos + 4 <= bodyLen)
+   {
+      const uint16_t code = m_U16(pBody + pos);
+      const uint16_t len = m_U16(pBody + pos + 2);
+      pos += 4;
+      if (!code || (pos + len > bodyLen))
+         break;
+
+      if ((code == 9) && (len >= 1)) // if_tsresol
+      {
+         const uint8_t resolution = pBody[pos];
+         itf.binaryResolution = (resolution & 0x80) != 0;
+         const unsigned exponent = resolution & 0x7F;
+         if (itf.binaryResolution)
+            itf.unitsPerSecond = (exponent < 64) ? (1ull << exponent) : 1;
+         else
+         {
+            itf.unitsPerSecond = 1;
+            for (unsigned i = 0; (i < exponent) && (i < 19); ++i)
+               itf.unitsPerSecond *= 10;
+         }
+      }
+      else if ((code == 14) && (len >= 8)) // if_tsoffset
+      {
+         const uint64_t low = m_U32(pBody + pos);
+         const uint64_t high = m_U32(pBody + pos + 4);
+         itf.offsetSeconds = static_cast<int64_t>(m_swap ? ((low << 32) | high) : ((high << 32) | low));
+      }
+
+      pos += (len + 3u) & ~3u;
+   }
+
+   m_interfaces.push_back(itf);
+   return true;
+}
+
+uint64_t F1PcapReader::m_ToNs(const Interface& itf, uint64_t ts) const
+{
+   const uint64_t seconds = ts / itf.unitsPerSecond;
+   const uint64_t frac = ts % itf.unitsPerSecond;
+
+   uint64_t ns;
+   if (itf.binaryResolution)
+      ns = static_cast<uint64_t>(static_cast<double>(frac) * 1e9 / static_cast<double>(itf.unitsPerSecond));
+   else if (itf.unitsPerSecond <= 1000000000)
+      ns = frac * (1000000000 / itf.unitsPerSecond);
+   else
+      ns = frac / (itf.unitsPerSecond / 1000000000);
+
+   return (seconds + itf.offsetSeconds) * 1000000000 + ns;
+}
+
+bool F1PcapWriter::Open(const std::filesystem::path& path, uint16_t port)
+{
+   Close();
+
+   m_buffer.resize(1024 * 1024);
+   m_file.rdbuf()->pubsetbuf(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+   m_file.open(path, std::ios::binary | std::ios::trunc);
+   if (!m_file.is_open())
+      return false;
+
+   // little endian, nanosecond time stamps, version 2.4, snap length 256 KB, Ethernet
+   const uint32_t header[6] = { cs_pcapMagicNs, 0x00040002, 0, 0, cs_maxFrameLen, cs_linkEthernet };
+   m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+   m_port = port;
+   m_ipId = 0;
+   m_records = 0;
+   return m_file.good();
+}
+
+bool F1PcapWriter::Write(const uint8_t* pData, unsigned len, uint64_t rxTimestampNs)
+{
+   constexpr unsigned headersLen = 14 + 20 + 8;
+   if (!m_file.is_open() || !pData || !len || (len > 0xFFFF - 28))
+      return false;
+
+   const uint32_t record[4] = { static_cast<uint32_t>(rxTimestampNs / 1000000000), static_cast<uint32_t>(rxTimestampNs % 1000000000),
+      headersLen + len, headersLen + len };
+
+   uint8_t headers[headersLen] = {};
+
+   // Ethernet: zero addresses as Wireshark shows them for loopback captures, IPv4
+   headers[12] = 0x08;
+
+   uint8_t* pIp = headers + 14;
+   const unsigned ipLen = 20 + 8 + len;
+   pIp[0] = 0x45;
+   pIp[2] = static_cast<uint8_t>(ipLen >> 8);
+   pIp[3] = static_cast<uint8_t>(ipLen);
+   pIp[4] = static_cast<uint8_t>(m_ipId >> 8);
+   pIp[5] = static_cast<uint8_t>(m_ipId);
+   pIp[6] = 0x40; // don't fragment
+   pIp[8] = 64;   // TTL
+   pIp[9] = 17;   // UDP
+   pIp[12] = 127;
+   pIp[15] = 1;
+   pIp[16] = 127;
+   pIp[19] = 1;
+
+   uint32_t sum = 0;
+   for (unsigned i = 0; i < 20; i += 2)
+      sum += s_Be16(pIp + i);
+   while (sum >> 16)
+      sum = (sum & 0xFFFF) + (sum >> 16);
+   pIp[10] = static_cast<uint8_t>(~sum >> 8);
+   pIp[11] = static_cast<uint8_t>(~sum);
+
+   // UDP without checksum (allowed for IPv4)
+   uint8_t* pUdp = pIp + 20;
+   pUdp[0] = pUdp[2] = static_cast<uint8_t>(m_port >> 8);
+   pUdp[1] = pUdp[3] = static_cast<uint8_t>(m_port);
+   pUdp[4] = static_cast<uint8_t>((8 + len) >> 8);
+   pUdp[5] = static_cast<uint8_t>(8 + len);
+
+   m_file.write(reinterpret_cast<const char*>(record), sizeof(record));
+   m_file.write(reinterpret_cast<const char*>(headers), sizeof(headers));
+   m_file.write(reinterpret_cast<const char*>(pData), len);
+
+   ++m_ipId;
+   ++m_records;
+   return m_file.good();
+}
+
+bool F1PcapWriter::Close()
+{
+   if (!m_file.is_open())
+      return false;
+
+   m_file.close();
+   return !m_file.fail();
+}
+
+bool ExportCaptureToPcap(const std::filesystem::path& capture, const std::filesystem::path& pcap, uint16_t port)
+{
+   F1CaptureReader reader;
+   F1PcapWriter writer;
+   if (!reader.Open(capture) || !writer.Open(pcap, port))
+      return false;
+
+   CaptureRecord rec;
+   bool ok = true;
+   while (ok && reader.Next(rec))
+      ok = writer.Write(rec.pData, rec.len, rec.rxTimestampNs);
+
+   return writer.Close() && ok;
+}
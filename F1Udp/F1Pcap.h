@@ -0,0 +1,131 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "F1MappedFile.h"
+#include "F1PacketExtractor.h"
+
+// pcap and pcapng files (tcpdump, Wireshark) as source of datagrams.
+// Link types: Ethernet (with VLAN tags), Linux cooked (SLL, SLL2), raw IP and BSD / Windows loopback.
+// IPv4 and IPv6, UDP datagrams to the selected port are returned, everything else is skipped.
+// IP fragments are skipped as well, the game does not send datagrams larger than the MTU.
+
+inline constexpr uint16_t cs_pcapDefaultPort = 20777;
+
+struct F1PcapStats
+{
+   uint64_t frames{ 0 };     // packet records of the file
+   uint64_t datagrams{ 0 };  // UDP datagrams to the port
+   uint64_t other{ 0 };      // other traffic, unknown link or network types
+   uint64_t fragments{ 0 };  // IP fragments
+   uint64_t truncated{ 0 };  // datagrams cut by the snap length of the capture
+};
+
+// Read-only, memory mapped: the datagrams point into the mapping (zero copy) and stay valid until Close().
+// Open() walks the file once to count the datagrams.
+class F1PcapReader
+{
+public:
+   F1PcapReader() = default;
+   F1PcapReader(const F1PcapReader&) = delete;
+   F1PcapReader& operator=(const F1PcapReader&) = delete;
+
+   // port 0: all UDP datagrams
+   bool Open(const std::filesystem::path& path, uint16_t port = cs_pcapDefaultPort);
+   void Close();
+
+   // true if the file starts with a pcap or pcapng magic
+   static bool IsPcap(const std::filesystem::path& path);
+
+   bool IsOpen() const { return m_file.IsOpen(); }
+   bool IsPcapNg() const { return m_ng; }
+   uint64_t Records() const { return m_stats.datagrams; }
+   uint64_t FirstTimestampNs() const { return m_firstTimestampNs; }
+   uint64_t LastTimestampNs() const { return m_lastTimestampNs; }
+   const F1PcapStats& Stats() const { return m_stats; }
+
+   // number of the datagram returned by the next Next()
+   uint64_t Position() const { return m_position; }
+
+   // rxTimestampNs is the capture time, ns since 1970
+   bool Next(DatagramDesc& datagram);
+
+   // like Next(), but the datagram is returned again by the next call
+   bool Peek(DatagramDesc& datagram);
+
+   // the next datagrams, e.g. for F12025_PacketExtractor::ProceedBatch(), returns the count
+   unsigned NextBatch(DatagramDesc* pDatagrams, unsigned maxCount);
+
+   void Rewind();
+
+private:
+   struct Interface
+   {
+      uint16_t linkType{ 0 };
+      uint64_t unitsPerSecond{ 1000000 };
+      bool binaryResolution{ false }; // unitsPerSecond is a power of 2
+      int64_t offsetSeconds{ 0 };
+   };
+
+   uint16_t m_U16(const uint8_t* p) const;
+   uint32_t m_U32(const uint8_t* p) const;
+
+   // walks the records from m_offset to the next datagram to the port, stats: counted during Open() only
+   bool m_Advance(DatagramDesc& datagram, F1PcapStats* pStats);
+
+   // next packet record (pcap) or block (pcapng), false at the end of the file or at an incomplete record
+   bool m_NextFrame(const uint8_t*& pFrame, uint32_t& capLen, uint32_t& origLen, uint16_t& linkType, uint64_t& timestampNs);
+   bool m_ReadInterface(const uint8_t* pBody, uint32_t bodyLen);
+   uint64_t m_ToNs(const Interface& itf, uint64_t ts) const;
+
+   F1MappedFile m_file;
+   bool m_ng{ false };
+   bool m_swap{ false };      // file byte order is not the host byte order
+   uint16_t m_port{ 0 };
+   uint16_t m_linkType{ 0 };  // pcap
+   bool m_nanoseconds{ false };
+   std::vector<Interface> m_interfaces; // pcapng, of the current section
+   uint64_t m_lastTimestampNsNg{ 0 };   // for simple packet blocks without time
+
+   uint64_t m_dataBegin{ 0 };
+   uint64_t m_offset{ 0 };
+   uint64_t m_prefetchEnd{ 0 };
+   uint64_t m_position{ 0 };
+   bool m_peeked{ false };
+   DatagramDesc m_peekedDatagram{};
+
+   F1PcapStats m_stats;
+   uint64_t m_firstTimestampNs{ 0 };
+   uint64_t m_lastTimestampNs{ 0 };
+};
+
+// pcap (nanosecond timestamps, Ethernet) of datagrams, each wrapped into IPv4 / UDP from and to 127.0.0.1:port
+class F1PcapWriter
+{
+public:
+   F1PcapWriter() = default;
+   ~F1PcapWriter() { Close(); }
+   F1PcapWriter(const F1PcapWriter&) = delete;
+   F1PcapWriter& operator=(const F1PcapWriter&) = delete;
+
+   bool Open(const std::filesystem::path& path, uint16_t port = cs_pcapDefaultPort);
+   bool Write(const uint8_t* pData, unsigned len, uint64_t rxTimestampNs);
+   bool Close();
+
+   bool IsOpen() const { return m_file.is_open(); }
+   uint64_t Records() const { return m_records; }
+
+private:
+   std::ofstream m_file;
+   std::vector<char> m_buffer;
+   uint16_t m_port{ 0 };
+   uint16_t m_ipId{ 0 };
+   uint64_t m_records{ 0 };
+};
+
+// writes all datagrams of a capture file (F1Capture.h) to a pcap file, e.g. to inspect it with Wireshark
+bool ExportCaptureToPcap(const std::filesystem::path& capture, const std::filesystem::path& pcap, uint16_t port = cs_pcapDefaultPort);
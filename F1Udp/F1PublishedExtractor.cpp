@@ -0,0 +1,44 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1PublishedExtractor.h"
+#include "F1PacketRegistry.h"
+
+namespace
+{
+   template<typename PKT_TYPE>
+   void s_Copy(const F12025_PacketExtractor& extractor, PKT_TYPE& target, uint16_t& mask)
+   {
+      target = extractor.Get<PKT_TYPE>();
+      if (extractor.Has<PKT_TYPE>())
+         mask |= PacketBit(PacketTypeOf<PKT_TYPE>());
+   }
+}
+
+void F1PublishedExtractor::Publish(const F12025_PacketExtractor& extractor)
+{
+   ExtractorSnapshot& snapshot = m_scratch;
+   snapshot.epoch = extractor.Epoch();
+   snapshot.format = extractor.Format();
+   snapshot.sessionUID = extractor.sessionUID;
+   snapshot.sessionTime = extractor.sessionTime;
+   snapshot.availableMask = 0;
+
+   s_Copy(extractor, snapshot.session, snapshot.availableMask);
+   s_Copy(extractor, snapshot.lap, snapshot.availableMask);
+   s_Copy(extractor, snapshot.participants, snapshot.availableMask);
+   s_Copy(extractor, snapshot.telemetry, snapshot.availableMask);
+   s_Copy(extractor, snapshot.status, snapshot.availableMask);
+   s_Copy(extractor, snapshot.cardamage, snapshot.availableMask);
+
+   m_state.Store(snapshot);
+}
+
+bool F1PublishedExtractor::Read(ExtractorSnapshot& snapshot) const
+{
+   if (!m_state.Sequence())
+      return false;
+
+   m_state.Load(snapshot);
+   return true;
+}
@@ -0,0 +1,47 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include "F1DataDefs.h"
+#include "F1PacketExtractor.h"
+#include "F1SeqLock.h"
+
+// Copy of the packets most readers need, taken from the extractor at one point in time.
+// Packets which were not received in the current session are zeroed, see availableMask.
+struct ExtractorSnapshot
+{
+   uint32_t epoch{ 0 };
+   uint16_t format{ 0 };
+   uint16_t availableMask{ 0 }; // bit = PacketType
+   uint64_t sessionUID{ 0 };
+   float sessionTime{ 0 };
+
+   PacketSessionData session{};
+   PacketLapData lap{};
+   PacketParticipantsData participants{};
+   PacketCarTelemetryData telemetry{};
+   PacketCarStatusData status{};
+   PacketCarDamageData cardamage{};
+
+   bool Has(PacketType type) const { return (availableMask & PacketBit(type)) != 0; }
+};
+
+// Lets other threads (UI, report writer, exporters) read the extractor state without locking.
+// Publish() is called by the thread owning the extractor, it never waits for readers.
+class F1PublishedExtractor
+{
+public:
+   // single writer: the thread which calls ProceedPacket() / ProceedBatch()
+   void Publish(const F12025_PacketExtractor& extractor);
+
+   // consistent copy of the last published state, false if nothing was published yet
+   bool Read(ExtractorSnapshot& snapshot) const;
+
+   // number of Publish() calls
+   uint64_t Published() const { return m_state.Sequence() / 2; }
+
+private:
+   SeqLock<ExtractorSnapshot> m_state;
+   ExtractorSnapshot m_scratch; // writer side, keeps the snapshot off the stack
+};
@@ -0,0 +1,419 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1ReplayEngine.h"
+
+#include <string.h>
+#include <algorithm>
+
+bool F1ReplayEngine::Open(const std::filesystem::path& path)
+{
+   Close();
+
+   if (!m_file.Open(path))
+      return false;
+
+   CaptureFileHeader hdr{};
+   if (m_file.Size() >= sizeof(hdr))
+      memcpy(&hdr, m_file.Data(), sizeof(hdr));
+
+   if (memcmp(hdr.magic, cs_captureMagic, sizeof(hdr.magic)) || (hdr.version != cs_captureVersion) ||
+      (hdr.headerSize < sizeof(hdr)) || (hdr.headerSize > m_file.Size()))
+   {
+      Close();
+      return false;
+   }
+
+   m_dataBegin = hdr.headerSize;
+   m_delta = (hdr.flags & cs_captureFlagDelta) != 0;
+   if (!m_ReadIndex())
+      m_RebuildIndex();
+
+   m_BuildSessions();
+   Rewind();
+   return true;
+}
+
+void F1ReplayEngine::Close()
+{
+   m_file.Close();
+   m_index.clear();
+   m_sessions.clear();
+   m_checkpoints.clear();
+   m_pRestored = nullptr;
+   m_delta = false;
+   m_dataBegin = m_dataEnd = 0;
+   m_records = 0;
+   m_offset = m_position = 0;
+}
+
+bool F1ReplayEngine::m_ReadIndex()
+{
+   CaptureFileTrailer trailer{};
+   const uint64_t size = m_file.Size();
+   if (size < m_dataBegin + sizeof(trailer))
+      return false;
+
+   memcpy(&trailer, m_file.Data() + size - sizeof(trailer), sizeof(trailer));
+   if (memcmp(trailer.magic, cs_captureTrailerMagic, sizeof(trailer.magic)))
+      return false;
+
+   const uint64_t indexBytes = trailer.indexCount * sizeof(CaptureIndexEntry);
+   const uint64_t checkpointBytes = trailer.checkpointCount * sizeof(CaptureIndexEntry);
+   if ((trailer.indexOffset < m_dataBegin) || (trailer.indexOffset + indexBytes != trailer.checkpointOffset) ||
+      (trailer.checkpointOffset + checkpointBytes + sizeof(trailer) != size))
+      return false;
+
+   // copied: the entries are packed and the mapping gives no alignment guarantee
+   m_index.resize(static_cast<size_t>(trailer.indexCount));
+   if (indexBytes)
+      memcpy(m_index.data(), m_file.Data() + trailer.indexOffset, static_cast<size_t>(indexBytes));
+   m_checkpoints.resize(static_cast<size_t>(trailer.checkpointCount));
+   if (checkpointBytes)
+      memcpy(m_checkpoints.data(), m_file.Data() + trailer.checkpointOffset, static_cast<size_t>(checkpointBytes));
+
+   m_dataEnd = trailer.indexOffset;
+   m_records = trailer.recordCount;
+   return true;
+}
+
+void F1ReplayEngine::m_RebuildIndex()
+{
+   // no trailer: walk the record headers up to the last complete record
+   m_dataEnd = m_file.Size();
+   m_records = 0;
+
+   CaptureIndexBuilder builder;
+   uint64_t offset = m_dataBegin;
+   CaptureRecordHeader rec;
+   while (m_RecordAt(offset, rec))
+   {
+      if (!CaptureIsDatagram(rec))
+      {
+         builder.Add(offset, m_records, rec, nullptr);
+         offset += sizeof(rec) + rec.len;
+         continue;
+      }
+
+      unsigned len = 0;
+      const uint8_t* pPayload = m_Payload(offset, rec, len);
+      if (!pPayload)
+         break;
+
+      PacketHeader hdr;
+      if (len >= sizeof(hdr))
+         memcpy(&hdr, pPayload, sizeof(hdr));
+      builder.Add(offset, m_records, rec, (len >= sizeof(hdr)) ? &hdr : nullptr);
+      offset += sizeof(rec) + rec.len;
+      ++m_records;
+   }
+
+   m_index = std::move(builder.entries);
+   m_checkpoints = std::move(builder.checkpoints);
+   m_dataEnd = offset;
+}
+
+void F1ReplayEngine::m_BuildSessions()
+{
+   // the index starts a new entry at each session change
+   for (size_t i = 0; i < m_index.size(); ++i)
+   {
+      const CaptureIndexEntry& entry = m_index[i];
+      if (!m_sessions.empty() && (m_sessions.back().sessionUID == entry.sessionUID))
+         continue;
+
+      if (!m_sessions.empty())
+      {
+         m_sessions.back().endRecord = entry.record;
+         m_sessions.back().endEntry = i;
+      }
+
+      ReplaySession session;
+      session.sessionUID = entry.sessionUID;
+      session.firstRecord = entry.record;
+      session.firstSessionTime = entry.sessionTime;
+      session.firstFrame = entry.overallFrameIdentifier;
+      session.firstEntry = i;
+      m_sessions.push_back(session);
+   }
+
+   if (!m_sessions.empty())
+   {
+      m_sessions.back().endRecord = m_records;
+      m_sessions.back().endEntry = m_index.size();
+   }
+
+   // a checkpoint at the first record of a session still holds the state of the session before
+   size_t cp = 0;
+   for (ReplaySession& session : m_sessions)
+   {
+      while ((cp < m_checkpoints.size()) && (m_checkpoints[cp].record <= session.firstRecord))
+         ++cp;
+      session.firstCheckpoint = cp;
+      while ((cp < m_checkpoints.size()) && (m_checkpoints[cp].record <= session.endRecord) && (m_checkpoints[cp].sessionUID == session.sessionUID))
+         ++cp;
+      session.endCheckpoint = cp;
+   }
+}
+
+bool F1ReplayEngine::m_RecordAt(uint64_t offset, CaptureRecordHeader& rec) const
+{
+   if (offset + sizeof(rec) > m_dataEnd)
+      return false;
+
+   memcpy(&rec, m_file.Data() + offset, sizeof(rec));
+   return CaptureRecordValid(rec) && (offset + sizeof(rec) + rec.len <= m_dataEnd);
+}
+
+const uint8_t* F1ReplayEngine::m_Payload(uint64_t offset, const CaptureRecordHeader& rec, unsigned& len)
+{
+   const uint8_t* pData = m_file.Data() + offset + sizeof(rec);
+   if (rec.flags & cs_captureRecordReset)
+      m_codec.Reset();
+
+   if (rec.kind == CaptureRecordKind::DeltaDatagram)
+      return m_codec.Decode(pData, rec.len, len);
+
+   // plain records are references for the following deltas
+   if (m_delta)
+      m_codec.Update(pData, rec.len);
+   len = rec.len;
+   return pData;
+}
+
+void F1ReplayEngine::Rewind()
+{
+   m_offset = m_dataBegin;
+   m_position = 0;
+}
+
+template<typename STOP>
+bool F1ReplayEngine::m_SeekFrom(const ReplaySession& session, size_t entry, STOP&& stop)
+{
+   uint64_t offset = m_index[entry].offset;
+   uint64_t record = m_index[entry].record;
+
+   CaptureRecordHeader rec;
+   while ((record < session.endRecord) && m_RecordAt(offset, rec))
+   {
+      if (!CaptureIsDatagram(rec))
+      {
+         offset += sizeof(rec) + rec.len;
+         continue;
+      }
+
+      // the header is decoded without taking the record as reference, it is decoded again by NextBatch()
+      PacketHeader hdr{};
+      bool complete = false;
+      if (rec.flags & cs_captureRecordReset)
+         m_codec.Reset();
+      if (rec.kind == CaptureRecordKind::DeltaDatagram)
+         complete = m_codec.DecodeHeader(m_file.Data() + offset + sizeof(rec), rec.len, hdr);
+      else if (rec.len >= sizeof(PacketHeader))
+      {
+         memcpy(&hdr, m_file.Data() + offset + sizeof(rec), sizeof(hdr));
+         complete = true;
+      }
+
+      if (stop(rec, hdr, complete))
+         break;
+
+      unsigned len;
+      if (m_delta && !m_Payload(offset, rec, len))
+         break;
+
+      offset += sizeof(rec) + rec.len;
+      ++record;
+   }
+
+   m_offset = offset;
+   m_position = record;
+   m_file.Prefetch(m_offset, 1024 * 1024);
+   return record < session.endRecord;
+}
+
+bool F1ReplayEngine::SeekSessionTime(size_t session, float sessionTime)
+{
+   if (session >= m_sessions.size())
+      return false;
+
+   const ReplaySession& s = m_sessions[session];
+   auto first = m_index.begin() + s.firstEntry;
+   auto last = m_index.begin() + s.endEntry;
+
+   // last entry before the time, the records up to the next entry are walked
+   auto it = std::upper_bound(first, last, sessionTime,
+      [](float t, const CaptureIndexEntry& entry) { return t <= entry.sessionTime; });
+   if (it != first)
+      --it;
+
+   return m_SeekFrom(s, static_cast<size_t>(it - m_index.begin()),
+      [sessionTime](const CaptureRecordHeader& rec, const PacketHeader&, bool) { return rec.sessionTime >= sessionTime; });
+}
+
+bool F1ReplayEngine::SeekFrame(size_t session, uint32_t overallFrameIdentifier)
+{
+   if (session >= m_sessions.size())
+      return false;
+
+   const ReplaySession& s = m_sessions[session];
+   auto first = m_index.begin() + s.firstEntry;
+   auto last = m_index.begin() + s.endEntry;
+
+   auto it = std::upper_bound(first, last, overallFrameIdentifier,
+      [](uint32_t frame, const CaptureIndexEntry& entry) { return frame <= entry.overallFrameIdentifier; });
+   if (it != first)
+      --it;
+
+   return m_SeekFrom(s, static_cast<size_t>(it - m_index.begin()),
+      [overallFrameIdentifier](const CaptureRecordHeader&, const PacketHeader& hdr, bool complete)
+      {
+         return complete && (hdr.m_overallFrameIdentifier >= overallFrameIdentifier);
+      });
+}
+
+bool F1ReplayEngine::m_RestoreState(const ReplaySession& session, F12025_PacketExtractor& extractor, F1TimingModel* pTiming)
+{
+   const uint64_t targetOffset = m_offset;
+   const uint64_t targetRecord = m_position;
+
+   // last checkpoint of the session at or before the target, the record numbers are monotonic unlike the session time
+   auto first = m_checkpoints.begin() + session.firstCheckpoint;
+   auto last = m_checkpoints.begin() + session.endCheckpoint;
+   auto it = std::upper_bound(first, last, targetRecord,
+      [](uint64_t record, const CaptureIndexEntry& entry) { return record < entry.record; });
+
+   m_pRestored = nullptr;
+   if (it != first)
+   {
+      --it;
+      CaptureRecordHeader rec;
+      const uint8_t* pCheckpoint = m_file.Data() + it->offset + sizeof(rec);
+      if (m_RecordAt(it->offset, rec) && (rec.kind == CaptureRecordKind::Checkpoint) &&
+         RestoreCheckpoint(extractor, pCheckpoint, rec.len) && (!pTiming || RestoreCheckpoint(*pTiming, pCheckpoint, rec.len)))
+      {
+         m_pRestored = &*it;
+         m_offset = it->offset + sizeof(rec) + rec.len;
+         m_position = it->record;
+      }
+   }
+
+   if (!m_pRestored)
+   {
+      extractor.Reset();
+      if (pTiming)
+         RestoreCheckpoint(*pTiming, nullptr, 0);
+      m_offset = m_index[session.firstEntry].offset;
+      m_position = m_index[session.firstEntry].record;
+   }
+
+   m_file.Prefetch(m_offset, targetOffset - m_offset);
+   while (m_position < targetRecord)
+   {
+      const unsigned maxCount = static_cast<unsigned>((std::min<uint64_t>)(targetRecord - m_position, 4096));
+      const unsigned cnt = pTiming ?
+         Replay(extractor, maxCount, [&](const PacketRef&, const PacketResult& res, const DatagramDesc& datagram)
+            {
+               pTiming->Apply(extractor, res.type, datagram.rxTimestampNs);
+            }) :
+         Replay(extractor, maxCount);
+      if (!cnt)
+         return false;
+   }
+   return true;
+}
+
+bool F1ReplayEngine::SeekSessionTime(size_t session, float sessionTime, F12025_PacketExtractor& extractor)
+{
+   if (session >= m_sessions.size())
+      return false;
+
+   const bool found = SeekSessionTime(session, sessionTime);
+   return m_RestoreState(m_sessions[session], extractor, nullptr) && found;
+}
+
+bool F1ReplayEngine::SeekFrame(size_t session, uint32_t overallFrameIdentifier, F12025_PacketExtractor& extractor)
+{
+   if (session >= m_sessions.size())
+      return false;
+
+   const bool found = SeekFrame(session, overallFrameIdentifier);
+   return m_RestoreState(m_sessions[session], extractor, nullptr) && found;
+}
+
+bool F1ReplayEngine::SeekSessionTime(size_t session, float sessionTime, F12025_PacketExtractor& extractor, F1TimingModel& timing)
+{
+   if (session >= m_sessions.size())
+      return false;
+
+   const bool found = SeekSessionTime(session, sessionTime);
+   return m_RestoreState(m_sessions[session], extractor, &timing) && found;
+}
+
+bool F1ReplayEngine::SeekFrame(size_t session, uint32_t overallFrameIdentifier, F12025_PacketExtractor& extractor, F1TimingModel& timing)
+{
+   if (session >= m_sessions.size())
+      return false;
+
+   const bool found = SeekFrame(session, overallFrameIdentifier);
+   return m_RestoreState(m_sessions[session], extractor, &timing) && found;
+}
+
+const uint8_t* F1ReplayEngine::RestoredCheckpoint(size_t& len) const
+{
+   CaptureRecordHeader rec;
+   if (!m_pRestored || !m_RecordAt(m_pRestored->offset, rec))
+   {
+      len = 0;
+      return nullptr;
+   }
+
+   len = rec.len;
+   return m_file.Data() + m_pRestored->offset + sizeof(rec);
+}
+
+unsigned F1ReplayEngine::NextBatch(DatagramDesc* pDatagrams, unsigned maxCount)
+{
+   unsigned n = 0;
+   CaptureRecordHeader rec;
+   m_batch.clear();
+   m_batchDecoded.clear();
+   while ((n < maxCount) && (m_position < m_records) && m_RecordAt(m_offset, rec))
+   {
+      if (!CaptureIsDatagram(rec))
+      {
+         m_offset += sizeof(rec) + rec.len;
+         continue;
+      }
+
+      unsigned len = 0;
+      const uint8_t* pPayload = m_Payload(m_offset, rec, len);
+      if (!pPayload)
+         break;
+
+      // a decoded payload is overwritten by the next one of its type, it is copied to the batch buffer
+      if (rec.kind == CaptureRecordKind::DeltaDatagram)
+      {
+         m_batchDecoded.emplace_back(n, m_batch.size());
+         m_batch.insert(m_batch.end(), pPayload, pPayload + len);
+         pPayload = nullptr;
+      }
+      pDatagrams[n].pData = pPayload;
+      pDatagrams[n].len = len;
+      pDatagrams[n].rxTimestampNs = rec.rxTimestampNs;
+      ++n;
+
+      m_offset += sizeof(rec) + rec.len;
+      ++m_position;
+   }
+
+   // the buffer is complete, it does not move any more
+   for (const auto& decoded : m_batchDecoded)
+      pDatagrams[decoded.first].pData = m_batch.data() + decoded.second;
+   return n;
+}
+
+unsigned F1ReplayEngine::Replay(F12025_PacketExtractor& extractor, unsigned maxCount)
+{
+   return Replay(extractor, maxCount, [](const PacketRef&, const PacketResult&, const DatagramDesc&) {});
+}
@@ -0,0 +1,131 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <filesystem>
+#include <utility>
+#include <vector>
+#include "F1Capture.h"
+#include "F1Checkpoint.h"
+#include "F1MappedFile.h"
+#include "F1PacketExtractor.h"
+
+// one session (m_sessionUID) of a capture, a session which was left and joined again is listed twice
+struct ReplaySession
+{
+   uint64_t sessionUID{ 0 };
+   uint64_t firstRecord{ 0 };
+   uint64_t endRecord{ 0 };
+   float firstSessionTime{ 0 };
+   uint32_t firstFrame{ 0 }; // m_overallFrameIdentifier
+   size_t firstEntry{ 0 };   // index entries of this session
+   size_t endEntry{ 0 };
+   size_t firstCheckpoint{ 0 }; // checkpoints of this session
+   size_t endCheckpoint{ 0 };
+};
+
+// Replay of a capture file (F1Capture.h) from a memory mapping.
+// Seeks are a binary search over the sparse index plus at most cs_captureIndexInterval record headers,
+// the packets are passed to the extractor without a copy (delta records are decoded to a batch buffer).
+class F1ReplayEngine
+{
+public:
+   bool Open(const std::filesystem::path& path);
+   void Close();
+
+   bool IsOpen() const { return m_file.IsOpen(); }
+   uint64_t Records() const { return m_records; }
+   const std::vector<ReplaySession>& Sessions() const { return m_sessions; }
+   const std::vector<CaptureIndexEntry>& Checkpoints() const { return m_checkpoints; }
+
+   // number of the next record
+   uint64_t Position() const { return m_position; }
+
+   void Rewind();
+
+   // position to the first record of the session with m_sessionTime >= sessionTime.
+   // After a flashback the session time is not monotonic, any of the matching positions may be found.
+   bool SeekSessionTime(size_t session, float sessionTime);
+
+   // position to the first record of the session with m_overallFrameIdentifier >= frame
+   bool SeekFrame(size_t session, uint32_t overallFrameIdentifier);
+
+   // Seek with the extractor state at the new position: the last checkpoint of the session before the position is
+   // restored and only the records after it are replayed. Without a checkpoint the session is replayed from its start.
+   bool SeekSessionTime(size_t session, float sessionTime, F12025_PacketExtractor& extractor);
+   bool SeekFrame(size_t session, uint32_t overallFrameIdentifier, F12025_PacketExtractor& extractor);
+
+   // Seek with the extractor and the timing model at the new position: both sections of the checkpoint are restored
+   // (the model continues the session, see RestoreTimingModel()) and the records after it are applied to both.
+   // Checkpoints without a timing section are not used.
+   bool SeekSessionTime(size_t session, float sessionTime, F12025_PacketExtractor& extractor, F1TimingModel& timing);
+   bool SeekFrame(size_t session, uint32_t overallFrameIdentifier, F12025_PacketExtractor& extractor, F1TimingModel& timing);
+
+   // checkpoint restored by the last seek with extractor, for the optional sections. nullptr if none was used.
+   const uint8_t* RestoredCheckpoint(size_t& len) const;
+
+   // the next records, returns the number of datagrams. pData points into the mapping and stays valid until Close(),
+   // for delta records into a buffer which is valid until the next call.
+   unsigned NextBatch(DatagramDesc* pDatagrams, unsigned maxCount);
+
+   // stream up to maxCount records into the extractor, returns the number of datagrams
+   unsigned Replay(F12025_PacketExtractor& extractor, unsigned maxCount);
+
+   template<typename FUNC>
+   unsigned Replay(F12025_PacketExtractor& extractor, unsigned maxCount, FUNC&& onPacket);
+
+private:
+   bool m_ReadIndex();
+   void m_RebuildIndex();
+   void m_BuildSessions();
+
+   // restores the extractor state (and the timing model if pTiming) at the current position
+   bool m_RestoreState(const ReplaySession& session, F12025_PacketExtractor& extractor, F1TimingModel* pTiming);
+
+   // record header at offset, false if there is no complete record
+   bool m_RecordAt(uint64_t offset, CaptureRecordHeader& rec) const;
+
+   // decoded payload of the datagram record at offset, the records must be passed in file order
+   const uint8_t* m_Payload(uint64_t offset, const CaptureRecordHeader& rec, unsigned& len);
+
+   // start at the index entry and walk the records until stop(record header, packet header, header complete) is true
+   template<typename STOP>
+   bool m_SeekFrom(const ReplaySession& session, size_t entry, STOP&& stop);
+
+   F1MappedFile m_file;
+   std::vector<CaptureIndexEntry> m_index;
+   std::vector<ReplaySession> m_sessions;
+   std::vector<CaptureIndexEntry> m_checkpoints;
+   const CaptureIndexEntry* m_pRestored{ nullptr };
+   uint64_t m_dataBegin{ 0 };
+   uint64_t m_dataEnd{ 0 };
+   uint64_t m_records{ 0 };
+
+   bool m_delta{ false };
+   CaptureDeltaCodec m_codec;
+   std::vector<uint8_t> m_batch;
+   std::vector<std::pair<unsigned, size_t>> m_batchDecoded; // datagram, position in m_batch
+
+   uint64_t m_offset{ 0 };   // of the next record
+   uint64_t m_position{ 0 }; // record number of the next record
+};
+
+template<typename FUNC>
+unsigned F1ReplayEngine::Replay(F12025_PacketExtractor& extractor, unsigned maxCount, FUNC&& onPacket)
+{
+   DatagramDesc datagrams[cs_headerScanMax];
+   PacketResult results[cs_headerScanMax];
+   unsigned total = 0;
+
+   while (total < maxCount)
+   {
+      const unsigned n = NextBatch(datagrams, (maxCount - total < cs_headerScanMax) ? maxCount - total : cs_headerScanMax);
+      if (!n)
+         break;
+
+      extractor.ProceedBatch(datagrams, n, results, onPacket);
+      total += n;
+   }
+   return total;
+}
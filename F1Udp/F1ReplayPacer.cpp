@@ -0,0 +1,317 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1ReplayPacer.h"
+#include "F1DataDefs.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <time.h>
+#include <errno.h>
+#endif
+
+#include <string.h>
+
+namespace
+{
+   constexpr uint64_t cs_sliceNs = 10'000'000; // the controls are checked at least this often while waiting
+   constexpr uint32_t cs_noFrame = 0xFFFFFFFF;
+
+#ifdef _WIN32
+   constexpr uint64_t cs_defaultSpinNs = 500'000; // the high resolution timer wakes up to ~0.5 ms late
+#else
+   constexpr uint64_t cs_defaultSpinNs = 0;
+#endif
+
+   uint32_t s_Frame(const DatagramDesc& datagram)
+   {
+      if (!datagram.pData || (datagram.len < sizeof(PacketHeader)))
+         return cs_noFrame;
+
+      PacketHeader hdr;
+      memcpy(&hdr, datagram.pData, sizeof(hdr));
+      return hdr.m_overallFrameIdentifier;
+   }
+
+   void s_Pause()
+   {
+#if defined(_WIN32)
+      YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+   }
+}
+
+uint64_t F1PacerStats::AbsErrorPercentileNs(double p) const
+{
+   if (!paced)
+      return 0;
+
+   const uint64_t target = static_cast<uint64_t>(p * paced + 0.999999);
+   uint64_t cnt = 0;
+   for (unsigned i = 0; i < cs_pacerHistogramBuckets; ++i)
+   {
+      cnt += absErrorHistogram[i];
+      if (cnt >= target)
+         return 1ull << i;
+   }
+   return 1ull << (cs_pacerHistogramBuckets - 1);
+}
+
+#ifdef _WIN32
+
+struct F1ReplayPacer::Impl
+{
+   HANDLE timer{ nullptr };
+};
+
+F1ReplayPacer::F1ReplayPacer() : spinNs(cs_defaultSpinNs), m_impl(std::make_unique<Impl>())
+{
+   m_impl->timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+   if (!m_impl->timer) // before Windows 10 1803
+      m_impl->timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+}
+
+F1ReplayPacer::~F1ReplayPacer()
+{
+   if (m_impl->timer)
+      CloseHandle(m_impl->timer);
+}
+
+uint64_t F1ReplayPacer::NowNs()
+{
+   static const uint64_t freq = []() { LARGE_INTEGER f; QueryPerformanceFrequency(&f); return static_cast<uint64_t>(f.QuadPart); }();
+
+   LARGE_INTEGER cnt;
+   QueryPerformanceCounter(&cnt);
+   const uint64_t ticks = static_cast<uint64_t>(cnt.QuadPart);
+   return (ticks / freq) * 1000000000 + (ticks % freq) * 1000000000 / freq;
+}
+
+void F1ReplayPacer::m_Sleep(uint64_t untilNs)
+{
+   const uint64_t now = NowNs();
+   if ((untilNs <= now) || !m_impl->timer)
+      return;
+
+   LARGE_INTEGER due;
+   due.QuadPart = -static_cast<LONGLONG>((untilNs - now) / 100); // relative, 100 ns units
+   if (due.QuadPart && SetWaitableTimer(m_impl->timer, &due, 0, nullptr, nullptr, FALSE))
+      WaitForSingleObject(m_impl->timer, INFINITE);
+}
+
+#else
+
+struct F1ReplayPacer::Impl
+{
+};
+
+F1ReplayPacer::F1ReplayPacer() : spinNs(cs_defaultSpinNs), m_impl(std::make_unique<Impl>())
+{
+}
+
+F1ReplayPacer::~F1ReplayPacer() = default;
+
+uint64_t F1ReplayPacer::NowNs()
+{
+   timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void F1ReplayPacer::m_Sleep(uint64_t untilNs)
+{
+   timespec ts;
+   ts.tv_sec = static_cast<time_t>(untilNs / 1000000000);
+   ts.tv_nsec = static_cast<long>(untilNs % 1000000000);
+   while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+      ;
+}
+
+#endif
+
+bool F1ReplayPacer::Wait(const DatagramDesc& datagram)
+{
+   const uint32_t frame = s_Frame(datagram);
+
+   for (;;)
+   {
+      m_controlSeen = m_control.load(std::memory_order_acquire);
+      if (m_stopped.load(std::memory_order_relaxed))
+         return false;
+
+      if (m_restart.exchange(false) || !m_started)
+      {
+         m_started = true;
+         m_resume = false;
+         m_stepping = false;
+         m_firstTs = m_lastTs = m_anchorTs = datagram.rxTimestampNs;
+         m_anchorNs = NowNs();
+         m_speed = m_speedRequest.load(std::memory_order_relaxed);
+         m_positionNs.store(0, std::memory_order_relaxed);
+      }
+
+      // time stamps going back (e.g. merged pcap files) are released at once
+      const uint64_t ts = (datagram.rxTimestampNs > m_lastTs) ? datagram.rxTimestampNs : m_lastTs;
+
+      if (m_paused.load(std::memory_order_relaxed))
+      {
+         m_resume = true;
+         if (m_stepping && (frame == m_stepFrame))
+         {
+            m_Release(ts, nullptr);
+            return true;
+         }
+
+         m_stepping = false;
+         uint32_t steps = m_steps.load(std::memory_order_relaxed);
+         while (steps && !m_steps.compare_exchange_weak(steps, steps - 1))
+            ;
+         if (steps)
+         {
+            m_stepping = true;
+            m_stepFrame = frame;
+            m_Release(ts, nullptr);
+            return true;
+         }
+
+         m_SleepUntil(NowNs() + cs_sliceNs);
+         continue;
+      }
+
+      if (m_resume)
+      {
+         // continue with the datagram after the last released one
+         m_resume = false;
+         m_stepping = false;
+         m_anchorNs = NowNs();
+         m_anchorTs = m_lastTs;
+      }
+
+      const double speed = m_speedRequest.load(std::memory_order_relaxed);
+      if (speed != m_speed)
+      {
+         // the new speed applies from the last released datagram on
+         m_anchorNs = m_Deadline(m_lastTs);
+         m_anchorTs = m_lastTs;
+         m_speed = speed;
+      }
+
+      if (ts - m_lastTs > maxGapNs)
+      {
+         m_anchorNs = NowNs();
+         m_anchorTs = ts;
+      }
+
+      const uint64_t deadline = m_Deadline(ts);
+      if (!m_SleepUntil(deadline))
+         continue; // a control changed
+
+      m_Release(ts, &deadline);
+      return true;
+   }
+}
+
+uint64_t F1ReplayPacer::m_Deadline(uint64_t ts) const
+{
+   return m_anchorNs + static_cast<uint64_t>((ts - m_anchorTs) / m_speed);
+}
+
+bool F1ReplayPacer::m_SleepUntil(uint64_t deadlineNs)
+{
+   for (;;)
+   {
+      if (m_control.load(std::memory_order_acquire) != m_controlSeen)
+         return false;
+
+      const uint64_t now = NowNs();
+      if (now >= deadlineNs)
+         return true;
+
+      if (deadlineNs - now > spinNs)
+      {
+         uint64_t until = deadlineNs - spinNs;
+         if (until - now > cs_sliceNs)
+            until = now + cs_sliceNs;
+         m_Sleep(until);
+      }
+      else
+         s_Pause();
+   }
+}
+
+void F1ReplayPacer::m_Release(uint64_t ts, const uint64_t* pDeadline)
+{
+   if (pDeadline)
+   {
+      const int64_t errorNs = static_cast<int64_t>(NowNs() - *pDeadline);
+      if (!m_stats.paced || (errorNs < m_stats.errorMinNs))
+         m_stats.errorMinNs = errorNs;
+      if (!m_stats.paced || (errorNs > m_stats.errorMaxNs))
+         m_stats.errorMaxNs = errorNs;
+      m_stats.errorSumNs += errorNs;
+      ++m_stats.paced;
+      if (errorNs > static_cast<int64_t>(cs_pacerLateNs))
+         ++m_stats.late;
+
+      const uint64_t absError = (errorNs < 0) ? static_cast<uint64_t>(-errorNs) : static_cast<uint64_t>(errorNs);
+      unsigned bucket = 0;
+      while ((bucket < cs_pacerHistogramBuckets - 1) && (absError >> bucket))
+         ++bucket;
+      ++m_stats.absErrorHistogram[bucket];
+   }
+   else
+      ++m_stats.stepped;
+
+   m_lastTs = ts;
+   m_positionNs.store(ts - m_firstTs, std::memory_order_relaxed);
+   m_published.Store(m_stats);
+}
+
+void F1ReplayPacer::SetSpeed(double speed)
+{
+   if (speed < cs_pacerMinSpeed)
+      speed = cs_pacerMinSpeed;
+   if (speed > cs_pacerMaxSpeed)
+      speed = cs_pacerMaxSpeed;
+
+   m_speedRequest.store(speed, std::memory_order_relaxed);
+   m_control.fetch_add(1, std::memory_order_release);
+}
+
+void F1ReplayPacer::Pause(bool pause)
+{
+   m_paused.store(pause, std::memory_order_relaxed);
+   m_control.fetch_add(1, std::memory_order_release);
+}
+
+void F1ReplayPacer::StepFrame()
+{
+   m_steps.fetch_add(1, std::memory_order_relaxed);
+   m_control.fetch_add(1, std::memory_order_release);
+}
+
+void F1ReplayPacer::Stop()
+{
+   m_stopped.store(true, std::memory_order_relaxed);
+   m_control.fetch_add(1, std::memory_order_release);
+}
+
+void F1ReplayPacer::Restart()
+{
+   m_stopped.store(false, std::memory_order_relaxed);
+   m_restart.store(true, std::memory_order_relaxed);
+   m_control.fetch_add(1, std::memory_order_release);
+}
+
+F1PacerStats F1ReplayPacer::Stats() const
+{
+   F1PacerStats stats;
+   m_published.Load(stats);
+   return stats;
+}
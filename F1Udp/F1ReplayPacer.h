@@ -0,0 +1,119 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include "F1PacketExtractor.h"
+#include "F1SeqLock.h"
+
+inline constexpr double cs_pacerMinSpeed = 0.1;
+inline constexpr double cs_pacerMaxSpeed = 50.0;
+inline constexpr uint64_t cs_pacerLateNs = 1'000'000;
+inline constexpr unsigned cs_pacerHistogramBuckets = 32;
+
+// achieved - target release time of the paced datagrams
+struct F1PacerStats
+{
+   uint64_t paced{ 0 };   // released at a deadline
+   uint64_t late{ 0 };    // released more than cs_pacerLateNs after the deadline
+   uint64_t stepped{ 0 }; // released by StepFrame(), not in the error statistics
+   int64_t errorMinNs{ 0 };
+   int64_t errorMaxNs{ 0 };
+   int64_t errorSumNs{ 0 };
+   uint64_t absErrorHistogram[cs_pacerHistogramBuckets]{}; // bucket i: |error| < 2^i ns, the last one takes the rest
+
+   double MeanErrorUs() const { return paced ? errorSumNs / 1000.0 / paced : 0.0; }
+
+   // upper bound of |error| for the fraction p (e.g. 0.99) of the paced datagrams, bucket resolution
+   uint64_t AbsErrorPercentileNs(double p) const;
+};
+
+// Releases datagrams at the time of their capture timestamps (DatagramDesc::rxTimestampNs), scaled by the speed.
+// The deadlines are absolute, start of the playback + (timestamp - first timestamp) / speed, so the wake-up latency
+// of one datagram does not shift the following ones. Gaps longer than maxGapNs (capture time, e.g. the game was
+// paused) are skipped.
+// Linux: clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME), Windows: high resolution waitable timer. The last spinNs
+// before a deadline are spun for precision.
+// Wait() is called by one playback thread, the controls by any thread.
+class F1ReplayPacer
+{
+public:
+   F1ReplayPacer();
+   ~F1ReplayPacer();
+   F1ReplayPacer(const F1ReplayPacer&) = delete;
+   F1ReplayPacer& operator=(const F1ReplayPacer&) = delete;
+
+   // --- playback thread ---
+
+   // returns when the datagram is due, false if Stop() was called meanwhile
+   bool Wait(const DatagramDesc& datagram);
+
+   // --- any thread ---
+
+   // clamped to cs_pacerMinSpeed..cs_pacerMaxSpeed, applies from the last released datagram on
+   void SetSpeed(double speed);
+   double Speed() const { return m_speedRequest.load(std::memory_order_relaxed); }
+
+   void Pause(bool pause);
+   bool Paused() const { return m_paused.load(std::memory_order_relaxed); }
+
+   // while paused: release the datagrams of the next frame (m_overallFrameIdentifier)
+   void StepFrame();
+
+   // the waiting and all further Wait() calls return false until Restart()
+   void Stop();
+   bool Stopped() const { return m_stopped.load(std::memory_order_relaxed); }
+
+   // the next Wait() starts a new timeline at its datagram, e.g. after a rewind. The statistics are kept.
+   void Restart();
+
+   // capture time of the last released datagram since the first one
+   uint64_t PositionNs() const { return m_positionNs.load(std::memory_order_relaxed); }
+
+   F1PacerStats Stats() const;
+
+   // monotonic clock of the deadlines
+   static uint64_t NowNs();
+
+   // set before the playback starts
+   uint64_t spinNs;
+   uint64_t maxGapNs{ 3'000'000'000ull };
+
+private:
+   // sleeps until deadlineNs or until a control changed, false for the latter
+   bool m_SleepUntil(uint64_t deadlineNs);
+   uint64_t m_Deadline(uint64_t ts) const;
+   void m_Sleep(uint64_t untilNs); // platform timer, absolute monotonic time
+
+   // pDeadline: nullptr for a stepped datagram
+   void m_Release(uint64_t ts, const uint64_t* pDeadline);
+
+   struct Impl; // platform timer
+   std::unique_ptr<Impl> m_impl;
+
+   // playback thread
+   bool m_started{ false };
+   uint64_t m_firstTs{ 0 };
+   uint64_t m_lastTs{ 0 };       // capture time of the last released datagram
+   uint64_t m_anchorNs{ 0 };     // deadline of m_anchorTs
+   uint64_t m_anchorTs{ 0 };
+   double m_speed{ 1.0 };
+   bool m_resume{ false };      // re-anchor the timeline after a pause
+   bool m_stepping{ false };
+   uint32_t m_stepFrame{ 0 };
+   uint32_t m_controlSeen{ 0 };
+   F1PacerStats m_stats;
+
+   // controls
+   std::atomic<uint32_t> m_control{ 0 }; // incremented with every change
+   std::atomic<double> m_speedRequest{ 1.0 };
+   std::atomic<bool> m_paused{ false };
+   std::atomic<bool> m_stopped{ false };
+   std::atomic<bool> m_restart{ false };
+   std::atomic<uint32_t> m_steps{ 0 };
+
+   std::atomic<uint64_t> m_positionNs{ 0 };
+   SeqLock<F1PacerStats> m_published;
+};
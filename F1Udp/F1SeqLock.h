@@ -0,0 +1,83 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Sequence lock for one writer and any number of readers.
+// The writer never blocks, readers retry while a write is in progress.
+// The value is stored as atomic words, so a torn read is detected by the sequence and never a data race.
+template<typename T>
+class SeqLock
+{
+   static_assert(std::is_trivially_copyable_v<T>, "seqlock values are copied word by word");
+
+public:
+   SeqLock() = default;
+   SeqLock(const SeqLock&) = delete;
+   SeqLock& operator=(const SeqLock&) = delete;
+
+   // single writer only
+   void Store(const T& val)
+   {
+      uint32_t seq = m_seq.load(std::memory_order_relaxed);
+      m_seq.store(seq + 1, std::memory_order_relaxed); // odd: write in progress
+      std::atomic_thread_fence(std::memory_order_release);
+
+      uint64_t word;
+      const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(&val);
+      for (unsigned i = 0; i < WORDS; ++i)
+      {
+         word = 0;
+         memcpy(&word, pSrc + i * sizeof(uint64_t), s_WordSize(i));
+         m_words[i].store(word, std::memory_order_relaxed);
+      }
+
+      m_seq.store(seq + 2, std::memory_order_release);
+   }
+
+   // one attempt, false if the writer was active meanwhile
+   bool TryLoad(T& val) const
+   {
+      uint32_t seq = m_seq.load(std::memory_order_acquire);
+      if (seq & 1)
+         return false;
+
+      uint8_t* pDst = reinterpret_cast<uint8_t*>(&val);
+      for (unsigned i = 0; i < WORDS; ++i)
+      {
+         uint64_t word = m_words[i].load(std::memory_order_relaxed);
+         memcpy(pDst + i * sizeof(uint64_t), &word, s_WordSize(i));
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return m_seq.load(std::memory_order_relaxed) == seq;
+   }
+
+   // retries until a consistent copy was taken, returns the number of retries
+   unsigned Load(T& val) const
+   {
+      unsigned retries = 0;
+      while (!TryLoad(val))
+         ++retries;
+
+      return retries;
+   }
+
+   // incremented by 2 with every Store(), 0: never written
+   uint32_t Sequence() const { return m_seq.load(std::memory_order_acquire); }
+
+private:
+   static constexpr unsigned WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+   static constexpr unsigned s_WordSize(unsigned i)
+   {
+      return ((i + 1) * sizeof(uint64_t) <= sizeof(T)) ? sizeof(uint64_t) : sizeof(T) - i * sizeof(uint64_t);
+   }
+
+   alignas(64) std::atomic<uint32_t> m_seq{ 0 };
+   alignas(64) std::atomic<uint64_t> m_words[WORDS]{};
+};
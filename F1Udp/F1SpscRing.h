@@ -0,0 +1,259 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include "F1PacketExtractor.h"
+
+enum class RingOverflowPolicy
+{
+   DropNewest, // a datagram which does not fit is dropped and counted (default)
+   Wait        // the producer spins until the consumer made room or waitTimeoutUs elapsed, then drops
+};
+
+struct F1SpscRingStats
+{
+   uint64_t pushed{ 0 };
+   uint64_t dropped{ 0 };
+   uint64_t popped{ 0 };
+   uint64_t highWaterBytes{ 0 }; // max fill level seen by the consumer
+};
+
+// Fixed capacity byte ring for datagrams, one producer thread (receive) and one consumer thread (parser).
+// Datagrams are written in place with Reserve() / Commit() and consumed in place with Peek() / Release(),
+// thus no allocation happens after construction.
+// Every record is [RecordHeader][payload] padded to 16 bytes, a record never wraps around the end of the buffer.
+class F1SpscRing
+{
+public:
+   static constexpr unsigned CACHE_LINE = 64;
+
+   // capacity is rounded up to a power of 2
+   explicit F1SpscRing(size_t capacityBytes = 4 * 1024 * 1024, RingOverflowPolicy policy = RingOverflowPolicy::DropNewest) :
+      m_capacity(s_RoundUpPow2(capacityBytes < 4096 ? 4096 : capacityBytes)),
+      m_mask(m_capacity - 1),
+      m_buffer(new uint8_t[m_capacity]),
+      m_policy(policy)
+   {
+   }
+
+   F1SpscRing(const F1SpscRing&) = delete;
+   F1SpscRing& operator=(const F1SpscRing&) = delete;
+
+   // --- producer ---
+
+   // room for a datagram of up to maxLen bytes, nullptr if it does not fit (counted as dropped)
+   uint8_t* Reserve(unsigned maxLen)
+   {
+      const uint64_t rec = s_RecordSize(maxLen);
+      const uint64_t pos = m_head.pos.load(std::memory_order_relaxed);
+      const uint64_t toEnd = m_capacity - (pos & m_mask);
+      const uint64_t pad = (toEnd < rec) ? toEnd : 0;
+
+      if ((rec > m_capacity / 2) || !m_WaitForSpace(pos, pad + rec))
+      {
+         ++m_head.dropped;
+         m_PublishProducerStats();
+         return nullptr;
+      }
+
+      if (pad)
+         m_WriteHeader(pos, RecordHeader{ WRAP, 0, 0 });
+
+      m_head.reservedPos = pos + pad;
+      m_head.reservedLen = maxLen;
+      return m_buffer.get() + ((pos + pad) & m_mask) + sizeof(RecordHeader);
+   }
+
+   // publish the datagram written to the last Reserve(), len <= maxLen
+   void Commit(unsigned len, uint64_t rxTimestampNs = 0)
+   {
+      if (len > m_head.reservedLen)
+         len = m_head.reservedLen;
+
+      const uint64_t pos = m_head.reservedPos;
+      m_WriteHeader(pos, RecordHeader{ len, 0, rxTimestampNs });
+
+      const uint64_t newHead = pos + s_RecordSize(len);
+      m_head.pos.store(newHead, std::memory_order_release);
+
+      ++m_head.pushed;
+      m_PublishProducerStats();
+   }
+
+   bool Push(const uint8_t* pData, unsigned len, uint64_t rxTimestampNs = 0)
+   {
+      uint8_t* pDst = Reserve(len);
+      if (!pDst)
+         return false;
+
+      memcpy(pDst, pData, len);
+      Commit(len, rxTimestampNs);
+      return true;
+   }
+
+   // --- consumer ---
+
+   // descriptors of up to maxCount queued datagrams, they point into the ring and stay valid until Release()
+   unsigned Peek(DatagramDesc* pDescs, unsigned maxCount)
+   {
+      const uint64_t head = m_tail.cachedHead = m_head.pos.load(std::memory_order_acquire);
+      uint64_t pos = m_tail.pos.load(std::memory_order_relaxed);
+      unsigned cnt = 0;
+
+      // the producer only knows a stale tail, the fill level is exact here
+      if (head - pos > m_tail.highWater)
+      {
+         m_tail.highWater = head - pos;
+         m_tail.highWaterShared.store(m_tail.highWater, std::memory_order_relaxed);
+      }
+
+      while ((pos != head) && (cnt < maxCount))
+      {
+         RecordHeader hdr;
+         memcpy(&hdr, m_buffer.get() + (pos & m_mask), sizeof(hdr));
+         if (hdr.len == WRAP)
+         {
+            pos += m_capacity - (pos & m_mask);
+            continue;
+         }
+
+         DatagramDesc& desc = pDescs[cnt++];
+         desc.pData = m_buffer.get() + (pos & m_mask) + sizeof(RecordHeader);
+         desc.len = hdr.len;
+         desc.rxTimestampNs = hdr.rxTimestampNs;
+         pos += s_RecordSize(hdr.len);
+      }
+
+      m_tail.peekEnd = pos;
+      m_tail.peeked = cnt;
+      return cnt;
+   }
+
+   // free everything returned by the last Peek()
+   void Release()
+   {
+      m_tail.popped += m_tail.peeked;
+      m_tail.peeked = 0;
+      m_tail.pos.store(m_tail.peekEnd, std::memory_order_release);
+      m_tail.poppedShared.store(m_tail.popped, std::memory_order_relaxed);
+   }
+
+   // --- any thread ---
+
+   bool Empty() const
+   {
+      return m_head.pos.load(std::memory_order_acquire) == m_tail.pos.load(std::memory_order_acquire);
+   }
+
+   size_t Capacity() const { return m_capacity; }
+
+   // counters are updated with relaxed stores, thus only approximately in sync with each other
+   F1SpscRingStats Stats() const
+   {
+      F1SpscRingStats stats;
+      stats.pushed = m_head.pushedShared.load(std::memory_order_relaxed);
+      stats.dropped = m_head.droppedShared.load(std::memory_order_relaxed);
+      stats.highWaterBytes = m_tail.highWaterShared.load(std::memory_order_relaxed);
+      stats.popped = m_tail.poppedShared.load(std::memory_order_relaxed);
+      return stats;
+   }
+
+   unsigned waitTimeoutUs{ 1000 }; // only for RingOverflowPolicy::Wait
+
+private:
+   static constexpr uint32_t WRAP = 0xFFFFFFFF; // rest of the buffer is unused, continue at offset 0
+
+   struct RecordHeader
+   {
+      uint32_t len;
+      uint32_t reserved;
+      uint64_t rxTimestampNs;
+   };
+   static_assert(sizeof(RecordHeader) == 16, "records are 16 byte aligned");
+
+   static uint64_t s_RecordSize(unsigned len) { return (sizeof(RecordHeader) + len + 15) & ~uint64_t(15); }
+
+   static size_t s_RoundUpPow2(size_t val)
+   {
+      size_t res = 1;
+      while (res < val)
+         res <<= 1;
+      return res;
+   }
+
+   void m_WriteHeader(uint64_t pos, const RecordHeader& hdr)
+   {
+      memcpy(m_buffer.get() + (pos & m_mask), &hdr, sizeof(hdr));
+   }
+
+   bool m_HasSpace(uint64_t pos, uint64_t need)
+   {
+      if (pos + need - m_head.cachedTail <= m_capacity)
+         return true;
+
+      m_head.cachedTail = m_tail.pos.load(std::memory_order_acquire);
+      return pos + need - m_head.cachedTail <= m_capacity;
+   }
+
+   bool m_WaitForSpace(uint64_t pos, uint64_t need)
+   {
+      if (m_HasSpace(pos, need))
+         return true;
+
+      if (m_policy != RingOverflowPolicy::Wait)
+         return false;
+
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(waitTimeoutUs);
+      while (std::chrono::steady_clock::now() < deadline)
+      {
+         if (m_HasSpace(pos, need))
+            return true;
+      }
+      return false;
+   }
+
+   void m_PublishProducerStats()
+   {
+      m_head.pushedShared.store(m_head.pushed, std::memory_order_relaxed);
+      m_head.droppedShared.store(m_head.dropped, std::memory_order_relaxed);
+   }
+
+   // written by the producer only
+   struct alignas(CACHE_LINE) Producer
+   {
+      std::atomic<uint64_t> pos{ 0 };
+      uint64_t cachedTail{ 0 };
+      uint64_t reservedPos{ 0 };
+      unsigned reservedLen{ 0 };
+      uint64_t pushed{ 0 };
+      uint64_t dropped{ 0 };
+      std::atomic<uint64_t> pushedShared{ 0 };
+      std::atomic<uint64_t> droppedShared{ 0 };
+   };
+
+   // written by the consumer only
+   struct alignas(CACHE_LINE) Consumer
+   {
+      std::atomic<uint64_t> pos{ 0 };
+      uint64_t cachedHead{ 0 };
+      uint64_t peekEnd{ 0 };
+      unsigned peeked{ 0 };
+      uint64_t popped{ 0 };
+      uint64_t highWater{ 0 };
+      std::atomic<uint64_t> poppedShared{ 0 };
+      std::atomic<uint64_t> highWaterShared{ 0 };
+   };
+
+   const size_t m_capacity;
+   const uint64_t m_mask;
+   std::unique_ptr<uint8_t[]> m_buffer;
+   RingOverflowPolicy m_policy;
+
+   Producer m_head;
+   Consumer m_tail;
+};
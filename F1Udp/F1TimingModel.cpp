@@ -0,0 +1,918 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1TimingModel.h"
+#include "F1PacketRegistry.h"
+
+#include <string.h>
+#include <algorithm>
+
+namespace
+{
+   // m_penaltyType values, see PenaltyTypes
+   constexpr uint8_t cs_penaltyDriveThrough = 0;
+   constexpr uint8_t cs_penaltyStopGo = 1;
+   constexpr uint8_t cs_penaltyDisqualified = 6;
+   constexpr uint8_t cs_penaltyRetired = 16;
+   constexpr uint8_t cs_infringementPitLaneSpeeding = 20;
+   constexpr int8_t cs_trackCount = 32; // Track::numEntries of F1DataDefsClr.h
+
+   bool s_IsEvent(const PacketEventData& evt, const char* pCode)
+   {
+      return !strncmp(reinterpret_cast<const char*>(evt.m_eventStringCode), pCode, 4);
+   }
+}
+
+void TimingDriver::Reset(unsigned driverId)
+{
+   *this = TimingDriver{};
+   id = driverId;
+}
+
+F1TimingModel::F1TimingModel()
+   : m_frames(PacketBit(PacketType::PacketLapData) | PacketBit(PacketType::PacketCarStatusData))
+{
+   Clear();
+}
+
+void F1TimingModel::ContinueSession(uint64_t sessionUID, float connectTime)
+{
+   m_sessionId = sessionUID;
+   m_sessionConnectTime = connectTime;
+
+   timingTable.Clear();
+   for (unsigned i = 0; i < drivers.size(); ++i)
+      m_UpdateCrossings(i, 0, cs_timingMaxLaps - 1);
+   gaps.Clear();
+   dirtyFields.Reset();
+}
+
+bool F1TimingModel::IsQualifyingOrPractice(uint8_t sessionType)
+{
+   // P1 .. ShortQ
+   return (sessionType >= 1) && (sessionType <= 8);
+}
+
+void F1TimingModel::Clear()
+{
+   session.finished = false;
+   session.currentLap = 1;
+   session.fastestSector1 = 999.0;
+   session.fastestSector2 = 999.0;
+   session.fastestSector3 = 999.0;
+   session.countDrivers = 0;
+   events.clear();
+   timingTable.Clear();
+   gaps.Clear();
+   dirtyFields.Reset();
+   m_frames.Reset();
+
+   for (unsigned i = 0; i < drivers.size(); ++i)
+      drivers[i].Reset(i);
+
+   m_published.fill(F1ChangeCar{});
+   changes.Push(F1Change{ m_pEx ? m_pEx->sessionTime : 0.f, cs_changeSession, ChangeField::SessionReset, 0, 0.0 });
+}
+
+void F1TimingModel::Apply(F12025_PacketExtractor& extractor, PacketType type, uint64_t nowNs)
+{
+   m_pEx = &extractor;
+   const PacketHeader& hdr = extractor.lastHeader;
+
+   if ((type != PacketType::UnknownOrIllformed) && (m_sessionId != hdr.m_sessionUID) && hdr.m_sessionUID)
+   {
+      Clear();
+      m_sessionId = hdr.m_sessionUID;
+      m_sessionConnectTime = hdr.m_sessionTime;
+   }
+
+   switch (type)
+   {
+   case PacketType::PacketMotionData:
+   case PacketType::PacketCarSetupData:
+   case PacketType::PacketLobbyInfoData:
+   case PacketType::PacketMotionExData:
+   case PacketType::PacketTimeTrialData:
+   case PacketType::UnknownOrIllformed:
+      break;
+
+   default:
+      if (extractor.mode == ExtractMode::View)
+         extractor.Retain(extractor.lastPacket);
+      break;
+   }
+
+   switch (type)
+   {
+   case PacketType::PacketSessionData:
+      m_UpdateSession();
+      break;
+
+   case PacketType::PacketLapData:
+      if (IsQualifyingOrPractice(session.sessionType))
+         m_UpdateLapQuali();
+      else
+         m_UpdateLapRace();
+      break;
+
+   case PacketType::PacketEventData:
+      m_UpdateEventData();
+      break;
+
+   case PacketType::PacketParticipantsData:
+      m_UpdateParticipants();
+      break;
+
+   case PacketType::PacketCarTelemetryData:
+      for (unsigned i = 0; i < drivers.size(); ++i)
+      {
+         m_UpdateTelemetry(i);
+         m_UpdateTyreDamage(i);
+      }
+      break;
+
+   case PacketType::PacketLobbyInfoData:
+      m_UpdateDrivers();
+      break;
+
+   case PacketType::PacketCarDamageData:
+      for (unsigned i = 0; i < drivers.size(); ++i)
+      {
+         m_UpdateDamage(i);
+         m_UpdateTyreDamage(i);
+      }
+      break;
+
+   case PacketType::PacketSessionHistoryData:
+      if (IsQualifyingOrPractice(session.sessionType))
+         m_UpdateHistoryDataQuali();
+      else
+         m_UpdateHistoryDataRace();
+      break;
+
+   default:
+      break;
+   }
+
+   // after the updates above, so the drivers use the timing and crossings of the packet which completed the frame
+   if ((type != PacketType::UnknownOrIllformed) && m_frames.Add(extractor.lastPacket, nowNs))
+      m_UpdateDrivers();
+
+   // the drivers change with the frames and with the laps of the lap data and the history
+   switch (type)
+   {
+   case PacketType::PacketLapData:
+   case PacketType::PacketCarStatusData:
+   case PacketType::PacketLobbyInfoData:
+   case PacketType::PacketSessionHistoryData:
+      m_PublishChanges();
+      break;
+
+   default:
+      break;
+   }
+   m_pEx = nullptr;
+}
+
+void F1TimingModel::Poll(const F12025_PacketExtractor& extractor, uint64_t nowNs)
+{
+   m_pEx = &extractor;
+   if (m_frames.Poll(nowNs))
+   {
+      m_UpdateDrivers();
+      m_PublishChanges();
+   }
+   m_pEx = nullptr;
+}
+
+void F1TimingModel::m_UpdateDrivers()
+{
+   ++driverUpdates;
+   const PacketLapData& lap = m_frames.Current().lap;
+   const PacketCarStatusData& status = m_frames.Current().status;
+   dirtyFields.Update(lap, status);
+
+   TimingDriver* pPlayer = nullptr;
+   if (lap.m_header.m_playerCarIndex < drivers.size()) // in visitor modes index is 255
+      pPlayer = &drivers[lap.m_header.m_playerCarIndex];
+
+   const bool qualifyingDelta = IsQualifyingOrPractice(session.sessionType);
+
+   // find present drivers + set position and penalties, which the deltas below take of the reference cars
+   for (unsigned i = 0; i < drivers.size(); ++i)
+   {
+      TimingDriver& car = drivers[i];
+      const uint32_t dirty = dirtyFields.Dirty(i);
+      if (!(dirty & (cs_fieldPresent | cs_fieldTrackPosition | cs_fieldPenalties)))
+         continue;
+
+      if ((lap.m_lapData[i].m_resultStatus > 0) && (lap.m_lapData[i].m_resultStatus < 4))
+         car.present = true;
+
+      float pos = lap.m_lapData[i].m_lapDistance;
+      if (pos < 0.f)
+         pos = session.trackLength + pos;
+
+      pos /= session.trackLength;
+      if (pos > 1.f)
+         pos = 1.f;
+
+      car.trackPositionPerc = pos;
+
+      if (car.present)
+      {
+         car.locationOnTrack = lap.m_lapData[i].m_lapDistance;
+         car.penaltySeconds = lap.m_lapData[i].m_penalties;
+      }
+   }
+
+   TimingDriver* pLeader = nullptr;
+   for (TimingDriver& car : drivers)
+   {
+      if (car.pos == 1)
+      {
+         pLeader = &car;
+         pLeader->timedeltaToLeader = 0;
+         break;
+      }
+   }
+
+   // the player index defaults to 0 and may change with the first actual packet
+   if (lap.m_header.m_playerCarIndex != 0)
+      drivers[0].isPlayer = false;
+
+   if (pPlayer)
+   {
+      pPlayer->isPlayer = true;
+      pPlayer->timedeltaToPlayer = 0;
+
+      if (!pPlayer->lapNr)
+      {
+         dirtyFields.TouchAll(cs_fieldAll); // nothing is applied before the first lap
+         return;
+      }
+   }
+
+   // the deltas also change with the reference car
+   const uint32_t playerDirty = dirtyFields.Player(pPlayer ? static_cast<int>(pPlayer->id) : -1);
+   const uint32_t leaderDirty = dirtyFields.Leader(pLeader ? static_cast<int>(pLeader->id) : -1);
+
+   for (unsigned i = 0; i < drivers.size(); ++i)
+   {
+      TimingDriver& car = drivers[i];
+      if (!car.present)
+         continue;
+
+      uint32_t dirty = dirtyFields.Dirty(i);
+      if (dirty & cs_fieldPresent)
+         dirty = cs_fieldAll; // the fields of the car were not applied while it was not present
+
+      // delta to player, 0 for the cars which are out
+      if ((dirty | playerDirty) & cs_fieldsDeltaPlayer)
+      {
+         if (pPlayer)
+         {
+            if (!car.isPlayer && (lap.m_lapData[i].m_resultStatus < 4))
+               qualifyingDelta ? m_UpdateTimeDeltaQualy(*pPlayer, i, true) : m_UpdateTimeDeltaRace(*pPlayer, i, true);
+         }
+         else
+         {
+            car.lastTimedeltaToPlayer = 0;
+            car.timedeltaToPlayer = 0;
+         }
+      }
+
+      // delta to leader
+      if (pLeader && (&car != pLeader) && ((dirty | leaderDirty) & cs_fieldsDeltaLeader))
+         qualifyingDelta ? m_UpdateTimeDeltaQualy(*pLeader, i, false) : m_UpdateTimeDeltaRace(*pLeader, i, false);
+
+      if (dirty & cs_fieldTyre)
+         car.tyre = status.m_carStatusData[i].m_actualTyreCompound;
+      if (dirty & cs_fieldVisualTyre)
+         car.visualTyre = status.m_carStatusData[i].m_visualTyreCompound;
+      if (!qualifyingDelta && car.visualTyres.empty() && car.visualTyre && ((m_pEx->sessionTime - m_sessionConnectTime) > 2))
+      {
+         // joined late to a session: the tyres before are unknown
+         if ((car.lapNr > 1) && ((car.lapNr - car.tyreAge) > 1))
+            car.visualTyres.push_back(0);
+
+         car.visualTyres.push_back(car.visualTyre);
+      }
+
+      if (dirty & cs_fieldTyreAge)
+         car.tyreAge = status.m_carStatusData[i].m_tyresAgeLaps;
+
+      if (!(dirty & cs_fieldStatus))
+         continue;
+
+      const TimingDriverStatus oldStatus = car.status;
+      switch (lap.m_lapData[i].m_resultStatus)
+      {
+      case 4:
+         car.status = TimingDriverStatus::DNF;
+         car.timedeltaToPlayer = 0;
+         break;
+
+      case 5:
+         car.status = TimingDriverStatus::DSQ;
+         car.timedeltaToPlayer = 0;
+         break;
+
+      case 6:
+         car.status = TimingDriverStatus::Garage;
+         car.timedeltaToPlayer = 0;
+         break;
+
+      case 7:
+         if (!car.pitPenalties.empty() && (events[car.pitPenalties.back()].penaltyType == cs_penaltyRetired))
+            car.status = TimingDriverStatus::DNF;
+
+         if (car.status != TimingDriverStatus::DNF)
+            car.status = TimingDriverStatus::Retired;
+         car.timedeltaToPlayer = 0;
+         break;
+
+      default:
+         switch (lap.m_lapData[i].m_pitStatus)
+         {
+         case 1: car.status = TimingDriverStatus::Pitlane; break;
+         case 2: car.status = TimingDriverStatus::Pitting; car.hasPittedLatch = true; break;
+
+         default:
+            switch (lap.m_lapData[i].m_driverStatus)
+            {
+            case 3: car.status = TimingDriverStatus::OutLap; break;
+            case 2: car.status = TimingDriverStatus::Inlap; break;
+            case 1:
+            case 4: car.status = TimingDriverStatus::OnTrack; break;
+            default: car.status = TimingDriverStatus::Garage; break;
+            }
+            break;
+         }
+         break;
+      }
+
+      if (qualifyingDelta)
+      {
+         // quali: the next tyre is taken when an outlap starts
+         if ((oldStatus != TimingDriverStatus::OutLap) && (car.status == TimingDriverStatus::OutLap))
+            car.visualTyres.push_back(car.visualTyre);
+      }
+      else if ((oldStatus == TimingDriverStatus::Pitting) && (car.status != oldStatus))
+         car.visualTyres.push_back(car.visualTyre);
+
+      if ((oldStatus == TimingDriverStatus::Pitlane) && ((car.status == TimingDriverStatus::OnTrack) || (car.status == TimingDriverStatus::OutLap)))
+      {
+         for (uint32_t idx : car.pitPenalties)
+         {
+            TimingEvent& penalty = events[idx];
+            if (penalty.penaltyServed)
+               continue;
+
+            if (!car.hasPittedLatch)
+            {
+               // in pits without pitstop -> probably served a drive through penalty
+               if (penalty.penaltyType == cs_penaltyDriveThrough)
+               {
+                  penalty.penaltyServed = true;
+                  break;
+               }
+            }
+            else if (penalty.penaltyType != cs_penaltyDriveThrough)
+            {
+               // pit lane speeding can not be served on the stop of the infringement
+               if ((penalty.infringementType != cs_infringementPitLaneSpeeding) || ((m_pEx->sessionTime - penalty.timeCode) > 60))
+               {
+                  penalty.penaltyServed = true;
+                  break;
+               }
+            }
+         }
+         car.hasPittedLatch = false;
+      }
+   }
+}
+
+void F1TimingModel::m_UpdateTimeDeltaRace(const TimingDriver& reference, unsigned i, bool toPlayer)
+{
+   TimingDriver& opponent = drivers[i];
+   if (!opponent.present)
+      return;
+
+   // the last sector both cars have
+   float timeReference = 0;
+   float timeOpponent = 0;
+   if (!timingTable.LastCommonCrossing(reference.id, i, (std::min)(reference.lapNr, opponent.lapNr) - 1, timeReference, timeOpponent))
+      return;
+
+   float newDelta = timeReference - timeOpponent;
+   const LapData& lapNative = m_frames.Current().lap.m_lapData[i];
+   if (toPlayer)
+   {
+      // take penalties into consideration
+      newDelta -= lapNative.m_penalties - reference.penaltySeconds;
+
+      if (newDelta != opponent.timedeltaToPlayer)
+      {
+         opponent.lastTimedeltaToPlayer = opponent.timedeltaToPlayer;
+         opponent.timedeltaToPlayer = newDelta;
+      }
+   }
+   else
+   {
+      int lappedCount = reference.lapNr - opponent.lapNr;
+      if (opponent.locationOnTrack > reference.locationOnTrack)
+         --lappedCount;
+
+      if (lappedCount > 0)
+         opponent.timedeltaToLeader = static_cast<float>(-lappedCount); // negative: lapped count
+      else if (!gaps.Gap(reference.id, i, opponent.timedeltaToLeader))
+      {
+         // no live gap (yet): the delta of the game, updated per sector
+         const uint32_t telemetryDelta = lapNative.m_deltaToRaceLeaderMSPart + 60000u * lapNative.m_deltaToRaceLeaderMinutesPart;
+         opponent.timedeltaToLeader = static_cast<float>(telemetryDelta / 1000.0);
+      }
+   }
+}
+
+void F1TimingModel::m_UpdateTimeDeltaQualy(const TimingDriver& reference, unsigned i, bool toPlayer)
+{
+   TimingDriver& opponent = drivers[i];
+   if (!opponent.present)
+      return;
+
+   const float newDelta = static_cast<float>(opponent.FastestLap().lap - reference.FastestLap().lap);
+   if (toPlayer)
+   {
+      if (newDelta != opponent.timedeltaToPlayer)
+      {
+         opponent.lastTimedeltaToPlayer = opponent.timedeltaToPlayer;
+         opponent.timedeltaToPlayer = newDelta;
+      }
+   }
+   else if ((newDelta != opponent.timedeltaToLeader) && (reference.FastestLap().lap != 0) && (newDelta > 0))
+      opponent.timedeltaToLeader = newDelta;
+}
+
+void F1TimingModel::m_UpdateCrossings(unsigned i, int firstLapIdx, int lastLapIdx)
+{
+   const TimingDriver& driver = drivers[i];
+   firstLapIdx = (std::max)(firstLapIdx, 0);
+   lastLapIdx = (std::min)(lastLapIdx, static_cast<int>(cs_timingMaxLaps) - 1);
+
+   for (int k = firstLapIdx; k <= lastLapIdx; ++k)
+   {
+      const TimingLap& lap = driver.laps[k];
+      timingTable.SetLap(i, k, lap.sector1, lap.sector2, lap.lap, k ? driver.laps[k - 1].lapsAccumulated : 0.0);
+   }
+}
+
+void F1TimingModel::m_PublishChanges()
+{
+   for (unsigned i = 0; i < drivers.size(); ++i)
+   {
+      const TimingDriver& driver = drivers[i];
+      const TimingLap& lap = driver.laps[driver.currentLap];
+
+      F1ChangeCar current;
+      current.present = static_cast<uint8_t>(driver.present);
+      current.pos = driver.pos;
+      current.lapNr = driver.lapNr;
+      current.status = static_cast<uint8_t>(driver.status);
+      current.tyre = driver.tyre;
+      current.visualTyre = driver.visualTyre;
+      current.tyreAge = driver.tyreAge;
+      current.penaltySeconds = driver.penaltySeconds;
+      current.timedeltaToPlayer = driver.timedeltaToPlayer;
+      current.timedeltaToLeader = driver.timedeltaToLeader;
+      current.timedeltaToCarAhead = driver.timedeltaToCarAhead;
+      current.currentLap = driver.currentLap;
+      current.sector1 = lap.sector1;
+      current.sector2 = lap.sector2;
+      current.lap = lap.lap;
+      current.fastestLap = driver.FastestLap().lap;
+      changes.PushCar(m_pEx->sessionTime, static_cast<uint8_t>(i), m_published[i], current, driver.laps[m_published[i].currentLap].lap);
+   }
+}
+
+void F1TimingModel::m_UpdateSession()
+{
+   const PacketSessionData& data = m_pEx->Get<PacketSessionData>();
+   if ((session.sessionType != data.m_sessionType) || (session.trackLength != static_cast<float>(data.m_trackLength)))
+      dirtyFields.Reset(); // the positions and deltas of all cars change
+
+   session.track = ((data.m_trackId < cs_trackCount) && (data.m_trackId >= 0)) ? data.m_trackId : -1;
+   session.sessionType = data.m_sessionType;
+   session.remainingTime = data.m_sessionTimeLeft;
+   session.totalLaps = data.m_totalLaps;
+   session.trackLength = static_cast<float>(data.m_trackLength);
+}
+
+void F1TimingModel::m_UpdateLapRace()
+{
+   const PacketLapData& data = m_pEx->Get<PacketLapData>();
+
+   for (unsigned i = 0; i < drivers.size(); ++i)
+   {
+      const LapData& lapNative = data.m_lapData[i];
+      TimingDriver& driver = drivers[i];
+
+      const int lapNumCurrent = lapNative.m_currentLapNum;
+      const int lapNrBefore = driver.lapNr;
+      bool timing = (driver.pos != lapNative.m_carPosition); // the times or positions of the deltas changed
+      driver.pos = lapNative.m_carPosition;
+
+      if ((driver.lapNr != lapNumCurrent) && (lapNumCurrent <= static_cast<int>(cs_timingMaxLaps))) // the mapper throws on more laps
+      {
+         // new lap: take the lap time of the finished one
+         driver.lapNr = lapNumCurrent;
+         timing = true;
+
+         if (driver.lapNr > 0)
+         {
+            if (lapNative.m_lastLapTimeInMS)
+               driver.CurrentLap().lap = lapNative.m_lastLapTimeInMS / 1000.0;
+
+            driver.currentLap = driver.lapNr - 1;
+            TimingLap& current = driver.CurrentLap();
+            current.sector1 = 0;
+            current.sector2 = 0;
+            current.lap = 0;
+            current.invalid = false;
+         }
+
+         if (driver.lapNr > 1)
+         {
+            TimingLap& finished = driver.laps[driver.lapNr - 2];
+            finished.lap = lapNative.m_lastLapTimeInMS / 1000.0;
+
+            if (driver.lapNr == 2)
+               driver.laps[0].lapsAccumulated = driver.laps[0].lap;
+            else
+               finished.lapsAccumulated = finished.lap + driver.laps[driver.lapNr - 3].lapsAccumulated;
+
+            bool isNewFastestLap = (finished.lap < driver.FastestLap().lap) || (driver.FastestLap().lap == 0);
+            isNewFastestLap &= !finished.invalid;
+            if (isNewFastestLap)
+               driver.FastestLap() = finished;
+         }
+      }
+      else if (driver.lapNr > 0)
+      {
+         TimingLap& current = driver.CurrentLap(); // as in the mapper: the lap before the last lap rule below
+         const uint32_t s1 = lapNative.m_sector1TimeMSPart + lapNative.m_sector1TimeMinutesPart * 60000u;
+         const uint32_t s2 = lapNative.m_sector2TimeMSPart + lapNative.m_sector2TimeMinutesPart * 60000u;
+
+         // the lap number does not increase after the last lap, it is finished when the sector times become 0
+         if ((session.totalLaps == driver.lapNr) && (driver.CurrentLap().Sector1Ms() > 0) && !s1 &&
+            (driver.lapNr < static_cast<int>(cs_timingMaxLaps) - 1) && (driver.currentLap == static_cast<unsigned>(driver.lapNr - 1)))
+         {
+            driver.CurrentLap().lap = lapNative.m_lastLapTimeInMS / 1000.0;
+            driver.currentLap = driver.lapNr;
+            timing = true;
+         }
+
+         bool change = false;
+         if (current.Sector1Ms() != s1)
+         {
+            current.sector1 = s1 / 1000.0;
+            change = true;
+         }
+
+         if (current.Sector2Ms() != s2)
+         {
+            current.sector2 = s2 / 1000.0;
+            change = true;
+         }
+
+         if (change)
+            current.lap = 0;
+
+         if (lapNative.m_currentLapInvalid != current.invalid)
+            current.invalid = lapNative.m_currentLapInvalid;
+         timing |= change;
+      }
+
+      // the laps changed above: the finished one, the current one and the one behind the last lap
+      m_UpdateCrossings(i, (std::min)(lapNrBefore, driver.lapNr) - 2, (std::max)(lapNrBefore, driver.lapNr));
+
+      // the lap data of the frame may be applied to the drivers before, or unchanged while the laps still change
+      // (e.g. the sectors after joining a session)
+      if (timing)
+         dirtyFields.Touch(i, cs_fieldTiming);
+
+      if (lapNumCurrent > session.currentLap)
+         session.currentLap = (std::min)(lapNumCurrent, session.totalLaps); // the lap after the finish does not count
+   }
+
+   m_UpdateGaps();
+}
+
+void F1TimingModel::m_UpdateGaps()
+{
+   const PacketLapData& data = m_pEx->Get<PacketLapData>();
+
+   std::array<int, cs_maxNumCarsInUDPData + 1> carAtPos;
+   carAtPos.fill(-1);
+   for (unsigned i = 0; i < drivers.size(); ++i)
+   {
+      const LapData& lapNative = data.m_lapData[i];
+      if (lapNative.m_resultStatus != 2) // active
+         continue;
+
+      gaps.Add(i, lapNative.m_totalDistance, data.m_header.m_sessionTime);
+      dirtyFields.Touch(i, cs_fieldTrackPosition); // the live gaps
+      if (lapNative.m_carPosition <= cs_maxNumCarsInUDPData)
+         carAtPos[lapNative.m_carPosition] = i;
+   }
+
+   if (carAtPos[1] >= 0)
+      drivers[carAtPos[1]].timedeltaToCarAhead = 0;
+
+   for (unsigned pos = 2; pos < carAtPos.size(); ++pos)
+   {
+      const int i = carAtPos[pos];
+      const int ahead = carAtPos[pos - 1];
+      if ((i < 0) || (ahead < 0))
+         continue;
+
+      TimingDriver& car = drivers[i];
+      const float behind = gaps.Distance(ahead) - gaps.Distance(i);
+      if ((session.trackLength > 0) && (behind >= session.trackLength))
+         car.timedeltaToCarAhead = -static_cast<float>(static_cast<int>(behind / session.trackLength));
+      else
+         gaps.Gap(ahead, i, car.timedeltaToCarAhead);
+
+      // the lapped count is left to m_UpdateTimeDeltaRace()
+      const int leader = carAtPos[1];
+      if ((leader >= 0) && (car.timedeltaToLeader >= 0) && (gaps.Distance(leader) - gaps.Distance(i) < session.trackLength))
+         gaps.Gap(leader, i, car.timedeltaToLeader);
+   }
+}
+
+void F1TimingModel::m_UpdateLapQuali()
+{
+   // m_currentLapNum is not reliable in qualifying, the laps are found by the sector times
+   const PacketLapData& data = m_pEx->Get<PacketLapData>();
+
+   for (unsigned i = 0; i < drivers.size(); ++i)
+   {
+      const LapData& lapNative = data.m_lapData[i];
+      TimingDriver& driver = drivers[i];
+      driver.pos = lapNative.m_carPosition;
+      driver.lapNr = lapNative.m_currentLapNum;
+
+      driver.allowLapHistoryQuali = (driver.status == TimingDriverStatus::Garage);
+      if (driver.allowLapHistoryQuali)
+         continue;
+
+      // outlap
+      if (driver.locationOnTrack < 0)
+         continue;
+
+      TimingLap& current = driver.CurrentLap();
+      const bool hasTimes = current.Sector1Ms() || current.Sector2Ms() || (current.lap != 0);
+      if (hasTimes && ((driver.status == TimingDriverStatus::Pitlane) || (driver.status == TimingDriverStatus::Pitting) || (driver.status == TimingDriverStatus::Inlap)))
+      {
+         // the driver enters the pit, the current lap was not finished
+         current.sector1 = 0;
+         current.sector2 = 0;
+         current.lap = 0;
+         current.invalid = false;
+      }
+
+      if (current.Sector1Ms() && current.Sector2Ms() && (lapNative.m_sector1TimeMSPart == 0))
+      {
+         // a lap has been finished
+         current.lap = lapNative.m_lastLapTimeInMS / 1000.0;
+         if (!current.invalid && ((driver.FastestLap().lap == 0) || (current.lap < driver.FastestLap().lap)))
+         {
+            driver.FastestLap() = current;
+            dirtyFields.Touch(i, cs_fieldTiming);
+         }
+
+         // the mapper takes the last unused lap as next one
+         for (unsigned l = 0; l < cs_timingMaxLaps; ++l)
+         {
+            const TimingLap& lap = driver.laps[l];
+            if (lap.Sector1Ms() || lap.Sector2Ms() || (lap.lap != 0))
+               continue;
+
+            driver.currentLap = l;
+            if (!lap.invalid && (lap.Sector3() < session.fastestSector3))
+               session.fastestSector3 = lap.Sector3();
+         }
+      }
+      else
+      {
+         const uint32_t s1 = lapNative.m_sector1TimeMSPart + lapNative.m_sector1TimeMinutesPart * 60000u;
+         const uint32_t s2 = lapNative.m_sector2TimeMSPart + lapNative.m_sector2TimeMinutesPart * 60000u;
+         bool change = false;
+         if (current.Sector1Ms() != s1)
+         {
+            current.sector1 = s1 / 1000.0;
+            if (!current.invalid && (current.sector1 < session.fastestSector1))
+               session.fastestSector1 = current.sector1;
+            change = true;
+         }
+
+         if (current.Sector2Ms() != s2)
+         {
+            current.sector2 = s2 / 1000.0;
+            if (!current.invalid && (current.sector2 < session.fastestSector2))
+               session.fastestSector2 = current.sector2;
+            change = true;
+         }
+
+         if (change)
+            current.lap = 0;
+
+         if (lapNative.m_currentLapInvalid != current.invalid)
+            current.invalid = lapNative.m_currentLapInvalid;
+      }
+   }
+}
+
+void F1TimingModel::m_UpdateEventData()
+{
+   const PacketEventData& evt = m_pEx->Get<PacketEventData>();
+   if (!evt.m_eventStringCode[0] || s_IsEvent(evt, "BUTN"))
+      return;
+
+   if (s_IsEvent(evt, "SSTA"))
+      Clear();
+   else if (s_IsEvent(evt, "SEND"))
+      session.finished = true;
+
+   TimingEvent e;
+   memcpy(e.code, evt.m_eventStringCode, sizeof(e.code));
+   e.timeCode = m_pEx->sessionTime;
+
+   if (s_IsEvent(evt, "FTLP"))
+      e.carIndex = evt.m_eventDetails.FastestLap.vehicleIdx;
+   else if (s_IsEvent(evt, "RTMT"))
+      e.carIndex = evt.m_eventDetails.Retirement.vehicleIdx;
+   else if (s_IsEvent(evt, "TMPT"))
+      e.carIndex = evt.m_eventDetails.TeamMateInPits.vehicleIdx;
+   else if (s_IsEvent(evt, "RCWN"))
+      e.carIndex = evt.m_eventDetails.RaceWinner.vehicleIdx;
+   else if (s_IsEvent(evt, "SPTP"))
+      e.carIndex = evt.m_eventDetails.SpeedTrap.vehicleIdx;
+   else if (s_IsEvent(evt, "PENA"))
+   {
+      e.carIndex = evt.m_eventDetails.Penalty.vehicleIdx;
+      e.penaltyType = evt.m_eventDetails.Penalty.penaltyType;
+      e.infringementType = evt.m_eventDetails.Penalty.infringementType;
+      e.otherVehicleIdx = evt.m_eventDetails.Penalty.otherVehicleIdx;
+      e.timeGained = evt.m_eventDetails.Penalty.time;
+      e.lapNum = evt.m_eventDetails.Penalty.lapNum;
+      e.placesGained = evt.m_eventDetails.Penalty.placesGained;
+   }
+   else if (!s_IsEvent(evt, "SSTA") && !s_IsEvent(evt, "SEND") && !s_IsEvent(evt, "DRSE") && !s_IsEvent(evt, "DRSD") && !s_IsEvent(evt, "CHQF"))
+      return; // not listed by the mapper
+
+   events.push_back(e);
+
+   // penalties which are served in the pits
+   if (s_IsEvent(evt, "PENA") && (e.carIndex < drivers.size()))
+   {
+      switch (e.penaltyType)
+      {
+      case cs_penaltyDriveThrough:
+      case cs_penaltyStopGo:
+      case cs_penaltyDisqualified:
+      case cs_penaltyRetired:
+         drivers[e.carIndex].pitPenalties.push_back(static_cast<uint32_t>(events.size() - 1));
+         dirtyFields.Touch(e.carIndex, cs_fieldStatus);
+         break;
+      default:
+         break;
+      }
+   }
+}
+
+void F1TimingModel::m_UpdateParticipants()
+{
+   const PacketParticipantsData& data = m_pEx->Get<PacketParticipantsData>();
+
+   // drivers who left stay in the list
+   if (data.m_numActiveCars > session.countDrivers)
+      session.countDrivers = data.m_numActiveCars;
+
+   for (unsigned i = 0; i < drivers.size(); ++i)
+   {
+      drivers[i].team = (data.m_participants[i].m_teamId < 10) ? data.m_participants[i].m_teamId : 10; // 10: classic
+      drivers[i].driverNr = data.m_participants[i].m_raceNumber;
+   }
+}
+
+void F1TimingModel::m_UpdateTyreDamage(unsigned i)
+{
+   TimingDriver& driver = drivers[i];
+   if (!driver.present)
+      return;
+
+   const float* pWear = m_pEx->Get<PacketCarDamageData>().m_carDamageData[i].m_tyresWear;
+   float tyreStatus = (pWear[0] + pWear[1] + pWear[2] + pWear[3]) / 400;
+
+   // map 75% -> 100% ... 0% -> 0%
+   driver.tyreDamage = (tyreStatus >= 0.75f) ? 1.f : tyreStatus * (1.f / 0.75f);
+
+   for (unsigned w = 0; w < 4; ++w)
+      driver.detail.wear[w] = static_cast<int>(pWear[w]);
+}
+
+void F1TimingModel::m_UpdateDamage(unsigned i)
+{
+   TimingDriver& driver = drivers[i];
+   if (!driver.present)
+      return;
+
+   const CarDamageData& data = m_pEx->Get<PacketCarDamageData>().m_carDamageData[i];
+   float damage = data.m_frontLeftWingDamage;
+   damage += data.m_frontRightWingDamage;
+   damage += data.m_rearWingDamage;
+   damage /= 300;
+
+   driver.detail.damageFrontLeft = data.m_frontLeftWingDamage;
+   driver.detail.damageFrontRight = data.m_frontRightWingDamage;
+
+   // map 50% -> 100% ... 0% -> 0%
+   driver.carDamage = (damage >= 0.5f) ? 1.f : damage * (1.f / 0.5f);
+}
+
+void F1TimingModel::m_UpdateTelemetry(unsigned i)
+{
+   TimingDriver& driver = drivers[i];
+   if (!driver.present)
+      return;
+
+   const CarTelemetryData& data = m_pEx->Get<PacketCarTelemetryData>().m_carTelemetryData[i];
+   for (unsigned w = 0; w < 4; ++w)
+   {
+      driver.detail.tempInner[w] = data.m_tyresInnerTemperature[w];
+      driver.detail.tempOuter[w] = data.m_tyresSurfaceTemperature[w];
+      driver.detail.tempBrake[w] = data.m_brakesTemperature[w];
+   }
+   driver.detail.tempEngine = data.m_engineTemperature;
+}
+
+void F1TimingModel::m_UpdateHistoryDataRace()
+{
+   const PacketSessionHistoryData& history = m_pEx->Get<PacketSessionHistoryData>();
+   if (history.m_carIdx >= drivers.size())
+      return;
+
+   // fill laps which were missed
+   TimingDriver& driver = drivers[history.m_carIdx];
+   bool filled = false;
+   for (int i = 0; (i < driver.lapNr) && (i < static_cast<int>(cs_timingMaxLaps)); ++i)
+   {
+      TimingLap& lap = driver.laps[i];
+      if ((lap.lap < 1.0) || (lap.sector1 < 1.0) || (lap.sector2 < 1.0))
+      {
+         lap.sector1 = history.m_lapHistoryData[i].m_sector1TimeMSPart / 1000.0 + history.m_lapHistoryData[i].m_sector1TimeMinutesPart * 60.0;
+         lap.sector2 = history.m_lapHistoryData[i].m_sector2TimeMSPart / 1000.0 + history.m_lapHistoryData[i].m_sector2TimeMinutesPart * 60.0;
+         lap.lap = history.m_lapHistoryData[i].m_lapTimeInMS / 1000.0;
+         filled = true;
+      }
+   }
+
+   if (filled)
+   {
+      m_UpdateCrossings(history.m_carIdx, 0, driver.lapNr - 1);
+      dirtyFields.Touch(history.m_carIdx, cs_fieldTiming);
+   }
+
+   // fastest lap
+   const unsigned best = history.m_bestLapTimeLapNum;
+   if (best && (best < cs_maxNumLapsInHistory) && history.m_lapHistoryData[best - 1].m_lapTimeInMS)
+      driver.fastestLap = static_cast<int>(best - 1);
+}
+
+void F1TimingModel::m_UpdateHistoryDataQuali()
+{
+   const PacketSessionHistoryData& history = m_pEx->Get<PacketSessionHistoryData>();
+   if (history.m_carIdx >= drivers.size())
+      return;
+
+   TimingDriver& driver = drivers[history.m_carIdx];
+   if (!driver.allowLapHistoryQuali)
+      return;
+
+   // only the fastest lap: m_numLaps is not always correct, all laps with complete and valid data are read
+   for (const LapHistoryData& lap : history.m_lapHistoryData)
+   {
+      if ((lap.m_lapValidBitFlags == 0x15) && lap.m_sector1TimeMSPart && lap.m_sector2TimeMSPart && lap.m_sector3TimeMSPart && lap.m_lapTimeInMS)
+      {
+         TimingLap& fastest = driver.FastestLap();
+         if (!fastest.LapMs() || (fastest.LapMs() > lap.m_lapTimeInMS))
+         {
+            fastest.sector1 = lap.m_sector1TimeMSPart / 1000.0 + lap.m_sector1TimeMinutesPart * 60.0;
+            fastest.sector2 = lap.m_sector2TimeMSPart / 1000.0 + lap.m_sector2TimeMinutesPart * 60.0;
+            fastest.lap = lap.m_lapTimeInMS / 1000.0;
+            dirtyFields.Touch(history.m_carIdx, cs_fieldTiming);
+         }
+      }
+   }
+}
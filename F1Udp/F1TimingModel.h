@@ -0,0 +1,188 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include "F1ChangeFeed.h"
+#include "F1DataDefs.h"
+#include "F1DirtyFields.h"
+#include "F1FrameAssembler.h"
+#include "F1GapTracker.h"
+#include "F1PacketExtractor.h"
+#include "F1TimingTable.h"
+
+// Native port of the timing logic of F1UdpClrMapper (laps, sectors, deltas, driver status, penalties), without
+// the managed objects. Used where no UI is attached, e.g. by the offline replay benchmark.
+// Driver names and the final classification are left to the mapper.
+
+// same values as adjsw::F12025::DriverStatus
+enum class TimingDriverStatus : uint8_t
+{
+   Garage,
+   OutLap,
+   OnTrack,
+   Inlap,
+   Pitlane,
+   Pitting,
+   Retired,
+   DNF,
+   DSQ
+};
+
+struct TimingLap
+{
+   double sector1{ 0 };
+   double sector2{ 0 };
+   double lap{ 0 };
+   double lapsAccumulated{ 0 };
+   bool invalid{ false };
+
+   static uint32_t Ms(double seconds) { return static_cast<uint32_t>(seconds * 1000.0 + 0.5); }
+   uint32_t Sector1Ms() const { return Ms(sector1); }
+   uint32_t Sector2Ms() const { return Ms(sector2); }
+   uint32_t LapMs() const { return Ms(lap); }
+   double Sector3() const { return (lap != 0.0) ? lap - (sector1 + sector2) : 0.0; }
+};
+
+// an event of PacketEventData, the penalty fields are only set for "PENA"
+struct TimingEvent
+{
+   char code[4]{};
+   float timeCode{ 0 };
+   uint8_t carIndex{ 0 };
+   uint8_t penaltyType{ 0 };
+   uint8_t infringementType{ 0 };
+   uint8_t otherVehicleIdx{ 0 };
+   uint8_t timeGained{ 0 };
+   uint8_t lapNum{ 0 };
+   uint8_t placesGained{ 0 };
+   bool penaltyServed{ false };
+};
+
+// same as adjsw::F12025::CarDetail
+struct TimingCarDetail
+{
+   int damageFrontLeft{ 0 };
+   int damageFrontRight{ 0 };
+   int wear[4]{};            // m_tyresWear order: RL, RR, FL, FR
+   int tempInner[4]{};
+   int tempOuter[4]{};
+   int tempBrake[4]{};
+   int tempEngine{ 0 };
+};
+
+struct TimingDriver
+{
+   void Reset(unsigned id);
+
+   TimingLap& FastestLap() { return (fastestLap < 0) ? fastestLapData : laps[fastestLap]; }
+   const TimingLap& FastestLap() const { return (fastestLap < 0) ? fastestLapData : laps[fastestLap]; }
+   TimingLap& CurrentLap() { return laps[currentLap]; }
+
+   unsigned id{ 0 };
+   bool present{ false };
+   bool isPlayer{ false };
+   TimingDriverStatus status{ TimingDriverStatus::Garage };
+   uint8_t team{ 0 };
+   int driverNr{ 0 };
+   uint8_t tyre{ 0 };
+   uint8_t visualTyre{ 0 };
+   int tyreAge{ 0 };
+   float tyreDamage{ 0 };
+   float carDamage{ 0 };
+   int pos{ 0 };
+   int lapNr{ 1 };
+   int penaltySeconds{ 0 };
+   float timedeltaToPlayer{ 0 };
+   float lastTimedeltaToPlayer{ 0 };
+   float timedeltaToLeader{ 0 }; // negative: number of laps behind the leader
+   float timedeltaToCarAhead{ 0 }; // interval, negative: number of laps behind the car ahead
+   float trackPositionPerc{ 0 };
+   float locationOnTrack{ 0 };
+   bool allowLapHistoryQuali{ true };
+   bool hasPittedLatch{ false };
+
+   std::array<TimingLap, cs_timingMaxLaps> laps{};
+   unsigned currentLap{ 0 };    // index into laps
+   int fastestLap{ -1 };        // index into laps, -1: fastestLapData (the mapper may point FastestLap to one of the laps)
+   TimingLap fastestLapData{};
+
+   std::vector<uint8_t> visualTyres; // m_visualTyreCompound, 0: unknown
+   std::vector<uint32_t> pitPenalties; // indices into F1TimingModel::events
+   TimingCarDetail detail{};
+};
+
+struct TimingSession
+{
+   int8_t track{ -1 };
+   uint8_t sessionType{ 0 };
+   bool finished{ false };
+   int remainingTime{ 0 };
+   int totalLaps{ 0 };
+   int currentLap{ 1 };
+   double fastestSector1{ 999.0 };
+   double fastestSector2{ 999.0 };
+   double fastestSector3{ 999.0 };
+   float trackLength{ 0 };
+   int countDrivers{ 0 };
+};
+
+class F1TimingModel
+{
+public:
+   F1TimingModel();
+
+   // same as F1UdpClrMapper::ApplyPacket(): call after each packet accepted by the extractor.
+   // With ExtractMode::View the packets which are read here are retained, as the mapper does.
+   void Apply(F12025_PacketExtractor& extractor, PacketType type, uint64_t nowNs);
+
+   // publish an incomplete frame after the assembler timeout
+   void Poll(const F12025_PacketExtractor& extractor, uint64_t nowNs);
+
+   // new session
+   void Clear();
+
+   // continue a session restored from a journal (F1Journal.h), the packets of it do not clear the model
+   void ContinueSession(uint64_t sessionUID, float connectTime);
+
+   uint64_t SessionUID() const { return m_sessionId; }
+   float SessionConnectTime() const { return m_sessionConnectTime; }
+
+   static bool IsQualifyingOrPractice(uint8_t sessionType);
+
+   TimingSession session;
+   std::array<TimingDriver, cs_maxNumCarsInUDPData> drivers;
+   std::vector<TimingEvent> events;
+   F1TimingTable timingTable; // race time of the sector crossings, for the race deltas
+   F1GapTracker gaps;         // distance / time samples of the cars, for the live gaps of the race
+   F1DirtyFields dirtyFields; // the fields of the frames which changed, only these are applied to the drivers
+   F1ChangeFeed changes;      // the changes of the drivers as records, for any number of readers
+
+   uint64_t driverUpdates{ 0 }; // number of m_UpdateDrivers() runs
+
+private:
+   void m_UpdateDrivers();
+   void m_UpdateTimeDeltaRace(const TimingDriver& reference, unsigned i, bool toPlayer);
+   void m_UpdateTimeDeltaQualy(const TimingDriver& reference, unsigned i, bool toPlayer);
+   void m_UpdateSession();
+   void m_UpdateLapRace();
+   void m_UpdateLapQuali();
+   void m_UpdateGaps();
+   void m_UpdateEventData();
+   void m_UpdateParticipants();
+   void m_UpdateTyreDamage(unsigned i);
+   void m_UpdateDamage(unsigned i);
+   void m_UpdateTelemetry(unsigned i);
+   void m_UpdateHistoryDataRace();
+   void m_UpdateHistoryDataQuali();
+   void m_UpdateCrossings(unsigned i, int firstLapIdx, int lastLapIdx); // timingTable of the laps of a car
+   void m_PublishChanges();
+
+   const F12025_PacketExtractor* m_pEx{ nullptr }; // during Apply() / Poll()
+   F1FrameAssembler m_frames;
+   uint64_t m_sessionId{ 0 };
+   float m_sessionConnectTime{ 0 };
+   std::array<F1ChangeCar, cs_maxNumCarsInUDPData> m_published; // the values of the drivers in the change records so far
+};
@@ -0,0 +1,65 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1TimingTable.h"
+
+#include <algorithm>
+
+void F1TimingTable::Clear()
+{
+   m_times.fill(0.f);
+   m_last.fill(-1);
+}
+
+void F1TimingTable::SetLap(unsigned car, unsigned lapIdx, double sector1, double sector2, double lap, double previousAccumulated)
+{
+   if ((car >= cs_maxNumCarsInUDPData) || (lapIdx >= cs_timingMaxLaps))
+      return;
+
+   // summed in float as the lap search did before
+   const float start = static_cast<float>(previousAccumulated);
+   const unsigned first = lapIdx * cs_timingSectors;
+   m_Time(first, car) = sector1 ? start + static_cast<float>(sector1) : 0.f;
+   m_Time(first + 1, car) = sector2 ? start + static_cast<float>(sector1 + sector2) : 0.f;
+   m_Time(first + 2, car) = lap ? start + static_cast<float>(lap) : 0.f;
+
+   int top = -1;
+   for (int k = static_cast<int>(first + 2); (k >= static_cast<int>(first)) && (top < 0); --k)
+   {
+      if (Time(k, car) != 0.f)
+         top = k;
+   }
+
+   int& last = m_last[car];
+   if (last > static_cast<int>(first + 2))
+      return;
+
+   if (top >= 0)
+      last = top;
+   else if (last >= static_cast<int>(first))
+   {
+      // the last crossing was removed
+      last = static_cast<int>(first) - 1;
+      while ((last >= 0) && (Time(last, car) == 0.f))
+         --last;
+   }
+}
+
+bool F1TimingTable::LastCommonCrossing(unsigned reference, unsigned opponent, int maxLapIdx, float& timeReference, float& timeOpponent) const
+{
+   if ((reference >= cs_maxNumCarsInUDPData) || (opponent >= cs_maxNumCarsInUDPData) || (maxLapIdx < 0))
+      return false;
+
+   if (maxLapIdx >= static_cast<int>(cs_timingMaxLaps))
+      maxLapIdx = cs_timingMaxLaps - 1;
+
+   int k = (std::min)({ m_last[reference], m_last[opponent], (maxLapIdx + 1) * static_cast<int>(cs_timingSectors) - 1 });
+   for (; k >= 0; --k)
+   {
+      timeReference = Time(k, reference);
+      timeOpponent = Time(k, opponent);
+      if ((timeReference != 0.f) && (timeOpponent != 0.f))
+         return true;
+   }
+   return false;
+}
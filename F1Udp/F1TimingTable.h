@@ -0,0 +1,41 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <array>
+#include "F1DataDefs.h"
+
+inline constexpr unsigned cs_timingMaxLaps = 100;
+inline constexpr unsigned cs_timingSectors = 3;
+
+// Race time of every car at every sector crossing, dense [lap][sector][car], for the gap between two cars without
+// searching their laps. A crossing is the lapsAccumulated of the lap before + the sector 1, sector 1 + 2 or lap time,
+// 0 while the sector is not completed. The owner updates the laps of a car whenever their times change.
+class F1TimingTable
+{
+public:
+   F1TimingTable() { Clear(); }
+
+   void Clear();
+
+   // the crossings of one lap, previousAccumulated: lapsAccumulated of the lap before (0 for the first lap)
+   void SetLap(unsigned car, unsigned lapIdx, double sector1, double sector2, double lap, double previousAccumulated);
+
+   // race times of the last crossing which both cars completed, on laps up to maxLapIdx.
+   // False if there is none. Usually the last crossing of the car behind, a sector missing in the data (e.g. joined
+   // late) is skipped backwards.
+   bool LastCommonCrossing(unsigned reference, unsigned opponent, int maxLapIdx, float& timeReference, float& timeOpponent) const;
+
+   // crossing index: lapIdx * cs_timingSectors + sector
+   float Time(unsigned crossing, unsigned car) const { return m_times[crossing * cs_maxNumCarsInUDPData + car]; }
+
+   // last crossing of the car with a time, -1 if none
+   int LastCrossing(unsigned car) const { return m_last[car]; }
+
+private:
+   float& m_Time(unsigned crossing, unsigned car) { return m_times[crossing * cs_maxNumCarsInUDPData + car]; }
+
+   std::array<float, cs_timingMaxLaps * cs_timingSectors * cs_maxNumCarsInUDPData> m_times;
+   std::array<int, cs_maxNumCarsInUDPData> m_last;
+};
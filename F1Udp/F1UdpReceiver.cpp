@@ -0,0 +1,445 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "F1UdpReceiver.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#endif
+
+#include <string.h>
+
+#ifdef _WIN32
+
+struct F1UdpReceiver::Impl
+{
+   SOCKET sock{ INVALID_SOCKET };
+   bool wsaStarted{ false };
+};
+
+bool F1UdpReceiver::Open(uint16_t port, int rcvBufBytes)
+{
+   Close();
+
+   WSADATA wsa;
+   if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+      return false;
+   m_impl->wsaStarted = true;
+
+   m_impl->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+   if (m_impl->sock == INVALID_SOCKET)
+   {
+      Close();
+      return false;
+   }
+
+   BOOL reuse = TRUE;
+   setsockopt(m_impl->sock, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+   if (rcvBufBytes > 0)
+      setsockopt(m_impl->sock, SOL_SOCKET, SO_RCVBUF, (const char*)&rcvBufBytes, sizeof(rcvBufBytes));
+
+   u_long nonBlocking = 1;
+   ioctlsocket(m_impl->sock, FIONBIO, &nonBlocking);
+
+   sockaddr_in addr{};
+   addr.sin_family = AF_INET;
+   addr.sin_port = htons(port);
+   addr.sin_addr.s_addr = htonl(INADDR_ANY);
+   if (bind(m_impl->sock, (const sockaddr*)&addr, sizeof(addr)) != 0)
+   {
+      Close();
+      return false;
+   }
+
+   return true;
+}
+
+void F1UdpReceiver::Close()
+{
+   if (m_impl->sock != INVALID_SOCKET)
+      closesocket(m_impl->sock);
+   m_impl->sock = INVALID_SOCKET;
+
+   if (m_impl->wsaStarted)
+      WSACleanup();
+   m_impl->wsaStarted = false;
+}
+
+bool F1UdpReceiver::IsOpen() const
+{
+   return m_impl->sock != INVALID_SOCKET;
+}
+
+int F1UdpReceiver::m_Receive(int timeoutMs)
+{
+   if (!IsOpen())
+      return -1;
+
+   fd_set rd;
+   FD_ZERO(&rd);
+   FD_SET(m_impl->sock, &rd);
+   timeval tv{ timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+   int sel = select(0, &rd, nullptr, nullptr, (timeoutMs < 0) ? nullptr : &tv);
+   if (sel <= 0)
+   {
+      if (sel < 0)
+         ++m_stats.errors;
+      return sel;
+   }
+
+   // no kernel timestamps with plain winsock, take the time directly after the wait
+   unsigned cnt = 0;
+   while (cnt < BATCH)
+   {
+      uint8_t* pSlot = m_slab.get() + cnt * SLOT_SIZE;
+      int rcv = recvfrom(m_impl->sock, (char*)pSlot, SLOT_SIZE, 0, nullptr, nullptr);
+      if (rcv < 0)
+      {
+         int err = WSAGetLastError();
+         if (err == WSAEMSGSIZE)
+         {
+            ++m_stats.truncated;
+            continue;
+         }
+         if (err != WSAEWOULDBLOCK)
+            ++m_stats.errors;
+         break;
+      }
+
+      m_descs[cnt].pData = pSlot;
+      m_descs[cnt].len = (unsigned)rcv;
+      m_descs[cnt].rxTimestampNs = NowNs();
+      ++cnt;
+   }
+
+   return (int)cnt;
+}
+
+struct F1UdpSender::Impl
+{
+   SOCKET sock{ INVALID_SOCKET };
+   bool wsaStarted{ false };
+   sockaddr_in addr{};
+};
+
+bool F1UdpSender::Open(uint16_t port, const char* host)
+{
+   Close();
+
+   WSADATA wsa;
+   if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+      return false;
+   m_impl->wsaStarted = true;
+
+   // not connected: the ICMP errors of a port without receiver would fail the next send
+   m_impl->addr = sockaddr_in{};
+   m_impl->addr.sin_family = AF_INET;
+   m_impl->addr.sin_port = htons(port);
+   m_impl->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+   if ((m_impl->sock == INVALID_SOCKET) || (inet_pton(AF_INET, host, &m_impl->addr.sin_addr) != 1))
+   {
+      Close();
+      return false;
+   }
+   return true;
+}
+
+void F1UdpSender::Close()
+{
+   if (m_impl->sock != INVALID_SOCKET)
+      closesocket(m_impl->sock);
+   m_impl->sock = INVALID_SOCKET;
+
+   if (m_impl->wsaStarted)
+      WSACleanup();
+   m_impl->wsaStarted = false;
+}
+
+bool F1UdpSender::IsOpen() const
+{
+   return m_impl->sock != INVALID_SOCKET;
+}
+
+bool F1UdpSender::Send(const uint8_t* pData, unsigned len)
+{
+   if (IsOpen() && (sendto(m_impl->sock, (const char*)pData, (int)len, 0, (const sockaddr*)&m_impl->addr, sizeof(m_impl->addr)) == (int)len))
+   {
+      ++m_sent;
+      return true;
+   }
+
+   ++m_errors;
+   return false;
+}
+
+#else
+
+namespace
+{
+   constexpr unsigned CTRL_SIZE = CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t));
+}
+
+struct F1UdpReceiver::Impl
+{
+   int fd{ -1 };
+   uint32_t lastDropCounter{ 0 }; // SO_RXQ_OVFL counts since the socket was opened
+   mmsghdr msgs[BATCH]{};
+   iovec iovs[BATCH]{};
+   alignas(cmsghdr) uint8_t ctrl[BATCH][CTRL_SIZE]{};
+};
+
+bool F1UdpReceiver::Open(uint16_t port, int rcvBufBytes)
+{
+   Close();
+
+   m_impl->fd = socket(AF_INET, SOCK_DGRAM, 0);
+   if (m_impl->fd < 0)
+      return false;
+
+   int one = 1;
+   setsockopt(m_impl->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+   setsockopt(m_impl->fd, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one));
+   setsockopt(m_impl->fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one));
+   if (rcvBufBytes > 0)
+      setsockopt(m_impl->fd, SOL_SOCKET, SO_RCVBUF, &rcvBufBytes, sizeof(rcvBufBytes));
+
+   sockaddr_in addr{};
+   addr.sin_family = AF_INET;
+   addr.sin_port = htons(port);
+   addr.sin_addr.s_addr = htonl(INADDR_ANY);
+   if (bind(m_impl->fd, (const sockaddr*)&addr, sizeof(addr)) != 0)
+   {
+      Close();
+      return false;
+   }
+
+   m_impl->lastDropCounter = 0;
+   return true;
+}
+
+void F1UdpReceiver::Close()
+{
+   if (m_impl->fd >= 0)
+      close(m_impl->fd);
+   m_impl->fd = -1;
+}
+
+bool F1UdpReceiver::IsOpen() const
+{
+   return m_impl->fd >= 0;
+}
+
+int F1UdpReceiver::m_Receive(int timeoutMs)
+{
+   if (!IsOpen())
+      return -1;
+
+   pollfd pfd{ m_impl->fd, POLLIN, 0 };
+   int rdy = poll(&pfd, 1, timeoutMs);
+   if (rdy == 0)
+      return 0;
+
+   if (rdy < 0)
+   {
+      if (errno == EINTR)
+         return 0;
+      ++m_stats.errors;
+      return -1;
+   }
+
+   // the headers are modified by the kernel, thus set up again for each call
+   for (unsigned i = 0; i < BATCH; ++i)
+   {
+      m_impl->iovs[i].iov_base = m_slab.get() + i * SLOT_SIZE;
+      m_impl->iovs[i].iov_len = SLOT_SIZE;
+
+      msghdr& hdr = m_impl->msgs[i].msg_hdr;
+      hdr = msghdr();
+      hdr.msg_iov = &m_impl->iovs[i];
+      hdr.msg_iovlen = 1;
+      hdr.msg_control = m_impl->ctrl[i];
+      hdr.msg_controllen = CTRL_SIZE;
+      m_impl->msgs[i].msg_len = 0;
+   }
+
+   int cnt = recvmmsg(m_impl->fd, m_impl->msgs, BATCH, MSG_DONTWAIT, nullptr);
+   if (cnt < 0)
+   {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+      {
+         ++m_stats.errors;
+         return -1;
+      }
+      return 0;
+   }
+
+   for (int i = 0; i < cnt; ++i)
+   {
+      msghdr& hdr = m_impl->msgs[i].msg_hdr;
+      DatagramDesc& desc = m_descs[i];
+      desc.pData = m_slab.get() + i * SLOT_SIZE;
+      desc.len = m_impl->msgs[i].msg_len;
+      desc.rxTimestampNs = 0;
+
+      if (hdr.msg_flags & MSG_TRUNC)
+      {
+         ++m_stats.truncated;
+         desc.len = 0; // rejected by the extractor
+      }
+
+      for (cmsghdr* pCmsg = CMSG_FIRSTHDR(&hdr); pCmsg; pCmsg = CMSG_NXTHDR(&hdr, pCmsg))
+      {
+         if (pCmsg->cmsg_level != SOL_SOCKET)
+            continue;
+
+         if (pCmsg->cmsg_type == SCM_TIMESTAMPNS)
+         {
+            timespec ts;
+            memcpy(&ts, CMSG_DATA(pCmsg), sizeof(ts));
+            desc.rxTimestampNs = uint64_t(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+         }
+         else if (pCmsg->cmsg_type == SO_RXQ_OVFL)
+         {
+            uint32_t drops;
+            memcpy(&drops, CMSG_DATA(pCmsg), sizeof(drops));
+            m_stats.kernelDrops += uint32_t(drops - m_impl->lastDropCounter);
+            m_impl->lastDropCounter = drops;
+         }
+      }
+
+      if (!desc.rxTimestampNs)
+         desc.rxTimestampNs = NowNs();
+   }
+
+   return cnt;
+}
+
+struct F1UdpSender::Impl
+{
+   int fd{ -1 };
+   sockaddr_in addr{};
+};
+
+bool F1UdpSender::Open(uint16_t port, const char* host)
+{
+   Close();
+
+   // not connected: the ICMP errors of a port without receiver would fail the next send
+   m_impl->addr = sockaddr_in{};
+   m_impl->addr.sin_family = AF_INET;
+   m_impl->addr.sin_port = htons(port);
+   m_impl->fd = socket(AF_INET, SOCK_DGRAM, 0);
+   if ((m_impl->fd < 0) || (inet_pton(AF_INET, host, &m_impl->addr.sin_addr) != 1))
+   {
+      Close();
+      return false;
+   }
+   return true;
+}
+
+void F1UdpSender::Close()
+{
+   if (m_impl->fd >= 0)
+      close(m_impl->fd);
+   m_impl->fd = -1;
+}
+
+bool F1UdpSender::IsOpen() const
+{
+   return m_impl->fd >= 0;
+}
+
+bool F1UdpSender::Send(const uint8_t* pData, unsigned len)
+{
+   if (IsOpen() && (sendto(m_impl->fd, pData, len, 0, (const sockaddr*)&m_impl->addr, sizeof(m_impl->addr)) == (ssize_t)len))
+   {
+      ++m_sent;
+      return true;
+   }
+
+   ++m_errors;
+   return false;
+}
+
+#endif
+
+
+F1UdpReceiver::F1UdpReceiver() :
+   m_impl(new Impl()),
+   m_slab(new uint8_t[BATCH * SLOT_SIZE])
+{
+}
+
+F1UdpReceiver::F1UdpReceiver(F12025_PacketExtractor& extractor) :
+   F1UdpReceiver()
+{
+   m_pExtractor = &extractor;
+}
+
+F1UdpReceiver::~F1UdpReceiver()
+{
+   Close();
+}
+
+int F1UdpReceiver::Poll(int timeoutMs)
+{
+   return Poll(timeoutMs, [](const PacketRef&, const PacketResult&, const DatagramDesc&) {});
+}
+
+int F1UdpReceiver::Receive(int timeoutMs)
+{
+   int cnt = m_Receive(timeoutMs);
+   if (cnt <= 0)
+      return cnt;
+
+   ++m_stats.batches;
+   for (int i = 0; i < cnt; ++i)
+   {
+      const DatagramDesc& desc = m_descs[i];
+      ++m_stats.datagrams;
+      m_stats.bytes += desc.len;
+
+      if (!m_stats.firstRxNs)
+         m_stats.firstRxNs = desc.rxTimestampNs;
+      m_stats.lastRxNs = desc.rxTimestampNs;
+   }
+   return cnt;
+}
+
+void F1UdpReceiver::m_AccountLatency(unsigned count)
+{
+   const uint64_t now = NowNs();
+
+   for (unsigned i = 0; i < count; ++i)
+   {
+      const DatagramDesc& desc = m_descs[i];
+      if (m_results[i].IsValid() && (now >= desc.rxTimestampNs))
+      {
+         uint64_t lat = now - desc.rxTimestampNs;
+         ++m_stats.latencyCount;
+         m_stats.latencySumNs += lat;
+         if (lat > m_stats.latencyMaxNs)
+            m_stats.latencyMaxNs = lat;
+      }
+   }
+}
+
+F1UdpSender::F1UdpSender() :
+   m_impl(new Impl())
+{
+}
+
+F1UdpSender::~F1UdpSender()
+{
+   Close();
+}
@@ -0,0 +1,135 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <chrono>
+#include "F1PacketExtractor.h"
+
+struct F1UdpReceiverStats
+{
+   uint64_t datagrams{ 0 };   // received from the socket
+   uint64_t bytes{ 0 };
+   uint64_t valid{ 0 };       // accepted by the extractor
+   uint64_t batches{ 0 };     // receive calls which returned data
+   uint64_t truncated{ 0 };   // datagrams larger than a slab slot
+   uint64_t kernelDrops{ 0 }; // dropped by the socket because the receive buffer was full (linux only)
+   uint64_t errors{ 0 };
+
+   // receive (kernel timestamp) to parsed, only for valid packets
+   uint64_t latencyCount{ 0 };
+   uint64_t latencySumNs{ 0 };
+   uint64_t latencyMaxNs{ 0 };
+
+   uint64_t firstRxNs{ 0 };
+   uint64_t lastRxNs{ 0 };
+
+   double AvgLatencyUs() const { return latencyCount ? (latencySumNs / 1000.0) / latencyCount : 0.0; }
+
+   double PacketsPerSecond() const
+   {
+      return (lastRxNs > firstRxNs) ? (datagrams - 1) * 1e9 / (lastRxNs - firstRxNs) : 0.0;
+   }
+};
+
+// Receives F1 udp datagrams in bursts into a preallocated slab and feeds them to the extractor without further copies.
+// Without an extractor, Receive() only fills the slab, e.g. to pass the datagrams on to another thread by F1SpscRing.
+// Linux: recvmmsg() with kernel receive timestamps (SO_TIMESTAMPNS), Windows: recvfrom() loop, timestamped after reception.
+// Not thread safe, Poll() is meant to be called by one receive thread.
+class F1UdpReceiver
+{
+public:
+   static constexpr unsigned BATCH = 64;       // datagrams per receive call
+   static constexpr unsigned SLOT_SIZE = 2048; // largest F1 25 packet is 1460 bytes
+
+   F1UdpReceiver();
+   explicit F1UdpReceiver(F12025_PacketExtractor& extractor);
+   ~F1UdpReceiver();
+
+   F1UdpReceiver(const F1UdpReceiver&) = delete;
+   F1UdpReceiver& operator=(const F1UdpReceiver&) = delete;
+
+   // bind to 0.0.0.0:port, rcvBufBytes = 0 keeps the os default
+   bool Open(uint16_t port, int rcvBufBytes = 4 * 1024 * 1024);
+   void Close();
+   bool IsOpen() const;
+
+   // wait up to timeoutMs for datagrams and proceed everything which is available (up to BATCH).
+   // Returns the number of received datagrams, 0 on timeout, -1 on error (or if no extractor is set).
+   int Poll(int timeoutMs);
+
+   // as above, onPacket is forwarded to F12025_PacketExtractor::ProceedBatch()
+   template<typename FUNC>
+   int Poll(int timeoutMs, FUNC&& onPacket);
+
+   // as Poll(), but without parsing. The datagrams are valid until the next call.
+   int Receive(int timeoutMs);
+   const DatagramDesc* Datagrams() const { return m_descs; }
+
+   const F1UdpReceiverStats& Stats() const { return m_stats; }
+   void ResetStats() { m_stats = F1UdpReceiverStats(); }
+
+   // same clock as the receive timestamps
+   static uint64_t NowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+   }
+
+private:
+   // fills m_descs, returns count or -1
+   int m_Receive(int timeoutMs);
+   void m_AccountLatency(unsigned count);
+
+   struct Impl; // socket + platform specific message headers
+   std::unique_ptr<Impl> m_impl;
+
+   F12025_PacketExtractor* m_pExtractor{ nullptr };
+   std::unique_ptr<uint8_t[]> m_slab; // BATCH * SLOT_SIZE
+   DatagramDesc m_descs[BATCH]{};
+   PacketResult m_results[BATCH]{};
+   F1UdpReceiverStats m_stats;
+};
+
+// Sends datagrams to one address, e.g. to re-emit a replay to another program on this machine.
+class F1UdpSender
+{
+public:
+   F1UdpSender();
+   ~F1UdpSender();
+
+   F1UdpSender(const F1UdpSender&) = delete;
+   F1UdpSender& operator=(const F1UdpSender&) = delete;
+
+   // host: IPv4 address, e.g. "127.0.0.1"
+   bool Open(uint16_t port, const char* host = "127.0.0.1");
+   void Close();
+   bool IsOpen() const;
+
+   bool Send(const uint8_t* pData, unsigned len);
+
+   uint64_t Sent() const { return m_sent; }
+   uint64_t Errors() const { return m_errors; }
+
+private:
+   struct Impl;
+   std::unique_ptr<Impl> m_impl;
+   uint64_t m_sent{ 0 };
+   uint64_t m_errors{ 0 };
+};
+
+
+template<typename FUNC>
+int F1UdpReceiver::Poll(int timeoutMs, FUNC&& onPacket)
+{
+   if (!m_pExtractor)
+      return -1;
+
+   int cnt = Receive(timeoutMs);
+   if (cnt <= 0)
+      return cnt;
+
+   m_stats.valid += m_pExtractor->ProceedBatch(m_descs, cnt, m_results, onPacket);
+   m_AccountLatency(cnt);
+   return cnt;
+}
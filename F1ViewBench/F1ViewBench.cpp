@@ -0,0 +1,162 @@
+// Copyright 2025 Andreas Jung
+// SPDX-License-Identifier: GPL-3.0-only
+
+// Microbenchmark of the extract modes per packet type: ProceedPacket() in ExtractMode::Copy against
+// ExtractMode::View, each followed by one read of the packet as a consumer would do it
+// (F12025_PacketExtractor::Get() resp. PacketView), and View + Retain() for consumers which keep the packet.
+//
+//   F1ViewBench [--iterations n] [--misaligned]
+//
+//   --iterations n   packets per type and mode (default 1000000)
+//   --misaligned     the packets start at an odd address, as in a buffer of several datagrams
+//
+// Linux, from the repository root:
+//   g++ -std=c++17 -O2 -DNDEBUG -IF1Udp -o F1ViewBench F1ViewBench/F1ViewBench.cpp F1Udp/F1PacketExtractor.cpp
+//      F1Udp/F1PacketFormats.cpp F1Udp/F1HeaderScan.cpp
+// Windows: the same files with cl /std:c++17 /O2 /EHsc /DNDEBUG /IF1Udp
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "F1PacketRegistry.h"
+
+namespace
+{
+   struct Options
+   {
+      unsigned iterations{ 1000000 };
+      bool misaligned{ false };
+   };
+
+   const char* s_TypeName(uint8_t id)
+   {
+      static const char* const names[] = {
+         "Motion", "Session", "Lap", "Event", "Participants", "CarSetup", "CarTelemetry", "CarStatus",
+         "FinalClassification", "LobbyInfo", "CarDamage", "SessionHistory", "TyreSets", "MotionEx",
+         "TimeTrial", "LapPositions" };
+      return (id < sizeof(names) / sizeof(names[0])) ? names[id] : "Unknown";
+   }
+
+   // the reads go here, so the compiler can not drop them
+   volatile uint64_t s_sink = 0;
+
+   uint64_t s_NowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   // one packet of each type, the frame identifier is changed per iteration so no read can be hoisted
+   template<typename PKT_TYPE>
+   uint8_t* s_MakePacket(std::vector<uint8_t>& buffer, bool misaligned)
+   {
+      buffer.assign(sizeof(PKT_TYPE) + 64, 0);
+      uint8_t* pData = buffer.data() + (misaligned ? 1 : 0);
+      PacketHeader header{};
+      header.m_packetFormat = 2025;
+      header.m_gameYear = 25;
+      header.m_packetVersion = 1;
+      header.m_packetId = static_cast<uint8_t>(PacketTypeOf<PKT_TYPE>());
+      header.m_sessionUID = 1;
+      memcpy(pData, &header, sizeof(header));
+      return pData;
+   }
+
+   void s_SetFrame(uint8_t* pData, uint32_t frame)
+   {
+      memcpy(pData + offsetof(PacketHeader, m_frameIdentifier), &frame, sizeof(frame));
+   }
+
+   enum class Run
+   {
+      Copy,
+      View,
+      ViewRetain
+   };
+
+   // ns per packet
+   template<typename PKT_TYPE>
+   double s_Measure(F12025_PacketExtractor& extractor, uint8_t* pData, Run run, const Options& opt, uint64_t& sink)
+   {
+      extractor.mode = (run == Run::Copy) ? ExtractMode::Copy : ExtractMode::View;
+      const uint64_t t0 = s_NowNs();
+      for (unsigned i = 0; i < opt.iterations; ++i)
+      {
+         s_SetFrame(pData, i);
+         extractor.ProceedPacket(pData, sizeof(PKT_TYPE));
+         switch (run)
+         {
+         case Run::Copy:
+            sink += extractor.Get<PKT_TYPE>().m_header.m_frameIdentifier;
+            break;
+         case Run::View:
+            sink += extractor.lastPacket.As<PKT_TYPE>().template Sub<&PKT_TYPE::m_header>().template Get<&PacketHeader::m_frameIdentifier>();
+            break;
+         case Run::ViewRetain:
+            extractor.Retain(extractor.lastPacket);
+            sink += extractor.Get<PKT_TYPE>().m_header.m_frameIdentifier;
+            break;
+         }
+      }
+      return static_cast<double>(s_NowNs() - t0) / opt.iterations;
+   }
+
+   template<typename ENTRY>
+   void s_RunType(F12025_PacketExtractor& extractor, const Options& opt, uint64_t& sink)
+   {
+      using PKT_TYPE = typename ENTRY::Packet;
+      std::vector<uint8_t> buffer;
+      uint8_t* pData = s_MakePacket<PKT_TYPE>(buffer, opt.misaligned);
+
+      // first pass warms up the slot and the caches
+      s_Measure<PKT_TYPE>(extractor, pData, Run::Copy, opt, sink);
+      const double copyNs = s_Measure<PKT_TYPE>(extractor, pData, Run::Copy, opt, sink);
+      const double viewNs = s_Measure<PKT_TYPE>(extractor, pData, Run::View, opt, sink);
+      const double retainNs = s_Measure<PKT_TYPE>(extractor, pData, Run::ViewRetain, opt, sink);
+      printf("%-20s %6u %10.1f %10.1f %8.1fx %12.1f\n", s_TypeName(ENTRY::id), ENTRY::size, copyNs, viewNs,
+         viewNs > 0 ? copyNs / viewNs : 0.0, retainNs);
+   }
+
+   template<typename... ENTRIES>
+   void s_RunAll(F12025_PacketExtractor& extractor, const Options& opt, uint64_t& sink, PacketRegistryList<ENTRIES...>)
+   {
+      (s_RunType<ENTRIES>(extractor, opt, sink), ...);
+   }
+
+   bool s_ParseArgs(int argc, char** argv, Options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         if (!strcmp(argv[i], "--iterations") && (i + 1 < argc))
+            opt.iterations = static_cast<unsigned>(atoi(argv[++i]));
+         else if (!strcmp(argv[i], "--misaligned"))
+            opt.misaligned = true;
+         else
+            return false;
+      }
+      return opt.iterations != 0;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options opt;
+   if (!s_ParseArgs(argc, argv, opt))
+   {
+      fprintf(stderr, "usage: %s [--iterations n] [--misaligned]\n", argv[0]);
+      return 2;
+   }
+
+   // the extractor holds one slot per packet type, it is too large for the stack
+   std::vector<F12025_PacketExtractor> extractorStorage(1);
+   uint64_t sink = 0;
+
+   printf("%u packets per type and mode, %s buffer, ns/packet\n\n", opt.iterations, opt.misaligned ? "misaligned" : "aligned");
+   printf("%-20s %6s %10s %10s %9s %12s\n", "packet type", "bytes", "copy", "view", "speedup", "view+retain");
+   s_RunAll(extractorStorage[0], opt, sink, PacketRegistry{});
+   s_sink = sink;
+   return 0;
+}
@@ -244,6 +244,48 @@ namespace adjsw.F12025
       }
    }
 
+   public class IntervalConverter : QualifyingAwareConverter
+   {
+      public override object Convert(object[] values, Type targetType, object parameter, System.Globalization.CultureInfo culture)
+      {
+         var dat = values?[2] as DriverData;
+
+         if (null == dat)
+            return "?";
+
+         if (IsQualy || (dat.Pos == 1) || !dat.Present)
+            return "--------";
+
+         switch (dat.Status)
+         {
+            case DriverStatus.DNF:
+            case DriverStatus.DSQ:
+            case DriverStatus.Retired:
+               return "--------";
+         }
+
+         if (dat.TimedeltaToCarAhead > 0)
+            return string.Format(" {0,7:##0.000}", (dat.TimedeltaToCarAhead + 0.0005));
+
+         if (dat.TimedeltaToCarAhead < 0)
+         {
+            int lapped = (int)(dat.TimedeltaToCarAhead - 0.5);
+            lapped *= -1;
+            if (lapped > 9)
+               return "    +" + lapped + "L";
+            else
+               return "     +" + lapped + "L";
+         }
+
+         return "--------";
+      }
+
+      public override object[] ConvertBack(object value, Type[] targetTypes, object parameter, CultureInfo culture)
+      {
+         throw new NotImplementedException();
+      }
+   }
+
    public class FastestLapConverter : IMultiValueConverter
    {
       public object Convert(object[] values, Type targetType, object parameter, System.Globalization.CultureInfo culture)
@@ -2,7 +2,6 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 using System;
-using System.Collections.Concurrent;
 using System.Collections.ObjectModel;
 using System.IO;
 using System.Text;
@@ -40,9 +39,10 @@ namespace adjsw.F12025
       }
 
 
-      public ConcurrentQueue<byte[]> PacketQue
+      // used by the playback window, the datagram is copied into the native queue of the mapper
+      public F1UdpClrMapper Mapper
       {
-         get { return m_packetQue; }
+         get { return m_mapper; }
       }
 
       public MainWindow()
@@ -72,8 +72,9 @@ namespace adjsw.F12025
          }
          else
          {
-            m_udpClient = new UdpEventClient(20777);
-            m_udpClient.ReceiveEvent += OnUdpReceive;
+            // the timing state survives a crash or restart of the program during a session
+            m_mapper.StartJournal("session.krf1journal");
+            m_live = m_mapper.StartReceive(20777);
          }
 
          UpdateDriverGrid();
@@ -106,8 +107,8 @@ namespace adjsw.F12025
 
       private void MainWindow_Closing(object sender, System.ComponentModel.CancelEventArgs e)
       {
-         if (m_udpClient != null)
-            m_udpClient.Dispose();
+         m_mapper.StopReceive();
+         m_mapper.StopCapture();
          if (m_playbackWindow != null)
             m_playbackWindow.Close();
       }
@@ -335,8 +336,10 @@ namespace adjsw.F12025
 
       private void UpdateDriverGrid()
       {
+         bool reorder = ReadPositionChanges();
          if (m_driversList.Count != m_mapper.CountDrivers)
          {
+            reorder = true;
             m_driversList.Clear();
             for (int i = 0; i < m_mapper.CountDrivers; i++)
             {
@@ -352,6 +355,10 @@ namespace adjsw.F12025
             }
          }
 
+         // the rows are only replaced when the order changed
+         if (!reorder)
+            return;
+
          foreach (var driver in m_mapper.Drivers)
          {
             if ((driver.Pos > 0) && (driver.Pos <= 22))
@@ -362,6 +369,23 @@ namespace adjsw.F12025
          }
       }
 
+      // true if a position changed since the last call, from the change records of the mapper
+      private bool ReadPositionChanges()
+      {
+         bool changed = false;
+         ulong lost = 0;
+         int count;
+         while ((count = m_mapper.ReadChanges(ref m_changePos, m_changes, ref lost)) > 0)
+         {
+            for (int i = 0; i < count; i++)
+            {
+               if ((m_changes[i].Field == DriverChangeField.Position) || (m_changes[i].Field == DriverChangeField.SessionReset))
+                  changed = true;
+            }
+         }
+         return changed || (lost > 0); // the records were overwritten before they were read, the positions are unknown
+      }
+
       private void UpdateCarStatus()
       {
          foreach (var driver in m_mapper.Drivers)
@@ -852,13 +876,7 @@ namespace adjsw.F12025
 
       private void PollUpdates_Tick(object sender, EventArgs e)
       {
-         bool updated = false;
-         byte[] newData;
-         while (m_packetQue.TryDequeue(out newData))
-         {
-            m_mapper.Proceed(newData);
-            updated = true;
-         }
+         bool updated = m_mapper.ProceedQueued();
 
          if (!updated)
             return;
@@ -922,7 +940,7 @@ namespace adjsw.F12025
          {
             m_mapper.UdpAction[0] = false;
 
-            if (m_udpClient != null)
+            if (m_live)
             {
                // accept button input only in live mode...
                ToggleView();
@@ -954,12 +972,48 @@ namespace adjsw.F12025
 
          if (e.Key == Key.R)
          {
-            // enable UDP recording
+            // UDP recording, only of live data
+            if (m_mapper.Capturing)
+            {
+               m_mapper.StopCapture();
+               ShowInfoBox("UDP recording stopped.", TimeSpan.FromSeconds(3));
+            }
+            else if (m_live)
+            {
+               string filename = DateTime.Now.ToString("yyyy-MM-dd_HHmmss") + "_udp.krf1cap";
+               if (m_mapper.StartCapture(filename))
+                  ShowInfoBox(filename + "\r\nUDP recording started, hit \"r\" again to stop.", TimeSpan.FromSeconds(3));
+               else
+                  ShowInfoBox("UDP recording could not be started.", TimeSpan.FromSeconds(3));
+            }
+         }
+
+         if ((e.Key == Key.B) && m_live)
+         {
+            // black box: the last minutes of received UDP data
+            string filename = DateTime.Now.ToString("yyyy-MM-dd_HHmmss") + "_blackbox_udp.krf1cap";
+            if (m_mapper.DumpBlackBox(filename))
+               ShowInfoBox(filename + "\r\nThe last " + Math.Round(m_mapper.BlackBoxSeconds) + " seconds of UDP data were saved.", TimeSpan.FromSeconds(3));
+            else
+               ShowInfoBox("UDP black box could not be saved.", TimeSpan.FromSeconds(3));
+         }
+
+         if ((e.Key == Key.P) && !m_live && !String.IsNullOrEmpty(App.PlaybackFile))
+         {
+            // export of the played capture for Wireshark, native captures only
+            string filename = Path.ChangeExtension(App.PlaybackFile, ".pcap");
+            if (adjsw.F12025.F1CaptureFile.ExportPcap(App.PlaybackFile, filename))
+               ShowInfoBox(filename + "\r\nThe capture was exported as pcap file.", TimeSpan.FromSeconds(3));
+            else
+               ShowInfoBox("The capture could not be exported.", TimeSpan.FromSeconds(3));
          }
 
          if (e.Key == Key.L)
             m_board.LeaderVisible = !m_board.LeaderVisible;
 
+         if (e.Key == Key.I)
+            m_board.IntervalVisible = !m_board.IntervalVisible;
+
          if (e.Key == Key.D)
             m_board.StatusVisible = !m_board.StatusVisible;
 
@@ -997,11 +1051,6 @@ namespace adjsw.F12025
          }
       }
 
-      private void OnUdpReceive(object sender, UdpEventClientEventArgs e)
-      {
-         m_packetQue.Enqueue(e.data);
-      }
-
       private void OnMappingCtxMenuClick(object sender, RoutedEventArgs e)
       {
          var itemLb = sender as Label;
@@ -1110,15 +1159,16 @@ namespace adjsw.F12025
          }
       }
 
-      private UdpEventClient m_udpClient = null;
+      private bool m_live = false;
       private UdpPlaybackWindow m_playbackWindow = null;
-      private ConcurrentQueue<byte[]> m_packetQue = new ConcurrentQueue<byte[]>();
       private F1UdpClrMapper m_mapper = null;
       private DispatcherTimer m_pollTimer = new DispatcherTimer(DispatcherPriority.Render);
       private DispatcherTimer m_infoBoxTimer = new DispatcherTimer();
       private ObservableCollection<adjsw.F12025.DriverData> m_driversList = new ObservableCollection<adjsw.F12025.DriverData>();
       private CollectionViewSource m_driverListViewSource = new CollectionViewSource();
       private bool m_sessionClassificationHandled = false;
+      private ulong m_changePos = 0; // position in the change records of the mapper
+      private DriverChange[] m_changes = new DriverChange[1024];
       private int m_nameMappingNextIdx = 0;
       private DriverNameMappings m_emptyMapping;
       private DriverNameMappings[] m_nameMappings;
@@ -37,6 +37,11 @@ namespace adjsw.F12025
                m_leaderDeltaColumn = col;
             }
 
+            if (col.Header.ToString() == "Interval")
+            {
+               m_intervalColumn = col;
+            }
+
             if (col.Header.ToString() == "S1")
             {
                m_fastestLapS1Column = col;
@@ -96,6 +101,22 @@ namespace adjsw.F12025
          }
       }
 
+      public bool IntervalVisible
+      {
+         get { return m_intervalColumn.Visibility == System.Windows.Visibility.Visible; }
+         set
+         {
+            if (value)
+            {
+               m_intervalColumn.Visibility = System.Windows.Visibility.Visible;
+            }
+            else
+            {
+               m_intervalColumn.Visibility = System.Windows.Visibility.Collapsed;
+            }
+         }
+      }
+
       public bool DeltaVisible
       {
          get { return m_playerDeltaColumn.Visibility == System.Windows.Visibility.Visible; }
@@ -141,6 +162,8 @@ namespace adjsw.F12025
 
                var converter = this.Resources["DeltaTimeLeaderConverter"] as adjsw.F12025.QualifyingAwareConverter;
                converter.IsQualy = m_isQuali;
+               converter = this.Resources["IntervalConverter"] as adjsw.F12025.QualifyingAwareConverter;
+               converter.IsQualy = m_isQuali;
                converter = this.Resources["DeltaTimeConverter"] as adjsw.F12025.QualifyingAwareConverter;
                converter.IsQualy = m_isQuali;
                converter = this.Resources["StatusConverter"] as adjsw.F12025.QualifyingAwareConverter;
@@ -206,6 +229,7 @@ namespace adjsw.F12025
 
       private DataGridColumn m_playerDeltaColumn;
       private DataGridColumn m_leaderDeltaColumn;
+      private DataGridColumn m_intervalColumn;
       private DataGridColumn m_statusColumn;
       private DataGridColumn m_fastestLapS1Column;
       private DataGridColumn m_fastestLapS2Column;
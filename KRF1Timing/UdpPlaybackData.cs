@@ -3,13 +3,14 @@
 
 
 // Playback of UDP capture
+using adjsw.F12025;
 using Razorvine.Pickle;
 using System;
 using System.Collections;
 using System.Collections.Generic;
 using System.IO;
 
-public class UdpPlaybackData
+public class UdpPlaybackData : IDisposable
 {
    public struct TimedUpdPacket
    {
@@ -17,13 +18,19 @@ public class UdpPlaybackData
       public byte[] data;
    }
 
-   private TimedUpdPacket[] m_data = null;
+   private F1CaptureFile m_capture = null;  // native capture (F1UdpClrMapper.StartCapture)
+   private TimedUpdPacket[] m_data = null;  // pickled capture of older versions
+   private int m_idx = 0;
    private UInt64 m_tsFirst = 0; // in ms
 
-   public TimedUpdPacket[] GetPackets() { return m_data; }
-
    public UdpPlaybackData(string filename)
    {
+      if (F1CaptureFile.IsCaptureFile(filename))
+      {
+         m_capture = new F1CaptureFile(filename);
+         return;
+      }
+
       try
       {
          List<TimedUpdPacket> l = new List<TimedUpdPacket>();
@@ -48,6 +55,119 @@ public class UdpPlaybackData
       }
       catch (Exception e)
       { }
+
+      if (m_data == null)
+         m_data = new TimedUpdPacket[0];
+   }
+
+   public void Dispose()
+   {
+      if (m_capture != null)
+      {
+         m_capture.Dispose();
+         m_capture = null;
+      }
+   }
+
+   // number of packets
+   public int Count
+   {
+      get { return (m_capture != null) ? (int)m_capture.Count : m_data.Length; }
+   }
+
+   // number of packets played so far
+   public int Position
+   {
+      get { return (m_capture != null) ? (int)m_capture.Position : m_idx; }
+   }
+
+   public bool AtEnd
+   {
+      get { return Position >= Count; }
+   }
+
+   // timestamp of the next packet in ms, UInt64.MaxValue at the end
+   public UInt64 NextTimestamp
+   {
+      get
+      {
+         if (m_capture != null)
+            return m_capture.NextTimestampMs;
+
+         return AtEnd ? UInt64.MaxValue : m_data[m_idx].timestamp;
+      }
+   }
+
+   public void Rewind()
+   {
+      if (m_capture != null)
+         m_capture.Rewind();
+
+      m_idx = 0;
+   }
+
+   // native captures are played by a paced native thread instead of PlayUntil()
+   public bool Paced
+   {
+      get { return m_capture != null; }
+   }
+
+   public bool StartPaced(F1UdpClrMapper mapper, int emitPort = 0)
+   {
+      return (m_capture != null) && m_capture.StartPlayback(mapper, emitPort);
+   }
+
+   public double Speed
+   {
+      get { return (m_capture != null) ? m_capture.Speed : 1.0; }
+      set { if (m_capture != null) m_capture.Speed = value; }
+   }
+
+   public bool Paused
+   {
+      get { return (m_capture != null) && m_capture.Paused; }
+      set { if (m_capture != null) m_capture.Paused = value; }
+   }
+
+   public void StepFrame()
+   {
+      if (m_capture != null)
+         m_capture.StepFrame();
+   }
+
+   // capture time played so far in ms
+   public UInt64 PlayedMs
+   {
+      get { return (m_capture != null) ? m_capture.PlayedMs : 0; }
+   }
+
+   // played - target time of the paced packets
+   public string TimingInfo
+   {
+      get
+      {
+         if (m_capture == null)
+            return "";
+
+         return String.Format("timing error: mean {0:F0} us, p99 < {1:F0} us, max {2:F0} us, {3} late",
+            m_capture.TimingMeanErrorUs, m_capture.TimingP99ErrorUs, m_capture.TimingMaxErrorUs, m_capture.TimingLate);
+      }
+   }
+
+   // queue all packets before timestamp (ms) to the mapper
+   public void PlayUntil(UInt64 timestamp, F1UdpClrMapper mapper)
+   {
+      if (m_capture != null)
+      {
+         m_capture.EnqueueUntil(timestamp, mapper);
+         return;
+      }
+
+      while ((m_idx < m_data.Length) && (m_data[m_idx].timestamp < timestamp))
+      {
+         mapper.EnqueueDatagram(m_data[m_idx].data);
+         ++m_idx;
+      }
    }
 
    private UInt64 m_StringToUsTimestamp(string str)
@@ -145,56 +265,4 @@ public class UdpPlaybackData
          l.Add(p);
       }
    }
-
-   private void m_ParseFile(string filename)
-   {
-      byte[] data = new byte[1024 * 1024];
-      bool fileEnd = false;
-      int idxStart = 0;
-      int idxEnd = 0;
-      using (var fs = File.Open(filename, FileMode.Open, FileAccess.Read))
-      {
-         // read 1 MB of file
-         if (!fileEnd)
-         {
-            var spaceInBuffer = data.Length - idxEnd;
-            var readLen = fs.Read(data, idxEnd, spaceInBuffer);
-            if (readLen < spaceInBuffer)
-               fileEnd = true;
-         }
-
-         while (idxStart < idxEnd)
-         {
-
-
-         }
-
-
-         // copy remaining data to the start of buffer
-         Array.Copy(data, idxStart, data, 0, data.Length - idxStart);
-      }
-   }
-
-   private bool m_FindTelegram(int idxStart, int idxEnd, byte[] data, out UInt64 timestamp)
-   {
-      timestamp = 0;
-      return true;
-   }
-
-   // compare if content of array1, starting from idxArray1, equals the content of array2
-   // if array1 contains more data it is not an error
-   private bool m_ArrayHeaderCompare(byte[] array1, int idxArray1, byte[] array2)
-   {
-      if ((array1.Length - idxArray1) < array2.Length)
-         return false;
-
-      for (int i = 0; i < array2.Length; i++) 
-      {
-        if (array1[i+idxArray1] != array2[i]) 
-            return false;
-      }
-
-      return true;
-   }
-
 }
\ No newline at end of file
@@ -23,11 +23,10 @@ namespace adjsw.F12025
    /// </summary>
    public partial class UdpPlaybackWindow : Window, INotifyPropertyChanged
    {
-      private int m_idx = 0;
       private bool m_play = true;
-      private UdpPlaybackData.TimedUpdPacket[] m_data; 
+      private UdpPlaybackData m_data;
       private DispatcherTimer m_timer;
-      private uint m_speed = 1;
+      private double m_speed = 1;
       private MainWindow m_wnd;
       UInt64 m_ts = 0;
 
@@ -36,7 +35,7 @@ namespace adjsw.F12025
       public bool Play 
       { 
          get { return m_play; } 
-         set { m_play = value; NPC(); } 
+         set { m_play = value; m_data.Paused = !value; NPC(); } 
       }
 
       public event PropertyChangedEventHandler PropertyChanged;
@@ -47,42 +46,43 @@ namespace adjsw.F12025
 
          m_wnd = mw;
 
-         var pbd = new UdpPlaybackData(filename);
-         m_data = pbd.GetPackets();
+         m_data = new UdpPlaybackData(filename);
          m_timer = new DispatcherTimer(DispatcherPriority.Send);
          m_timer.Interval = TimeSpan.FromMilliseconds(50);
          m_timer.Tick += M_timer_Tick; ;
          m_timer.Start();
 
+         // native captures are paced on their own thread, the timer only updates the window
+         if (m_data.Paced)
+            m_data.StartPaced(mw.Mapper);
+         m_btnStep.IsEnabled = m_data.Paced;
+
          m_pbar.Minimum = 0;
-         m_pbar.Maximum = m_data.Length + 1;
+         m_pbar.Maximum = m_data.Count + 1;
          DataContext = this;
       }
 
       private void M_timer_Tick(object sender, EventArgs e)
       {
-         if ((m_idx != m_data.Length) && Play)
-            m_ts += (UInt64)m_timer.Interval.TotalMilliseconds * m_speed;
+         if (m_data.Paced)
+         {
+            m_ts = m_data.PlayedMs;
+            m_tbTiming.Text = m_data.TimingInfo;
+         }
+         else if (!m_data.AtEnd && Play)
+            m_ts += (UInt64)(m_timer.Interval.TotalMilliseconds * m_speed);
 
-         while (m_idx != m_data.Length)
+         if (!m_data.Paced && !m_data.AtEnd)
          {
-            if (m_data[m_idx].timestamp < m_ts)
-            {
-               m_wnd.PacketQue.Enqueue(m_data[m_idx].data);
-               ++m_idx;
-            }
-            else if ((m_data[m_idx].timestamp) > (m_ts + 3000))
-            {
-               // if for prolonged time no packets, force to send the next packet
-               m_ts = m_data[m_idx].timestamp;
-            }
-
-            else
-               break;
+            // if for prolonged time no packets, force to send the next packet
+            if (m_data.NextTimestamp > (m_ts + 3000))
+               m_ts = m_data.NextTimestamp;
+
+            m_data.PlayUntil(m_ts, m_wnd.Mapper);
          }
 
-         m_pbar.Value = m_idx;
-         m_tbFrame.Text = "" + m_idx;
+         m_pbar.Value = m_data.Position;
+         m_tbFrame.Text = "" + m_data.Position;
 
          int seconds = (int) m_ts / 1000;
          int tenth = (int)m_ts % 1000 / 100;
@@ -97,23 +97,37 @@ namespace adjsw.F12025
 
       private void Button_Reset_Click(object sender, RoutedEventArgs e)
       {
-         m_idx = 0;
+         m_data.Rewind();
          m_ts = 0;
       }
       private void Button_Speedm_Click(object sender, RoutedEventArgs e)
       {
-         if (m_speed >= 2)
+         if (m_speed >= 0.25)
             m_speed /= 2;
 
+         m_data.Speed = m_speed;
          m_btnPlay.Content = "Play (" + m_speed + "x)";
       }
       private void Button_Speedp_Click(object sender, RoutedEventArgs e)
       {
-         if (m_speed < 100)
+         if (m_speed <= 16)
             m_speed *= 2;
 
+         m_data.Speed = m_speed;
          m_btnPlay.Content = "Play (" + m_speed + "x)";
       }
+      private void Button_Step_Click(object sender, RoutedEventArgs e)
+      {
+         Play = false;
+         m_data.StepFrame();
+      }
+
+      protected override void OnClosed(EventArgs e)
+      {
+         m_timer.Stop();
+         m_data.Dispose();
+         base.OnClosed(e);
+      }
 
       private void NPC([CallerMemberName] string propertyName = "")
       {